@@ -29,8 +29,18 @@ SOFTWARE.
         Includes
 ==============================================================================*/
 
+#include <stdint.h>
+#include <time.h>
 #include <varserver/varserver.h>
 #include <varaction/varaction.h>
+#include "aggregate.h"
+#include "strbuild.h"
+#include "realtime.h"
+#include "guard.h"
+#include "condition.h"
+#include "varset.h"
+#include "log.h"
+#include "scheduler.h"
 
 /*==============================================================================
         Public Definitions
@@ -50,6 +60,26 @@ SOFTWARE.
 /*! no notification */
 #define NO_NOTIFICATION 0
 
+/*! maximum length of a cached calc string result */
+#define MAX_CACHED_STRING_LEN ( 256 )
+
+/*! default static variable checkpoint period in seconds */
+#define DEFAULT_CHECKPOINT_PERIOD ( 60 )
+
+/*! calc result caching modes */
+typedef enum
+{
+    /*! calc results are not cached */
+    CACHE_eNONE = 0,
+
+    /*! calc results are re-used until the cache time expires */
+    CACHE_eTIMED = 1,
+
+    /*! calc results are re-used until an input variable changes */
+    CACHE_eUNTIL_CHANGE = 2
+
+} CacheMode;
+
 /*! local variable declaration */
 typedef struct _declaration
 {
@@ -79,10 +109,172 @@ typedef struct _sigHandle
     /*! pointer to the variable associated with this signal */
     Variable *pVariable;
 
+    /*! flag indicating the cached calc result is valid */
+    bool cached;
+
+    /*! time at which the calc result was cached */
+    struct timespec cacheTime;
+
+    /*! cached calc result */
+    VarObject cache;
+
+    /*! storage for a cached string calc result */
+    char *pCacheBuffer;
+
     /*! pointer to the next variable */
     struct _sigHandle *pNext;
 } Signal;
 
+/*! reference to the triggering variable of an action */
+typedef struct _trigger
+{
+    /*! pointer to the expression node bound to the triggering variable */
+    Variable *pVariable;
+
+    /*! pointer to the next trigger reference */
+    struct _trigger *pNext;
+} Trigger;
+
+/*! persistent (static) local variable */
+typedef struct _staticVar
+{
+    /*! pointer to the declared local variable */
+    Variable *pVariable;
+
+    /*! value of the local variable kept between executions */
+    VarObject value;
+
+    /*! handle of the checkpoint variable (VAR_INVALID = none) */
+    VAR_HANDLE hCheckpoint;
+
+    /*! flag indicating the value has changed since the last checkpoint */
+    bool dirty;
+
+    /*! pointer to the next static variable */
+    struct _staticVar *pNext;
+} StaticVar;
+
+/*! system variable reference */
+typedef struct _varRef
+{
+    /*! handle of the referenced system variable */
+    VAR_HANDLE hVar;
+
+    /*! pointer to the next reference */
+    struct _varRef *pNext;
+} VarRef;
+
+/*! assignment of a numeric system variable through the write queue */
+typedef struct _queuedAssignment
+{
+    /*! assignment expression the queued assignment replaces */
+    Variable *pAssignment;
+
+    /*! statement which the assignment replaces in the action's
+        statement list */
+    Statement *pStatement;
+
+    /*! statement assigning the expression to the hidden local variable */
+    Statement *pEvaluate;
+
+    /*! hidden local variable which receives the assigned value */
+    Variable *pLocal;
+
+    /*! handle of the assigned system variable */
+    VAR_HANDLE hTarget;
+
+    /*! type of the assigned system variable */
+    VarType type;
+
+    /*! system variables read by the assigned expression */
+    VarRef *pReads;
+
+    /*! pointer to the next queued assignment */
+    struct _queuedAssignment *pNext;
+} QueuedAssignment;
+
+/*! watched system variable */
+typedef struct _watch
+{
+    /*! handle of the watched system variable */
+    VAR_HANDLE hVar;
+
+    /*! type of the watched system variable (obj.type) */
+    VarObject obj;
+
+    /*! flag indicating the last seen value is valid */
+    bool seen;
+
+    /*! value of the variable at the last resynchronization */
+    VarObject last;
+
+    /*! pointer to the next watched variable */
+    struct _watch *pNext;
+} Watch;
+
+/*! action dependency */
+typedef struct _dependency
+{
+    /*! pointer to the dependent action */
+    struct _action *pAction;
+
+    /*! pointer to the next dependency */
+    struct _dependency *pNext;
+} Dependency;
+
+/*! actions sharing a trigger, dispatched together */
+typedef struct _dispatchUnit
+{
+    /*! signal number of the trigger */
+    int signum;
+
+    /*! signal identifier (variable handle or timer id) of the trigger */
+    int id;
+
+    /*! triggered actions in declaration order */
+    struct _action **ppActions;
+
+    /*! number of triggered actions */
+    size_t count;
+
+    /*! bit mask of the priority levels of the triggered actions */
+    uint32_t levels;
+
+    /*! shortest deadline of the triggered actions at each priority
+        level (0 = none) */
+    uint64_t deadlines[NUM_PRIORITIES];
+
+    /*! flag indicating the trigger has been disabled at runtime */
+    bool disabled;
+
+    /*! flag indicating the actions can share one read snapshot, because
+        none of them writes a variable used by a later one */
+    bool shared;
+
+    /*! number of change notifications expected from propagated writes,
+        which have already run all of the unit's actions */
+    uint32_t echoes;
+
+    /*! pointer to the next unit in the same hash bucket */
+    struct _dispatchUnit *pNext;
+} DispatchUnit;
+
+/*! delayed (after) action statement */
+typedef struct _delay
+{
+    /*! statement replaced by the delay */
+    Statement *pStatement;
+
+    /*! delayed action to start, or NULL to cancel the delays */
+    struct _action *pTarget;
+
+    /*! delay in milliseconds */
+    uint64_t ms;
+
+    /*! pointer to the next delay */
+    struct _delay *pNext;
+} Delay;
+
 /*! list of actions */
 typedef struct _action
 {
@@ -107,6 +299,88 @@ typedef struct _action
     /*! pointer to the statements associated with this action */
     Statement *pStatements;
 
+    /*! pointer to the system variables read by this action */
+    VarRef *pReads;
+
+    /*! pointer to the system variables written by this action */
+    VarRef *pWrites;
+
+    /*! pointer to the streaming aggregates used by this action */
+    Aggregate *pAggregates;
+
+    /*! pointer to the references to the triggering variable */
+    Trigger *pTriggers;
+
+    /*! pointer to the static local variables of this action */
+    StaticVar *pStatics;
+
+    /*! pointer to the string builders replacing this action's statements */
+    StringBuilder *pBuilders;
+
+    /*! pointer to the queued assignments replacing this action's
+        statements */
+    QueuedAssignment *pAssignments;
+
+    /*! pointer to the after and cancel statements of this action */
+    Delay *pDelays;
+
+    /*! pointer to the guard which must be satisfied to run this action */
+    Guard *pGuard;
+
+    /*! pointer to the profiled compound conditions of this action */
+    Condition *pConditions;
+
+    /*! pointer to the for each loops of this action */
+    Loop *pLoops;
+
+    /*! pointer to the variable set reductions used by this action */
+    Reduction *pReductions;
+
+    /*! pointer to the actions triggered by this action's writes */
+    Dependency *pDependents;
+
+    /*! position of this action in the propagation order */
+    size_t rank;
+
+    /*! flag indicating the action is waiting to be propagated */
+    bool pending;
+
+    /*! scheduling priority of the action */
+    int priority;
+
+    /*! dispatch deadline in milliseconds (0 = none) */
+    uint64_t deadline;
+
+    /*! execution budget in milliseconds (0 = default) */
+    uint64_t budget;
+
+    /*! log level of this action (LOGLEVEL_eDEFAULT = default level) */
+    LogLevel logLevel;
+
+    /*! flag indicating the action has been disabled at runtime */
+    bool disabled;
+
+    /*! line number of the action declaration */
+    int lineno;
+
+    /*! number of times the action has run */
+    uint64_t runs;
+
+    /*! total execution time in microseconds */
+    uint64_t totalTime;
+
+    /*! longest execution time in microseconds */
+    uint64_t maxTime;
+
+    /*! number of times the action exceeded its execution budget */
+    uint64_t overruns;
+
+    /*! calc result caching mode */
+    CacheMode cacheMode;
+
+    /*! calc result cache lifetime in milliseconds */
+    uint64_t cacheTTL;
+
     /*! pointer to the next action */
     struct _action *pNext;
 } Action;
@@ -129,11 +403,86 @@ typedef struct _actions
     /*! verbose mode */
     bool verbose;
 
+    /*! default log level */
+    LogLevel logLevel;
+
+    /*! log destination (syslog, stdout, stderr or a file name) */
+    char *logTarget;
+
+    /*! path of the control socket (NULL = no control socket) */
+    char *controlPath;
+
     /*! output state machine documentation */
     bool output;
 
+    /*! number of queued events above which low priority events are shed */
+    size_t backlogLimit;
+
+    /*! events for actions below this priority are shed under overload */
+    int shedPriority;
+
+    /*! flag indicating the change notifications must be resynchronized */
+    bool resync;
+
+    /*! number of events shed due to overload */
+    uint64_t shedCount;
+
+    /*! default action execution budget in milliseconds (0 = none) */
+    uint64_t budget;
+
+    /*! prefix of the VarServer metrics variables */
+    char *metrics;
+
+    /*! total number of action execution budget overruns */
+    uint64_t overruns;
+
+    /*! static variable checkpoint period in seconds */
+    int checkpointPeriod;
+
+    /*! static variable checkpoint timer */
+    int checkpointTimer;
+
+    /*! path of the engine state snapshot file (NULL = no snapshots) */
+    char *snapshotPath;
+
+    /*! engine state snapshot timer */
+    int snapshotTimer;
+
+    /*! flag indicating the engine has been asked to stop */
+    bool stopping;
+
+    /*! stagger the initial phases of the tick timers */
+    bool stagger;
+
+    /*! profile and reorder the operands of compound conditions */
+    bool profile;
+
+    /*! report the parse time of the script instead of running it */
+    bool timing;
+
+    /*! queue system variable writes for the writer thread */
+    bool asyncWrites;
+
+    /*! real-time scheduling, CPU affinity and memory locking options */
+    RealtimeConfig realtime;
+
     /*! pointer to the first state in a list of states */
     Action *pActionList;
+
+    /*! actions sorted in dependency (propagation) order */
+    Action **ppOrder;
+
+    /*! number of actions in the propagation order */
+    size_t numActions;
+
+    /*! hash table of dispatch units keyed by signal and identifier */
+    DispatchUnit **ppUnits;
+
+    /*! number of buckets in the dispatch unit hash table */
+    size_t numBuckets;
+
+    /*! pointer to the list of variables with change notifications */
+    Watch *pWatchList;
 } Actions;
 
 #endif
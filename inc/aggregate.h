@@ -0,0 +1,139 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <varserver/varserver.h>
+#include <varaction/varaction.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! maximum number of samples held in an aggregate window */
+#define MAX_AGGREGATE_SAMPLES ( 1024 )
+
+/*! streaming aggregate types */
+typedef enum
+{
+    AGGREGATE_eINVALID = 0,
+
+    /*! average over a time window */
+    AGGREGATE_eAVG = 1,
+
+    /*! minimum over a time window */
+    AGGREGATE_eMIN = 2,
+
+    /*! maximum over a time window */
+    AGGREGATE_eMAX = 3,
+
+    /*! rate of change per second over a time window */
+    AGGREGATE_eRATE = 4,
+
+    /*! exponentially weighted moving average */
+    AGGREGATE_eEWMA = 5
+
+} AggregateType;
+
+/*! aggregate sample */
+typedef struct _sample
+{
+    /*! sample value */
+    double value;
+
+    /*! sample time in milliseconds (CLOCK_MONOTONIC) */
+    uint64_t t;
+} Sample;
+
+/*! streaming aggregate over a system variable */
+typedef struct _aggregate
+{
+    /*! type of aggregate */
+    AggregateType type;
+
+    /*! handle of the aggregated system variable */
+    VAR_HANDLE hVar;
+
+    /*! VarServer type of the aggregated system variable */
+    int varType;
+
+    /*! aggregation window in milliseconds */
+    uint64_t window;
+
+    /*! smoothing factor for the exponentially weighted moving average */
+    double alpha;
+
+    /*! pointer to the expression node which holds the aggregate value */
+    Variable *pResult;
+
+    /*! ring buffer of samples in the window */
+    Sample *pSamples;
+
+    /*! sequence number of the oldest sample in the window */
+    uint64_t first;
+
+    /*! sequence number of the next sample */
+    uint64_t next;
+
+    /*! sum of the samples in the window */
+    double sum;
+
+    /*! sequence numbers of the min/max candidates (monotonic deque) */
+    uint64_t *pCandidates;
+
+    /*! index of the oldest min/max candidate */
+    uint64_t head;
+
+    /*! index of the next min/max candidate */
+    uint64_t tail;
+
+    /*! exponentially weighted moving average */
+    double ewma;
+
+    /*! pointer to the next aggregate */
+    struct _aggregate *pNext;
+} Aggregate;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+Aggregate *NewAggregate( AggregateType type,
+                         VAR_HANDLE hVar,
+                         int varType,
+                         uint64_t window,
+                         double alpha,
+                         Variable *pResult );
+void AddSample( Aggregate *pAggregate, double value, uint64_t t );
+double GetAggregate( Aggregate *pAggregate, uint64_t t );
+
+#endif
@@ -0,0 +1,97 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef CONDITION_H
+#define CONDITION_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <varserver/varserver.h>
+#include <varaction/varaction.h>
+#include "guard.h"
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! number of executions of a condition which are profiled before
+    its operands are reordered */
+#define PROFILE_SAMPLES ( 1000 )
+
+/*! profiled compound condition of a top-level if statement */
+typedef struct _condition
+{
+    /*! if statement containing the condition */
+    Statement *pStatement;
+
+    /*! lowered if expression built for the condition */
+    Variable *pIf;
+
+    /*! logical operation joining the operands (VA_AND or VA_OR) */
+    int type;
+
+    /*! number of operands */
+    size_t count;
+
+    /*! operand expressions in evaluation order */
+    Variable **ppOperands;
+
+    /*! side-effect free guard equivalents of the operands */
+    Guard **ppGuards;
+
+    /*! number of times each operand would have decided the outcome */
+    uint64_t *pDecisive;
+
+    /*! statements run when the condition is true */
+    Statement *pThen;
+
+    /*! statements run when the condition is false */
+    Statement *pElse;
+
+    /*! number of profiled executions */
+    uint64_t samples;
+
+    /*! pointer to the next condition */
+    struct _condition *pNext;
+} Condition;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+Variable *BuildCondition( int type,
+                          Variable **ppOperands,
+                          size_t count,
+                          Statement *pThen,
+                          Statement *pElse );
+Statement *NewIfStatement( Variable *pIf );
+bool ProfileCondition( Condition *pCondition );
+int ReorderCondition( Condition *pCondition );
+
+#endif
@@ -0,0 +1,73 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef CRON_H
+#define CRON_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! cron style calendar schedule */
+typedef struct _cronSpec
+{
+    /*! minutes of the hour (bits 0-59) */
+    uint64_t minutes;
+
+    /*! hours of the day (bits 0-23) */
+    uint32_t hours;
+
+    /*! days of the month (bits 1-31) */
+    uint32_t days;
+
+    /*! months of the year (bits 1-12) */
+    uint16_t months;
+
+    /*! days of the week (bits 0-6, Sunday is 0) */
+    uint8_t weekdays;
+
+    /*! true if the day of the month field is restricted */
+    bool restrictDays;
+
+    /*! true if the day of the week field is restricted */
+    bool restrictWeekdays;
+} CronSpec;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int ParseCron( const char *spec, CronSpec *pSpec );
+int ParseTimeOfDay( const char *spec, CronSpec *pSpec );
+time_t NextCron( CronSpec *pSpec, time_t after );
+
+#endif
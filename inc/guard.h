@@ -0,0 +1,124 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef GUARD_H
+#define GUARD_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! guard expression operations */
+typedef enum
+{
+    /*! numeric constant */
+    GUARD_eCONSTANT = 0,
+
+    /*! cached value of a system variable */
+    GUARD_eINPUT,
+
+    /*! logical not */
+    GUARD_eNOT,
+
+    /*! logical and */
+    GUARD_eAND,
+
+    /*! logical or */
+    GUARD_eOR,
+
+    /*! equal to */
+    GUARD_eEQUALS,
+
+    /*! not equal to */
+    GUARD_eNOTEQUALS,
+
+    /*! less than */
+    GUARD_eLT,
+
+    /*! greater than */
+    GUARD_eGT,
+
+    /*! less than or equal to */
+    GUARD_eLTE,
+
+    /*! greater than or equal to */
+    GUARD_eGTE
+
+} GuardOp;
+
+/*! cached value of a system variable used by a guard */
+typedef struct _guardInput
+{
+    /*! handle of the system variable */
+    VAR_HANDLE hVar;
+
+    /*! type of the system variable */
+    int type;
+
+    /*! cached value of the system variable */
+    double value;
+
+    /*! pointer to the next guard input */
+    struct _guardInput *pNext;
+} GuardInput;
+
+/*! guard expression node */
+typedef struct _guard
+{
+    /*! guard operation */
+    GuardOp op;
+
+    /*! value of a constant */
+    double value;
+
+    /*! input of a system variable reference */
+    GuardInput *pInput;
+
+    /*! left operand */
+    struct _guard *pLeft;
+
+    /*! right operand */
+    struct _guard *pRight;
+} Guard;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+Guard *NewGuard( GuardOp op, Guard *pLeft, Guard *pRight );
+Guard *NewGuardConstant( VarObject *pObj );
+Guard *NewGuardInput( VAR_HANDLE hVar, int type );
+bool EvalGuard( Guard *pGuard );
+int UpdateGuardInput( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar );
+void RefreshGuardInputs( VARSERVER_HANDLE hVarServer );
+
+#endif
@@ -31,5 +31,9 @@ SOFTWARE.
 
 int getlineno( void );
 void incrementLineNumber( void );
+int getlinecount( void );
+void setlineno( int n );
+char *getfilename( void );
+void setfilename( char *name );
 
 #endif
\ No newline at end of file
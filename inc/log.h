@@ -0,0 +1,98 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef LOG_H
+#define LOG_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! log levels, in increasing order of verbosity */
+typedef enum
+{
+    /*! default level (used by actions without a log level) */
+    LOGLEVEL_eDEFAULT = 0,
+
+    /*! nothing is logged */
+    LOGLEVEL_eNONE,
+
+    /*! errors */
+    LOGLEVEL_eERROR,
+
+    /*! warnings */
+    LOGLEVEL_eWARNING,
+
+    /*! informational messages */
+    LOGLEVEL_eINFO,
+
+    /*! debug messages */
+    LOGLEVEL_eDEBUG
+
+} LogLevel;
+
+/*! structured log record codes, formatted by the log thread */
+typedef enum
+{
+    /*! pre-formatted text message */
+    LOGCODE_eTEXT = 0,
+
+    /*! signal received: signal number, identifier */
+    LOGCODE_eSIGNAL,
+
+    /*! signal handled: signal number, identifier, result */
+    LOGCODE_eHANDLED,
+
+    /*! action run: line number, elapsed microseconds, result */
+    LOGCODE_eACTION,
+
+    /*! condition operands reordered: line number */
+    LOGCODE_eREORDER
+
+} LogCode;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int ParseLogLevel( const char *name, LogLevel *pLevel );
+int StartLog( LogLevel level, const char *target );
+void StopLog( void );
+bool LogEnabled( LogLevel level, LogLevel override );
+void LogRecord( LogLevel level,
+                LogCode code,
+                int64_t arg1,
+                int64_t arg2,
+                int64_t arg3 );
+void LogMessage( LogLevel level, const char *format, ... )
+    __attribute__(( format( printf, 2, 3 ) ));
+
+#endif
@@ -0,0 +1,72 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! maximum number of CPUs which can be selected for the affinity mask */
+#define MAX_AFFINITY_CPUS ( 64 )
+
+/*! size of the stack which is pre-faulted when memory is locked */
+#define PREFAULT_STACK_SIZE ( 256 * 1024 )
+
+/*! size of the heap which is pre-faulted when memory is locked */
+#define PREFAULT_HEAP_SIZE ( 1024 * 1024 )
+
+/*! real-time execution configuration */
+typedef struct _realtimeConfig
+{
+    /*! scheduling policy (SCHED_OTHER, SCHED_FIFO or SCHED_RR) */
+    int policy;
+
+    /*! real-time scheduling priority */
+    int priority;
+
+    /*! CPU affinity mask, or 0 to run on any CPU */
+    uint64_t cpus;
+
+    /*! lock and pre-fault the process memory */
+    bool lock;
+} RealtimeConfig;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int ParseSchedPolicy( const char *spec, RealtimeConfig *pConfig );
+int ParseCpuList( const char *spec, RealtimeConfig *pConfig );
+int ApplyRealtime( RealtimeConfig *pConfig );
+
+#endif
@@ -0,0 +1,84 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! lowest action priority */
+#define MIN_PRIORITY ( 0 )
+
+/*! highest action priority */
+#define MAX_PRIORITY ( 7 )
+
+/*! number of priority levels */
+#define NUM_PRIORITIES ( MAX_PRIORITY - MIN_PRIORITY + 1 )
+
+/*! maximum number of queued events per priority level */
+#define MAX_QUEUED_EVENTS ( 256 )
+
+/*! number of times a queued event can be passed over by higher
+    priority events before it is dispatched ahead of them */
+#define STARVATION_LIMIT ( 16 )
+
+/*! pending event */
+typedef struct _event
+{
+    /*! signal which generated the event */
+    int signum;
+
+    /*! signal identifier */
+    int id;
+
+    /*! priority of the event */
+    int priority;
+
+    /*! flag indicating the event has a deadline */
+    bool hasDeadline;
+
+    /*! time by which the event should be dispatched (CLOCK_MONOTONIC) */
+    struct timespec deadline;
+} Event;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int ScheduleEvent( Event *pEvent );
+int NextEvent( Event *pEvent );
+size_t PendingEvents( void );
+size_t DiscardEvents( int signum );
+
+#endif
@@ -0,0 +1,128 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef STRBUILD_H
+#define STRBUILD_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <varserver/varserver.h>
+#include <varaction/varaction.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! maximum length of a string variable value in a string builder */
+#define MAX_STRING_FIELD_LEN ( 256 )
+
+/*! maximum length of a formatted numeric value, excluding field width */
+#define MAX_NUMERIC_FIELD_LEN ( 64 )
+
+/*! string segment types */
+typedef enum
+{
+    /*! literal text */
+    SEGMENT_eLITERAL = 0,
+
+    /*! formatted variable value */
+    SEGMENT_eFIELD = 1
+
+} SegmentType;
+
+/*! segment of a string concatenation */
+typedef struct _segment
+{
+    /*! segment type */
+    SegmentType type;
+
+    /*! literal text, or compiled format of a field */
+    char *text;
+
+    /*! length of the literal text */
+    size_t len;
+
+    /*! maximum length of the formatted field */
+    size_t maxlen;
+
+    /*! format conversion character of a field */
+    char conversion;
+
+    /*! pointer to the variable of a field */
+    Variable *pVariable;
+
+    /*! storage for the value of a string system variable */
+    char *pBuffer;
+
+    /*! pointer to the next segment */
+    struct _segment *pNext;
+} Segment;
+
+/*! pre-sized string builder for a string assignment */
+typedef struct _stringBuilder
+{
+    /*! handle of the string system variable to assign */
+    VAR_HANDLE hTarget;
+
+    /*! assignment expression node replaced by the string builder */
+    Variable *pAssignment;
+
+    /*! statement replaced by the string builder */
+    Statement *pStatement;
+
+    /*! segments to concatenate */
+    Segment *pSegments;
+
+    /*! reusable output buffer */
+    char *buffer;
+
+    /*! size of the output buffer */
+    size_t size;
+
+    /*! pointer to the next string builder */
+    struct _stringBuilder *pNext;
+} StringBuilder;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+Segment *NewLiteralSegment( char *text );
+Segment *NewFieldSegment( Variable *pVariable, char *format );
+Segment *MergeSegments( Segment *pLeft, Segment *pRight );
+void FreeSegments( Segment *pSegment );
+int CompileFormat( char *format,
+                   int type,
+                   char **ppCompiled,
+                   char *pConversion );
+StringBuilder *NewStringBuilder( VAR_HANDLE hTarget, Segment *pSegments );
+void FreeStringBuilder( StringBuilder *pBuilder );
+int RunStringBuilder( VARSERVER_HANDLE hVarServer, StringBuilder *pBuilder );
+
+#endif
@@ -0,0 +1,84 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef TEMPLATE_H
+#define TEMPLATE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! maximum number of template parameters */
+#define MAX_TEMPLATE_PARAMS ( 16 )
+
+/*! maximum template instantiation nesting depth */
+#define MAX_TEMPLATE_DEPTH ( 16 )
+
+/*! action template */
+typedef struct _template
+{
+    /*! template name */
+    char *name;
+
+    /*! template parameter names */
+    char *params[MAX_TEMPLATE_PARAMS];
+
+    /*! number of template parameters */
+    int nparams;
+
+    /*! template body text */
+    char *body;
+
+    /*! length of the template body text */
+    size_t len;
+
+    /*! size of the template body buffer */
+    size_t size;
+
+    /*! pointer to the next template */
+    struct _template *pNext;
+} Template;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int NewTemplate( char *name );
+int AddTemplateParam( char *name );
+int AppendTemplateBody( char *text );
+int EndTemplate( void );
+Template *FindTemplate( char *name );
+int BeginInstance( Template *pTemplate );
+int AddInstanceArg( char *arg );
+char *EndInstance( void );
+
+#endif
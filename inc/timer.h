@@ -25,6 +25,14 @@ SOFTWARE.
 #ifndef TIMER_H
 #define TIMER_H
 
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cron.h"
+
 /*==============================================================================
         Public Definitions
 ==============================================================================*/
@@ -56,6 +64,20 @@ typedef enum
 ==============================================================================*/
 
 int CreateTick( int num, Timescale timescale );
+int SetTickOffset( int timerID, uint64_t offset );
+int SetTickPeriod( int timerID, uint64_t interval );
+uint64_t GetTickPeriod( int timerID );
+uint64_t GetTickNext( int timerID );
+int SetTickResume( int timerID, uint64_t next );
+int StartTimers( bool stagger );
+uint64_t TimespanToMs( int num, Timescale timescale );
+int CreateOneShot( void );
+int StartOneShot( int timerID, uint64_t ms );
+int CancelOneShot( int timerID );
+int CreateAligned( int num, Timescale timescale, uint64_t offset );
+int CreateCron( CronSpec *pCron, uint64_t offset );
+int RearmTimer( int timerID );
+uint64_t InstanceJitter( const char *key, uint64_t range );
 
 #endif
 
@@ -0,0 +1,128 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef VARSET_H
+#define VARSET_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <varserver/varserver.h>
+#include <varaction/varaction.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! named set of numeric system variables */
+typedef struct _varSet
+{
+    /*! name of the set */
+    char *name;
+
+    /*! handles of the system variables in the set */
+    VAR_HANDLE *pHandles;
+
+    /*! most recently fetched values of the system variables */
+    VarObject *pObjects;
+
+    /*! most recently fetched values converted to double */
+    double *pValues;
+
+    /*! number of system variables in the set */
+    size_t count;
+
+    /*! fetch generation of the values */
+    uint64_t generation;
+
+    /*! pointer to the next set */
+    struct _varSet *pNext;
+} VarSet;
+
+/*! set reduction operations */
+typedef enum
+{
+    /*! sum of the values */
+    REDUCE_eSUM = 0,
+
+    /*! average of the values */
+    REDUCE_eAVG,
+
+    /*! minimum value */
+    REDUCE_eMIN,
+
+    /*! maximum value */
+    REDUCE_eMAX
+
+} ReduceOp;
+
+/*! reduction of a variable set to a single value */
+typedef struct _reduction
+{
+    /*! expression node which holds the reduced value */
+    Variable *pVariable;
+
+    /*! reduction operation */
+    ReduceOp op;
+
+    /*! pointer to the reduced set */
+    VarSet *pSet;
+
+    /*! pointer to the next reduction */
+    struct _reduction *pNext;
+} Reduction;
+
+/*! for each loop over a variable set */
+typedef struct _loop
+{
+    /*! statement which the loop replaces in the action's statement list */
+    Statement *pStatement;
+
+    /*! local loop variable which receives each value */
+    Variable *pVariable;
+
+    /*! pointer to the set to iterate over */
+    VarSet *pSet;
+
+    /*! statements run for each value */
+    Statement *pBody;
+
+    /*! pointer to the next loop */
+    struct _loop *pNext;
+} Loop;
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+VarSet *NewVarSet( char *name );
+int AddVarSetMember( VarSet *pSet, VAR_HANDLE hVar );
+int FetchVarSet( VARSERVER_HANDLE hVarServer, VarSet *pSet );
+double ReduceVarSet( VarSet *pSet, ReduceOp op );
+
+#endif
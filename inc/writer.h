@@ -0,0 +1,58 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef WRITER_H
+#define WRITER_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdbool.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Public Definitions
+==============================================================================*/
+
+/*! number of writes in the outbound write queue (a power of two) */
+#define WRITE_QUEUE_SIZE ( 256 )
+
+/*! number of buckets counting the queued writes of each variable
+    (a power of two) */
+#define WRITE_PENDING_BUCKETS ( 1024 )
+
+/*==============================================================================
+        Public Function Declarations
+==============================================================================*/
+
+int StartWriter( void );
+void StopWriter( void );
+int WriteVar( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar, VarObject *pObj );
+int FlushWrites( void );
+bool WritePending( VAR_HANDLE hVar );
+bool WritesIdle( void );
+void SetDirectWrites( bool direct );
+
+#endif
@@ -71,9 +71,14 @@ SOFTWARE.
 #include <signal.h>
 #include <syslog.h>
 #include <errno.h>
+#include <time.h>
 #include <varserver/varserver.h>
 #include "actiontypes.h"
 #include "engine.h"
+#include "scheduler.h"
+#include "control.h"
+#include "writer.h"
+#include "lineno.h"
 
 /*==============================================================================
        Function declarations
@@ -81,7 +86,11 @@ SOFTWARE.
 static void usage( char *cmdname );
 int yylex(void);
 int yyparse(void);
+void SetScriptName( char *filename );
+int OpenScript( char *filename );
+void CloseScript( void );
 static int ParseActions( char *filename );
+static void ReportParseTime( Actions *pActions, struct timespec *pStart );
 static void SetupTerminationHandler( void );
 static void TerminationHandler( int signum, siginfo_t *info, void *ptr );
 static int ProcessOptions( int argC,
@@ -125,6 +134,9 @@ Actions *pActions;
 ==============================================================================*/
 int main(int argC, char *argV[])
 {
+    int rc;
+    struct timespec start;
+
     pActions = NULL;
 
     /* initialize the varactions library */
@@ -141,11 +153,57 @@ int main(int argC, char *argV[])
             /* Process Options */
             ProcessOptions( argC, argV, pActions );
 
+            /* start the log thread before anything is logged */
+            if ( StartLog( pActions->logLevel, pActions->logTarget ) != EOK )
+            {
+                fprintf( stderr, "cannot start logging\n" );
+            }
+
             /* parse the Actions definition */
-            if (ParseActions( pActions->filename ) == EOK )
+            clock_gettime( CLOCK_MONOTONIC, &start );
+            rc = ParseActions( pActions->filename );
+
+            if ( pActions->timing == true )
             {
+                /* report the parse throughput instead of running */
+                ReportParseTime( pActions, &start );
+            }
+            else if ( rc == EOK )
+            {
+                /* accept runtime control requests */
+                if ( pActions->controlPath != NULL )
+                {
+                    rc = OpenControl( pActions->controlPath );
+                    if ( rc != EOK )
+                    {
+                        LogMessage( LOGLEVEL_eERROR,
+                                    "cannot open control socket %s: %s",
+                                    pActions->controlPath,
+                                    strerror( rc ) );
+                    }
+                }
+
+                /* lock the parsed program in memory and apply the
+                   real-time scheduling options */
+                (void)ApplyRealtime( &pActions->realtime );
+
+                /* issue system variable writes from a writer thread */
+                if ( pActions->asyncWrites == true )
+                {
+                    rc = StartWriter();
+                    if ( rc != EOK )
+                    {
+                        LogMessage( LOGLEVEL_eERROR,
+                                    "cannot start writer thread: %s",
+                                    strerror( rc ) );
+                    }
+                }
+
                 /* run the actions */
                 RunActions( pActions );
+
+                /* complete the queued variable writes */
+                StopWriter();
             }
 
             /* we should reach here only if the
@@ -162,6 +220,36 @@ int main(int argC, char *argV[])
                 free( pActions->filename );
                 pActions->filename = NULL;
             }
+
+            if ( pActions->metrics != NULL )
+            {
+                free( pActions->metrics );
+                pActions->metrics = NULL;
+            }
+
+            /* remove the control socket */
+            CloseControl();
+
+            if ( pActions->controlPath != NULL )
+            {
+                free( pActions->controlPath );
+                pActions->controlPath = NULL;
+            }
+
+            if ( pActions->snapshotPath != NULL )
+            {
+                free( pActions->snapshotPath );
+                pActions->snapshotPath = NULL;
+            }
+
+            /* write out any pending log records */
+            StopLog();
+
+            if ( pActions->logTarget != NULL )
+            {
+                free( pActions->logTarget );
+                pActions->logTarget = NULL;
+            }
         }
 
         free( pActions );
@@ -188,26 +276,76 @@ int main(int argC, char *argV[])
 static int ParseActions( char *filename )
 {
     int result = EINVAL;
-    extern FILE *yyin;
-    int tok;
 
     if ( filename != NULL )
     {
         /* open the actions definition file */
-        yyin = fopen( filename, "r" );
-        if ( yyin != NULL )
+        if ( OpenScript( filename ) == EOK )
         {
+            /* included files are found relative to the actions file */
+            SetScriptName( filename );
+
             /* parse the actions file */
             if ( yyparse() == 0 )
             {
                 result = EOK;
             }
+
+            CloseScript();
         }
     }
 
     return result;
 }
 
+/*============================================================================*/
+/*  ReportParseTime                                                           */
+/*!
+    Report the parse throughput
+
+    The ReportParseTime function writes the number of lines and actions
+    parsed, the time taken to parse them and the resulting throughput
+    to stdout, as a benchmark of the script parser.
+
+    @param[in]
+        pActions
+            pointer to the Actions object
+
+    @param[in]
+        pStart
+            pointer to the time at which parsing started
+
+    @return none
+
+==============================================================================*/
+static void ReportParseTime( Actions *pActions, struct timespec *pStart )
+{
+    struct timespec now;
+    Action *pAction;
+    size_t count = 0;
+    double ms;
+    int lines = getlinecount();
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    ms = ( now.tv_sec - pStart->tv_sec ) * 1000.0 +
+         ( now.tv_nsec - pStart->tv_nsec ) / 1000000.0;
+
+    for ( pAction = pActions->pActionList;
+          pAction != NULL;
+          pAction = pAction->pNext )
+    {
+        count++;
+    }
+
+    fprintf( stdout,
+             "%s: %d lines, %zu actions parsed in %.3f ms (%.0f lines/s)\n",
+             ( pActions->filename != NULL ) ? pActions->filename : "",
+             lines,
+             count,
+             ms,
+             ( ms > 0.0 ) ? lines * 1000.0 / ms : 0.0 );
+}
+
 /*============================================================================*/
 /*  usage                                                                     */
 /*!
@@ -228,9 +366,33 @@ static void usage( char *cmdname )
     if( cmdname != NULL )
     {
         fprintf(stderr,
-                "usage: %s [-v] [-h] [<filename>]\n"
+                "usage: %s [-v] [-h] [-q backlog] [-Q priority] [-b budget]"
+                " [-m prefix] [-k period] [-s off|auto]\n"
+                "       [-P fifo|rr:priority] [-a cpulist] [-L] [-r]"
+                " [-l level[:target]]\n"
+                "       [-c socket] [-t] [-w snapshot] [-A] [<filename>]\n"
                 " [-h] : display this help\n"
-                " [-v] : verbose output\n",
+                " [-v] : verbose output\n"
+                " [-q] : event backlog above which low priority events are shed\n"
+                " [-Q] : shed events for actions below this priority (default 1)\n"
+                " [-b] : default action execution budget in milliseconds\n"
+                " [-m] : prefix of the VarServer metrics variables\n"
+                " [-k] : static variable checkpoint and snapshot period in"
+                " seconds (default 60)\n"
+                " [-s] : stagger the phases of the every timers"
+                " (default auto)\n"
+                " [-P] : real-time scheduling policy and priority,"
+                " e.g. fifo:50\n"
+                " [-a] : CPU affinity list, e.g. 0,2-3\n"
+                " [-L] : lock and pre-fault memory after parsing\n"
+                " [-r] : profile and reorder compound if conditions\n"
+                " [-l] : log level (none, error, warning, info, debug) and"
+                " target\n"
+                "        (syslog, stdout, stderr or a file name)\n"
+                " [-c] : path of the runtime control socket\n"
+                " [-t] : report the parse time of the script and exit\n"
+                " [-w] : engine state snapshot file for warm restarts\n"
+                " [-A] : queue system variable writes to a writer thread\n",
                 cmdname );
     }
 }
@@ -265,11 +427,16 @@ static int ProcessOptions( int argC,
 {
     int c;
     int result = EINVAL;
-    const char *options = "hvoH:";
+    const char *options = "hvoH:q:Q:b:m:k:s:P:a:Lrl:c:tw:A";
+    char *target;
 
     if( ( pActions != NULL ) &&
         ( argV != NULL ) )
     {
+        pActions->shedPriority = MIN_PRIORITY + 1;
+        pActions->checkpointPeriod = DEFAULT_CHECKPOINT_PERIOD;
+        pActions->stagger = true;
+
         while( ( c = getopt( argC, argV, options ) ) != -1 )
         {
             switch( c )
@@ -282,6 +449,87 @@ static int ProcessOptions( int argC,
                     pActions->output = true;
                     break;
 
+                case 'q':
+                    pActions->backlogLimit = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'Q':
+                    pActions->shedPriority = atoi( optarg );
+                    break;
+
+                case 'b':
+                    pActions->budget = strtoull( optarg, NULL, 0 );
+                    break;
+
+                case 'm':
+                    pActions->metrics = strdup( optarg );
+                    break;
+
+                case 'k':
+                    pActions->checkpointPeriod = atoi( optarg );
+                    break;
+
+                case 's':
+                    pActions->stagger = ( strcmp( optarg, "off" ) != 0 );
+                    break;
+
+                case 'P':
+                    if ( ParseSchedPolicy( optarg,
+                                           &pActions->realtime ) != EOK )
+                    {
+                        fprintf( stderr, "invalid policy: %s\n", optarg );
+                    }
+                    break;
+
+                case 'a':
+                    if ( ParseCpuList( optarg,
+                                       &pActions->realtime ) != EOK )
+                    {
+                        fprintf( stderr, "invalid cpu list: %s\n", optarg );
+                    }
+                    break;
+
+                case 'L':
+                    pActions->realtime.lock = true;
+                    break;
+
+                case 'r':
+                    pActions->profile = true;
+                    break;
+
+                case 'l':
+                    /* split the level from the optional target */
+                    target = strchr( optarg, ':' );
+                    if ( target != NULL )
+                    {
+                        *target++ = '\0';
+                        free( pActions->logTarget );
+                        pActions->logTarget = strdup( target );
+                    }
+
+                    if ( ParseLogLevel( optarg,
+                                        &pActions->logLevel ) != EOK )
+                    {
+                        fprintf( stderr, "invalid log level: %s\n", optarg );
+                    }
+                    break;
+
+                case 'c':
+                    pActions->controlPath = strdup( optarg );
+                    break;
+
+                case 't':
+                    pActions->timing = true;
+                    break;
+
+                case 'w':
+                    pActions->snapshotPath = strdup( optarg );
+                    break;
+
+                case 'A':
+                    pActions->asyncWrites = true;
+                    break;
+
                 case 'h':
                     usage( argV[0] );
                     break;
@@ -296,6 +544,24 @@ static int ProcessOptions( int argC,
         {
             pActions->filename = strdup(argV[optind]);
         }
+
+        /* verbose output logs everything to stdout unless a log
+           level was specified */
+        if ( pActions->logLevel == LOGLEVEL_eDEFAULT )
+        {
+            if ( pActions->verbose == true )
+            {
+                pActions->logLevel = LOGLEVEL_eDEBUG;
+                if ( pActions->logTarget == NULL )
+                {
+                    pActions->logTarget = strdup( "stdout" );
+                }
+            }
+            else
+            {
+                pActions->logLevel = LOGLEVEL_eWARNING;
+            }
+        }
     }
 
     return 0;
@@ -352,6 +618,9 @@ static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
 {
     syslog( LOG_ERR, "Abnormal termination of actions\n" );
 
+    /* remove the control socket */
+    CloseControl();
+
     if ( pActions != NULL )
     {
         if ( pActions->hVarServer != NULL )
@@ -35,13 +35,20 @@ SOFTWARE.
 #include <unistd.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <errno.h>
 #include <signal.h>
 #include <syslog.h>
+#include <fnmatch.h>
+#include <stddef.h>
 #include <varserver/varserver.h>
 #include <varaction/varaction.h>
 #include "actiontypes.h"
 #include "timer.h"
+#include "scheduler.h"
 #include "lineno.h"
+#include "strbuild.h"
+#include "log.h"
+#include "intern.h"
 
 /*==============================================================================
        Definitions
@@ -49,6 +56,20 @@ SOFTWARE.
 
 #define YYSTYPE void *
 
+/* script types which have no libvaraction type code of their own */
+#define TYPE_INT64  ( 0x100 )
+#define TYPE_UINT64 ( 0x101 )
+#define TYPE_BOOL   ( 0x102 )
+
+/* offsets of the links of the lists built by the left recursive rules */
+#define ACTION_LINK      offsetof( Action, pNext )
+#define STATEMENT_LINK   offsetof( Statement, pNext )
+#define SIGNAL_LINK      offsetof( Signal, pNext )
+#define DECLARATION_LINK offsetof( Variable, pNext )
+
+/* link to the next item of a list */
+#define NEXT( pItem, link ) ( *(void **)( (char *)( pItem ) + ( link ) ) )
+
 #ifdef YYDEBUG
   yydebug = 1;
 #endif
@@ -72,6 +93,163 @@ int yylex(void);
 /* error flag */
 static bool errorFlag = false;
 
+/* system variables read by the action currently being parsed */
+static VarRef *pReadRefs = NULL;
+
+/* system variables written by the action currently being parsed */
+static VarRef *pWriteRefs = NULL;
+
+/* attributes of the action currently being parsed */
+static int priority = 0;
+static uint64_t deadline = 0;
+static uint64_t budget = 0;
+static LogLevel logLevel = LOGLEVEL_eDEFAULT;
+static int actionLine = 0;
+
+/* wall clock schedule attributes of the action currently being parsed */
+static bool aligned = false;
+static uint64_t jitter = 0;
+static uint64_t offset = 0;
+static bool fixedOffset = false;
+
+/* when guard of the action currently being parsed */
+static Guard *pGuard = NULL;
+
+/* streaming aggregates used by the action currently being parsed */
+static Aggregate *pAggregateList = NULL;
+
+/* triggering variable references in the action currently being parsed */
+static Trigger *pTriggerList = NULL;
+
+/* name of the first signal of the action currently being parsed */
+static char *triggerName = NULL;
+
+/*! numeric constant reference */
+typedef struct _constant
+{
+    /*! pointer to the numeric constant expression node */
+    Variable *pVariable;
+
+    /*! pointer to the next constant */
+    struct _constant *pNext;
+} Constant;
+
+/* numeric constants of the action currently being parsed */
+static Constant *pConstants = NULL;
+
+/* static local variables of the action currently being parsed */
+static StaticVar *pStaticList = NULL;
+
+/*! string concatenation chain */
+typedef struct _chain
+{
+    /*! pointer to the string expression node */
+    Variable *pVariable;
+
+    /*! segments which build the string expression */
+    Segment *pSegments;
+
+    /*! pointer to the next chain */
+    struct _chain *pNext;
+} Chain;
+
+/* string concatenation chains of the action currently being parsed */
+static Chain *pChains = NULL;
+
+/* string builders of the action currently being parsed */
+static StringBuilder *pBuilderList = NULL;
+
+/* queued assignments of the action currently being parsed */
+static QueuedAssignment *pAssignmentList = NULL;
+
+/* system variables read since the end of the last statement */
+static VarRef *pStatementReads = NULL;
+
+/*! logical && or || expression */
+typedef struct _logical
+{
+    /*! pointer to the logical expression node */
+    Variable *pVariable;
+
+    /*! logical operation (VA_AND or VA_OR) */
+    int type;
+
+    /*! pointer to the left operand */
+    Variable *pLeft;
+
+    /*! pointer to the right operand */
+    Variable *pRight;
+
+    /*! pointer to the next logical expression */
+    struct _logical *pNext;
+} Logical;
+
+/* logical expressions of the action currently being parsed */
+static Logical *pLogicals = NULL;
+
+/*! side-effect free guard equivalent of an expression */
+typedef struct _shadow
+{
+    /*! pointer to the expression node */
+    Variable *pVariable;
+
+    /*! pointer to the equivalent guard expression */
+    Guard *pGuard;
+
+    /*! pointer to the next shadow */
+    struct _shadow *pNext;
+} Shadow;
+
+/* guard equivalents of the expressions of the action being parsed */
+static Shadow *pShadows = NULL;
+
+/* profiled conditions of the action currently being parsed */
+static Condition *pConditionList = NULL;
+
+/*! local variable declaration */
+typedef struct _local
+{
+    /*! pointer to the declared local variable */
+    Variable *pVariable;
+
+    /*! pointer to the next local variable */
+    struct _local *pNext;
+} Local;
+
+/* local variables of the action currently being parsed */
+static Local *pLocals = NULL;
+
+/* variable sets of the action currently being parsed */
+static VarSet *pSetList = NULL;
+
+/* trigger name before the members of a variable set were parsed */
+static char *setTriggerName = NULL;
+
+/* for each loops of the action currently being parsed */
+static Loop *pLoopList = NULL;
+
+/* variable set reductions of the action currently being parsed */
+static Reduction *pReductionList = NULL;
+
+/* after and cancel statements of the action currently being parsed */
+static Delay *pDelayList = NULL;
+
+/* delayed actions created by the action currently being parsed */
+static Action *pPendingDelays = NULL;
+
+/* delayed actions of all parsed actions */
+static Action *pDelayedActions = NULL;
+
+/*! calc result cache specification */
+typedef struct _cacheSpec
+{
+    /*! caching mode */
+    CacheMode mode;
+
+    /*! cache lifetime in milliseconds */
+    uint64_t ttl;
+} CacheSpec;
+
 /*==============================================================================
        Function definitions
 ==============================================================================*/
@@ -79,6 +257,7 @@ static bool errorFlag = false;
 static void *OnInit( void *declarations, void *statements );
 static void *OnCalc( bool init,
                      void *signals,
+                     void *cache,
                      void *declarations,
                      void *statements );
 static void *OnChange( bool init,
@@ -94,6 +273,107 @@ static void *Every( bool init,
 static int RequestCalcSignals( Signal *pSignal );
 static int RequestModifiedSignals( Signal *pSignal );
 static void *NewSignal( void *variable );
+static void AddWatch( VAR_HANDLE hVar, int type );
+static void NoteReference( VarRef **ppRefs, void *variable );
+static void AttachReferences( Action *pAction );
+static int GetNumber( Variable *pVariable );
+static void *NewCacheSpec( CacheMode mode, void *interval, void *timescale );
+static int RequestInputSignals( Action *pAction );
+static bool FindSignalVariable( Signal *pSignal, VAR_HANDLE hVar );
+static void SetPriority( void *number );
+static void SetDeadline( void *interval, void *timescale );
+static void SetBudget( void *interval, void *timescale );
+static void SetLogLevel( void *level );
+static void SetJitter( void *interval, void *timescale );
+static void SetOffset( void *interval, void *timescale );
+static void *NewGuardOperand( void *variable );
+static void *At( bool cron,
+                 void *spec,
+                 void *declaration_list,
+                 void *statement_list );
+static uint64_t ScheduleJitter( void );
+static int WatchVariable( VAR_HANDLE hVar, int type );
+static void *NewAggregateVariable( AggregateType type,
+                                   void *variable,
+                                   void *interval,
+                                   void *timescale,
+                                   void *alpha );
+static void *NewWildcardSignals( char *pattern );
+static void *NewTriggerVariable( void );
+static void *NewStaticDeclaration( void *type, void *id, void *checkpoint );
+static void NoteChain( void *variable, Segment *pSegments );
+static Segment *TakeChain( void *variable );
+static void ClearChains( void );
+static void *Concatenate( void *left, void *right );
+static void *FormatCast( void *format, void *variable );
+static void NoteStringAssignment( void *assignment,
+                                  void *variable,
+                                  void *expression );
+static void NoteAssignment( void *assignment,
+                            void *variable,
+                            void *expression );
+static void NoteStatement( Statement *pStatement );
+static StringBuilder *AttachStringBuilders( Statement *pStatements );
+static void ClearStringBuilders( void );
+static QueuedAssignment *AttachAssignments( Statement *pStatements );
+static void ClearAssignments( void );
+static void FreeReferences( VarRef *pRefs );
+static void *NewDelay( void *interval, void *timescale, void *statements );
+static Delay *AttachDelays( Statement *pStatements );
+static void AttachDelayedActions( Action *pActionList );
+static void *AppendList( void *tail, void *items, size_t link );
+static void *CloseList( void *tail, size_t link );
+static void NoteConstant( void *variable );
+static bool TakeConstant( Variable *pVariable );
+static void ClearConstants( void );
+static void *FoldConstants( int type, void *left, void *right );
+static bool FoldInteger( int type, VarObject *pLeft, VarObject *pRight,
+                         VarObject *pResult );
+static bool FoldFloat( int type, float left, float right, float *pResult );
+static void *NewLogical( int type, void *left, void *right );
+static Logical *FindLogical( Variable *pVariable );
+static void ClearLogicals( void );
+static void *NewSelection( void *condition,
+                           void *thenStatements,
+                           void *elseStatements );
+static Variable *LowerCondition( Variable *pCondition,
+                                 Statement *pThen,
+                                 Statement *pElse );
+static Variable *NewCondition( int type,
+                               Variable *pExpression,
+                               Statement *pThen,
+                               Statement *pElse );
+static size_t FlattenCondition( Variable *pVariable,
+                                int type,
+                                Variable **ppOperands,
+                                Guard **ppGuards );
+static void ShadowInput( void *variable );
+static void ShadowConstant( void *variable );
+static void ShadowOperation( GuardOp op,
+                             void *variable,
+                             void *left,
+                             void *right );
+static void NoteShadow( Variable *pVariable, Guard *pGuard );
+static Guard *FindShadow( Variable *pVariable );
+static void ClearShadows( void );
+static Condition *AttachConditions( Statement *pStatements );
+static void WatchGuardInputs( Guard *pGuard );
+static void ClearConditions( void );
+static void FreeCondition( Condition *pCondition );
+static void *NewTypedDeclaration( void *type, void *id );
+static void *NewWideNumber( void );
+static void *NativeCast( void *type, void *variable, bool constant );
+static bool FoldWide( int type, VarObject *pLeft, VarObject *pRight,
+                      VarObject *pResult );
+static void NoteLocal( Variable *pVariable );
+static Variable *FindLocal( char *id );
+static void ClearLocals( void );
+static void *NewVariableSet( void *name, void *signals );
+static VarSet *FindVarSet( char *name, bool required );
+static void *NewLoop( void *variable, void *set );
+static void *SetLoopBody( void *loop, void *statements );
+static Loop *AttachLoops( Statement *pStatements );
+static void *NewReduction( ReduceOp op, void *set );
 
 %}
 
@@ -105,6 +385,29 @@ static void *NewSignal( void *variable );
 %token CHANGE
 %token CALC
 %token INIT
+%token CACHE
+%token UNTIL
+%token PRIORITY
+%token DEADLINE
+%token BUDGET
+%token LOG
+%token AVG
+%token MIN
+%token MAX
+%token RATE
+%token EWMA
+%token TRIGGER
+%token WILDCARD
+%token STATIC
+%token PERSIST
+%token AFTER
+%token CANCEL
+%token ALIGNED
+%token AT
+%token CRON
+%token JITTER
+%token OFFSET
+%token WHEN
 %token MS
 %token SECONDS
 %token MINUTES
@@ -153,6 +456,17 @@ static void *NewSignal( void *variable );
 %token INT
 %token SHORT
 %token STRING
+%token INT64
+%token UINT64
+%token BOOL
+%token FOR
+%token EACH
+%token IN
+%token SET
+%token SUM
+%token OF
+%token TRUE_VALUE
+%token FALSE_VALUE
 %token BAND
 %token BOR
 %token XOR
@@ -175,6 +489,7 @@ actions : ACTIONS LBRACE name description action_list RBRACE
                     pActions->name = $3;
                     pActions->description = $4;
                     pActions->pActionList = $5;
+                    AttachDelayedActions( $5 );
                 }
                 $$ = pActions;
              }
@@ -192,60 +507,210 @@ description :  DESCRIPTION COLON string
             }
             ;
 
-action_list
-		: 	action action_list
-			{
-                Action *pAction = $1;
-                if ( pAction != NULL )
-                {
-                    pAction->pNext = $2;
-                }
-                $$ = pAction;
-			}
+action_list : action_sequence
+            {
+                $$ = CloseList( $1, ACTION_LINK );
+            }
+            ;
 
-        | 	{ $$ = NULL; }
-        ;
+action_sequence : action_sequence action
+            {
+                $$ = AppendList( $1, $2, ACTION_LINK );
+            }
+            | { $$ = NULL; }
+            ;
 
 action
-        :   ON INIT LBRACE declaration_list statement_list RBRACE
+        :   ON INIT attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnInit( $5, $6 );
+            }
+        |   ON CALC signal_list cache_option attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnCalc( false, $3, $4, $7, $8 );
+            }
+        |   ON CALC INIT signal_list cache_option attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnCalc( true, $4, $5, $8, $9 );
+            }
+        |   ON INIT CALC signal_list cache_option attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnCalc( true, $4, $5, $8, $9 );
+            }
+        |   ON CHANGE signal_list attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnChange( false, $3, $6, $7 );
+            }
+        |   ON CHANGE INIT signal_list attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnChange( true, $4, $7, $8 );
+            }
+        |   ON INIT CHANGE signal_list attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = OnChange( true, $4, $7, $8 );
+            }
+        |   EVERY number timespan attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = Every( false, $2, $3, $6, $7 );
+            }
+        |   INIT EVERY number timespan attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = Every( false, $3, $4, $7, $8 );
+            }
+        |   EVERY INIT number timespan attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = Every( false, $3, $4, $7, $8 );
+            }
+        |   AT string attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = At( false, $2, $5, $6 );
+            }
+        |   CRON string attributes LBRACE declaration_list statement_list RBRACE
+            {
+                $$ = At( true, $2, $5, $6 );
+            }
+        ;
+
+attributes : attributes attribute
+        |
+            {
+                /* the action header ends here */
+                actionLine = getlineno() + 1;
+            }
+        ;
+
+attribute : PRIORITY number
+            {
+                SetPriority( $2 );
+            }
+        |   DEADLINE number timespan
+            {
+                SetDeadline( $2, $3 );
+            }
+        |   BUDGET number timespan
+            {
+                SetBudget( $2, $3 );
+            }
+        |   LOG string
+            {
+                SetLogLevel( $2 );
+            }
+        |   ALIGNED
+            {
+                aligned = true;
+            }
+        |   JITTER number timespan
+            {
+                SetJitter( $2, $3 );
+            }
+        |   OFFSET number timespan
+            {
+                SetOffset( $2, $3 );
+            }
+        |   WHEN guard_expression
+            {
+                pGuard = $2;
+            }
+        ;
+
+guard_expression
+        :   guard_and_expression
+            {
+                $$ = $1;
+            }
+        |   guard_expression OR guard_and_expression
+            {
+                $$ = NewGuard( GUARD_eOR, $1, $3 );
+            }
+        ;
+
+guard_and_expression
+        :   guard_unary_expression
+            {
+                $$ = $1;
+            }
+        |   guard_and_expression AND guard_unary_expression
+            {
+                $$ = NewGuard( GUARD_eAND, $1, $3 );
+            }
+        ;
+
+guard_unary_expression
+        :   guard_relational_expression
             {
-                $$ = OnInit( $4, $5 );
+                $$ = $1;
+            }
+        |   NOT guard_unary_expression
+            {
+                $$ = NewGuard( GUARD_eNOT, $2, NULL );
+            }
+        ;
+
+guard_relational_expression
+        :   guard_operand
+            {
+                $$ = $1;
+            }
+        |   guard_operand EQUALS guard_operand
+            {
+                $$ = NewGuard( GUARD_eEQUALS, $1, $3 );
+            }
+        |   guard_operand NOTEQUALS guard_operand
+            {
+                $$ = NewGuard( GUARD_eNOTEQUALS, $1, $3 );
+            }
+        |   guard_operand LT guard_operand
+            {
+                $$ = NewGuard( GUARD_eLT, $1, $3 );
+            }
+        |   guard_operand GT guard_operand
+            {
+                $$ = NewGuard( GUARD_eGT, $1, $3 );
             }
-        |   ON CALC signal_list LBRACE declaration_list statement_list RBRACE
+        |   guard_operand LTE guard_operand
             {
-                $$ = OnCalc( false, $3, $5, $6 );
+                $$ = NewGuard( GUARD_eLTE, $1, $3 );
             }
-        |   ON CALC INIT signal_list LBRACE declaration_list statement_list RBRACE
+        |   guard_operand GTE guard_operand
             {
-                $$ = OnCalc( true, $4, $6, $7 );
+                $$ = NewGuard( GUARD_eGTE, $1, $3 );
             }
-        |   ON INIT CALC signal_list LBRACE declaration_list statement_list RBRACE
+        ;
+
+guard_operand
+        :   identifier
+            {
+                $$ = NewGuardOperand( $1 );
+            }
+        |   number
             {
-                $$ = OnCalc( true, $4, $6, $7 );
+                $$ = NewGuardConstant( &((Variable *)$1)->obj );
             }
-        |   ON CHANGE signal_list LBRACE declaration_list statement_list RBRACE
+        |   floatnum
             {
-                $$ = OnChange( false, $3, $5, $6 );
+                $$ = NewGuardConstant( &((Variable *)$1)->obj );
             }
-        |   ON CHANGE INIT signal_list LBRACE declaration_list statement_list RBRACE
+        |   boolean
             {
-                $$ = OnChange( true, $4, $6, $7 );
+                $$ = NewGuardConstant( &((Variable *)$1)->obj );
             }
-        |   ON INIT CHANGE signal_list LBRACE declaration_list statement_list RBRACE
+        |   LPAREN guard_expression RPAREN
             {
-                $$ = OnChange( true, $4, $6, $7 );
+                $$ = $2;
             }
-        |   EVERY number timespan LBRACE declaration_list statement_list RBRACE
+        ;
+
+cache_option : CACHE number timespan
             {
-                $$ = Every( false, $2, $3, $5, $6 );
+                $$ = NewCacheSpec( CACHE_eTIMED, $2, $3 );
             }
-        |   INIT EVERY number timespan LBRACE declaration_list statement_list RBRACE
+        |   CACHE UNTIL CHANGE
             {
-                $$ = Every( false, $3, $4, $6, $7 );
+                $$ = NewCacheSpec( CACHE_eUNTIL_CHANGE, NULL, NULL );
             }
-        |   EVERY INIT number timespan LBRACE declaration_list statement_list RBRACE
+        |
             {
-                $$ = Every( false, $3, $4, $6, $7 );
+                $$ = NULL;
             }
         ;
 
@@ -257,19 +722,13 @@ timespan : MS { $$ = (void *)TIMESCALE_eMILLISECONDS; }
          | WEEKS { $$ = (void *)TIMESCALE_eWEEKS; }
          ;
 
-signal_list : signal COMMA signal_list
+signal_list : signal_sequence
         {
-            Signal *pSignal = (Signal *)$1;
-            if ( pSignal != NULL )
-            {
-                pSignal->pNext = $3;
-            }
-
-            $$ = $1;
+            $$ = CloseList( $1, SIGNAL_LINK );
         }
-        |   signal
+        |   signal_sequence COMMA
         {
-            $$ = $1;
+            $$ = CloseList( $1, SIGNAL_LINK );
         }
         |
         {
@@ -277,20 +736,36 @@ signal_list : signal COMMA signal_list
         }
         ;
 
+signal_sequence : signal
+        {
+            /* a wildcard signal may expand to several signals */
+            $$ = AppendList( NULL, $1, SIGNAL_LINK );
+        }
+        |   signal_sequence COMMA signal
+        {
+            $$ = AppendList( $1, $3, SIGNAL_LINK );
+        }
+        ;
+
 signal : identifier
         {
             $$ = NewSignal( $1 );
         }
+       | WILDCARD
+        {
+            $$ = NewWildcardSignals( yytext );
+        }
        ;
 
-statement_list : statement statement_list
+statement_list : statement_sequence
         {
-            Statement *pStatement = (Statement *)$1;
-            if ( pStatement != NULL )
-            {
-                pStatement->pNext = $2;
-            }
-            $$ = $1;
+            $$ = CloseList( $1, STATEMENT_LINK );
+        }
+        ;
+
+statement_sequence : statement_sequence statement
+        {
+            $$ = AppendList( $1, $2, STATEMENT_LINK );
         }
         | { $$ = NULL; }
         ;
@@ -301,6 +776,7 @@ statement : expression SEMICOLON
                if ( pStatement != NULL )
                {
                    pStatement->pVariable = $1;
+                   NoteStatement( pStatement );
                }
 
                $$ = (void *)pStatement;
@@ -325,44 +801,110 @@ statement : expression SEMICOLON
 
                $$ = (void *)pStatement;
             }
+          | delay_statement
+            {
+               $$ = $1;
+            }
+          | loop_statement
+            {
+               $$ = $1;
+            }
           | SEMICOLON
             {
+                $$ = NULL;
+            }
+          ;
+
+delay_statement : AFTER number timespan compound_statement
+            {
+                $$ = NewDelay( $2, $3, $4 );
+            }
+          | CANCEL SEMICOLON
+            {
+                $$ = NewDelay( NULL, NULL, NULL );
+            }
+          ;
+
+loop_statement : loop_header compound_statement
+            {
+                $$ = SetLoopBody( $1, $2 );
+            }
+          ;
+
+loop_header : FOR EACH identifier IN set_reference
+            {
+                $$ = NewLoop( $3, $5 );
             }
           ;
 
-declaration_list : declaration SEMICOLON declaration_list
+declaration_list : declaration_sequence
                    {
-                        Variable *pVariable = (Variable *)$1;
-                        if ( pVariable != NULL )
+                        $$ = CloseList( $1, DECLARATION_LINK );
+                        if ( $$ != NULL )
                         {
-                            pVariable->pNext = $3;
+                            /* set up the local variable declarations */
+                            SetDeclarations( $$ );
                         }
+                   }
+                 ;
 
-                        $$ = $1;
-
-                        /* set up the local variable declarations */
-                        SetDeclarations( pVariable );
-                    }
+declaration_sequence : declaration_sequence declaration SEMICOLON
+                   {
+                        /* variable sets are not local variables */
+                        $$ = AppendList( $1, $2, DECLARATION_LINK );
+                   }
                  | { $$ = NULL; }
+                 ;
 
 declaration : type_specifier decl_id
             {
-                $$ = CreateDeclaration( (uintptr_t)$1, $2 );
+                $$ = NewTypedDeclaration( $1, $2 );
+            }
+            | STATIC type_specifier decl_id
+            {
+                $$ = NewStaticDeclaration( $2, $3, NULL );
+            }
+            | STATIC type_specifier decl_id PERSIST identifier
+            {
+                $$ = NewStaticDeclaration( $2, $3, $5 );
+            }
+            | SET set_name IN signal_list
+            {
+                $$ = NewVariableSet( $2, $4 );
             }
             ;
 
+set_name : ID
+        {
+            $$ = strdup( yytext );
+            setTriggerName = triggerName;
+        }
+        ;
+
+set_reference : ID
+        {
+            $$ = FindVarSet( yytext, true );
+        }
+        ;
+
 type_specifier : FLOAT { $$ = (void *)VA_FLOAT; }
                | INT { $$ = (void *)VA_INT; }
                | SHORT { $$ = (void *)VA_SHORT; }
                | STRING { $$ = (void *)VA_STRING; }
+               | native_type { $$ = $1; }
                ;
 
+native_type : INT64 { $$ = (void *)TYPE_INT64; }
+            | UINT64 { $$ = (void *)TYPE_UINT64; }
+            | BOOL { $$ = (void *)TYPE_BOOL; }
+            ;
+
 selection_statement
 		:	IF LPAREN expression RPAREN compound_statement   %prec "then"
-			{ $$ = CreateVariable(VA_IF,$3, CreateVariable(VA_ELSE,$5,NULL)); }
+			{ $$ = NewSelection( $3, $5, NULL ); }
 
 		|	IF LPAREN expression RPAREN compound_statement ELSE compound_statement
-			{ $$ = CreateVariable(VA_IF,$3, CreateVariable(VA_ELSE,$5,$7)); }
+			{ $$ = NewSelection( $3, $5, $7 ); }
 		;
 
 compound_statement: LBRACE statement_list RBRACE
@@ -389,7 +931,20 @@ assignment_expression
                 pVariable->assigned = true;
             }
 
+            if ( (uintptr_t)$2 != VA_ASSIGN )
+            {
+                NoteReference( &pReadRefs, $1 );
+            }
+
+            NoteReference( &pWriteRefs, $1 );
+
             $$ = CreateVariable( (uintptr_t)$2, $1, $3 );
+
+            if ( (uintptr_t)$2 == VA_ASSIGN )
+            {
+                NoteStringAssignment( $$, $1, $3 );
+                NoteAssignment( $$, $1, $3 );
+            }
         }
         ;
 
@@ -419,7 +974,7 @@ logical_OR_expression
         }
         |   logical_OR_expression OR logical_AND_expression
         {
-            $$ = CreateVariable( VA_OR, $1, $3 );
+            $$ = NewLogical( VA_OR, $1, $3 );
         }
         ;
 
@@ -430,7 +985,7 @@ logical_AND_expression
         }
         | logical_AND_expression AND inclusive_OR_expression
         {
-            $$ = CreateVariable( VA_AND, $1, $3 );
+            $$ = NewLogical( VA_AND, $1, $3 );
         }
         ;
 
@@ -441,7 +996,7 @@ inclusive_OR_expression
         }
         |   inclusive_OR_expression BOR exclusive_OR_expression
         {
-            $$ = CreateVariable( VA_BOR, $1, $3 );
+            $$ = FoldConstants( VA_BOR, $1, $3 );
         }
         ;
 
@@ -452,7 +1007,7 @@ exclusive_OR_expression
         }
         | exclusive_OR_expression XOR AND_expression
         {
-            $$ = CreateVariable( VA_XOR, $1, $3 );
+            $$ = FoldConstants( VA_XOR, $1, $3 );
         }
         ;
 
@@ -463,7 +1018,7 @@ AND_expression
         }
         |   AND_expression BAND equality_expression
         {
-            $$ = CreateVariable( VA_BAND, $1, $3 );
+            $$ = FoldConstants( VA_BAND, $1, $3 );
         }
         ;
 
@@ -475,10 +1030,12 @@ equality_expression
         |   equality_expression EQUALS relational_expression
         {
             $$ = CreateVariable( VA_EQUALS, $1, $3 );
+            ShadowOperation( GUARD_eEQUALS, $$, $1, $3 );
         }
         |   equality_expression NOTEQUALS relational_expression
         {
             $$ = CreateVariable( VA_NOTEQUALS, $1, $3 );
+            ShadowOperation( GUARD_eNOTEQUALS, $$, $1, $3 );
         }
         ;
 
@@ -490,18 +1047,22 @@ relational_expression
         |   relational_expression LT shift_expression
         {
             $$ = CreateVariable( VA_LT, $1, $3 );
+            ShadowOperation( GUARD_eLT, $$, $1, $3 );
         }
         |   relational_expression GT shift_expression
         {
             $$ = CreateVariable( VA_GT, $1, $3 );
+            ShadowOperation( GUARD_eGT, $$, $1, $3 );
         }
         |   relational_expression LTE shift_expression
         {
             $$ = CreateVariable( VA_LTE, $1, $3 );
+            ShadowOperation( GUARD_eLTE, $$, $1, $3 );
         }
         |   relational_expression GTE shift_expression
         {
             $$ = CreateVariable( VA_GTE, $1, $3 );
+            ShadowOperation( GUARD_eGTE, $$, $1, $3 );
         }
         ;
 
@@ -512,11 +1073,11 @@ shift_expression
         }
         |   shift_expression LSHIFT additive_expression
         {
-            $$ = CreateVariable( VA_LSHIFT, $1, $3 );
+            $$ = FoldConstants( VA_LSHIFT, $1, $3 );
         }
         |   shift_expression RSHIFT additive_expression
         {
-            $$ = CreateVariable( VA_RSHIFT, $1, $3 );
+            $$ = FoldConstants( VA_RSHIFT, $1, $3 );
         }
         ;
 
@@ -527,11 +1088,11 @@ additive_expression
         }
         |   additive_expression ADD multiplicative_expression
         {
-            $$ = CreateVariable( VA_ADD, $1, $3 );
+            $$ = Concatenate( $1, $3 );
         }
         |   additive_expression SUB multiplicative_expression
         {
-            $$ = CreateVariable( VA_SUB, $1, $3 );
+            $$ = FoldConstants( VA_SUB, $1, $3 );
         }
         ;
 
@@ -542,11 +1103,11 @@ multiplicative_expression
         }
         |   multiplicative_expression MUL unary_expression
         {
-            $$ = CreateVariable( VA_MUL, $1, $3 );
+            $$ = FoldConstants( VA_MUL, $1, $3 );
         }
         |   multiplicative_expression DIV unary_expression
         {
-            $$ = CreateVariable( VA_DIV, $1, $3 );
+            $$ = FoldConstants( VA_DIV, $1, $3 );
         }
         ;
 
@@ -558,16 +1119,21 @@ unary_expression
         |   INC identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
+            NoteReference( &pWriteRefs, $2 );
             $$ = CreateVariable( VA_INC, NULL, $2 );
         }
         |   DEC identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
+            NoteReference( &pWriteRefs, $2 );
             $$ = CreateVariable( VA_DEC, NULL, $2 );
         }
         |   NOT unary_expression
         {
             $$ = CreateVariable( VA_NOT, $2, NULL );
+            ShadowOperation( GUARD_eNOT, $$, $2, NULL );
         }
         ;
 
@@ -583,6 +1149,7 @@ typecast_expression
         | float_cast identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
             $$ = CreateVariable( VA_TOFLOAT, $2, NULL );
         }
         | int_cast floatnum
@@ -592,6 +1159,7 @@ typecast_expression
         | int_cast identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
             $$ = CreateVariable( VA_TOINT, $2, NULL );
         }
         | short_cast number
@@ -607,17 +1175,38 @@ typecast_expression
         | short_cast identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
             $$ = CreateVariable( VA_TOSHORT, $2, NULL );
         }
         | string_cast identifier
         {
             CheckUseBeforeAssign($2);
+            NoteReference( &pReadRefs, $2 );
             $$ = CreateVariable( VA_TOSTRING, $2, NULL );
         }
         | LPAREN STRING string RPAREN identifier
         {
             CheckUseBeforeAssign($5);
-            $$ = CreateVariable( VA_TOSTRING, $5, $3 );
+            NoteReference( &pReadRefs, $5 );
+            $$ = FormatCast( $3, $5 );
+        }
+        | LPAREN native_type RPAREN number
+        {
+            TakeConstant( $4 );
+            $$ = NativeCast( $2, $4, true );
+            NoteConstant( $$ );
+        }
+        | LPAREN native_type RPAREN floatnum
+        {
+            TakeConstant( $4 );
+            $$ = NativeCast( $2, $4, true );
+            NoteConstant( $$ );
+        }
+        | LPAREN native_type RPAREN identifier
+        {
+            CheckUseBeforeAssign($4);
+            NoteReference( &pReadRefs, $4 );
+            $$ = NativeCast( $2, $4, false );
         }
         ;
 
@@ -641,11 +1230,15 @@ postfix_expression
         |   identifier INC
         {
             CheckUseBeforeAssign($1);
+            NoteReference( &pReadRefs, $1 );
+            NoteReference( &pWriteRefs, $1 );
             $$ = CreateVariable( VA_INC, $1, NULL );
         }
         |   identifier DEC
         {
             CheckUseBeforeAssign($1);
+            NoteReference( &pReadRefs, $1 );
+            NoteReference( &pWriteRefs, $1 );
             $$ = CreateVariable( VA_DEC, $1, NULL );
         }
         ;
@@ -654,6 +1247,13 @@ primary_expression
         :   identifier
             {
                 CheckUseBeforeAssign($1);
+                NoteReference( &pReadRefs, $1 );
+                if ( ( $1 != NULL ) &&
+                     ( ((Variable *)$1)->obj.type == VARTYPE_STR ) )
+                {
+                    NoteChain( $1, NewFieldSegment( $1, NULL ) );
+                }
+                ShadowInput( $1 );
                 $$ = $1;
             }
         |   LPAREN expression RPAREN
@@ -662,39 +1262,95 @@ primary_expression
             }
         |   floatnum
             {
+                ShadowConstant( $1 );
                 $$ = $1;
             }
         |   number
             {
+                ShadowConstant( $1 );
+                $$ = $1;
+            }
+        |   boolean
+            {
+                ShadowConstant( $1 );
                 $$ = $1;
             }
         |   string
             {
                 $$ = $1;
             }
+        |   aggregate_expression
+            {
+                $$ = $1;
+            }
+        ;
+
+aggregate_expression
+        :   aggregate_function LPAREN identifier COMMA number timespan RPAREN
+            {
+                $$ = NewAggregateVariable( (uintptr_t)$1, $3, $5, $6, NULL );
+            }
+        |   EWMA LPAREN identifier COMMA floatnum RPAREN
+            {
+                $$ = NewAggregateVariable( AGGREGATE_eEWMA, $3, NULL, NULL, $5 );
+            }
+        |   reduction_function OF set_reference
+            {
+                $$ = NewReduction( (uintptr_t)$1, $3 );
+            }
+        ;
+
+reduction_function
+        :   SUM { $$ = (void *)REDUCE_eSUM; }
+        |   AVG { $$ = (void *)REDUCE_eAVG; }
+        |   MIN { $$ = (void *)REDUCE_eMIN; }
+        |   MAX { $$ = (void *)REDUCE_eMAX; }
+        ;
+
+aggregate_function
+        :   AVG { $$ = (void *)AGGREGATE_eAVG; }
+        |   MIN { $$ = (void *)AGGREGATE_eMIN; }
+        |   MAX { $$ = (void *)AGGREGATE_eMAX; }
+        |   RATE { $$ = (void *)AGGREGATE_eRATE; }
         ;
 
 script : SCRIPT
        {
-          $$ = strdup( yytext );
+          /* generated scripts often repeat the same script text */
+          $$ = Intern( yytext, strlen( yytext ) );
        }
        ;
 
 string : CHARSTR
         {
             $$ = NewString( yytext );
+            NoteChain( $$, NewLiteralSegment( yytext ) );
         }
        ;
 
 number : NUM
     {
-       $$ = NewNumber( yytext );
+       $$ = NewWideNumber();
+       NoteConstant( $$ );
     }
     ;
 
+boolean : TRUE_VALUE
+        {
+            $$ = NewNumber( "1" );
+            NoteConstant( $$ );
+        }
+        | FALSE_VALUE
+        {
+            $$ = NewNumber( "0" );
+            NoteConstant( $$ );
+        }
+        ;
+
 floatnum : FLOATNUM
          {
             $$ = NewFloat( yytext );
+            NoteConstant( $$ );
          }
          ;
 
@@ -702,13 +1358,42 @@ identifier : ID
    {
         $$ = NewIdentifier( pActions->hVarServer, yytext, false );
    }
+   | TRIGGER
+   {
+        $$ = NewTriggerVariable();
+   }
+   | keyword_id
+   {
+        $$ = NewIdentifier( pActions->hVarServer, (char *)$1, false );
+   }
    ;
 
 decl_id : ID
    {
         $$ = NewIdentifier( pActions->hVarServer, yytext, true );
    }
-   ;
+   | keyword_id
+   {
+        $$ = NewIdentifier( pActions->hVarServer, (char *)$1, true );
+   }
+   ;
+
+/* keywords which are only reserved where their construct can appear,
+   so scripts written before they were added can still use them as
+   variable names */
+keyword_id : AVG { $$ = "avg"; }
+   | MIN { $$ = "min"; }
+   | MAX { $$ = "max"; }
+   | RATE { $$ = "rate"; }
+   | EWMA { $$ = "ewma"; }
+   | PERSIST { $$ = "persist"; }
+   | AFTER { $$ = "after"; }
+   | FOR { $$ = "for"; }
+   | EACH { $$ = "each"; }
+   | IN { $$ = "in"; }
+   | SUM { $$ = "sum"; }
+   | OF { $$ = "of"; }
+   ;
 
 %%
 #include <stdio.h>
@@ -718,7 +1403,7 @@ decl_id : ID
 /*!
     Handle parser error
 
-	This procedure displays an error message with the line number on
+	This procedure logs an error message with the line number on
 	which the error occurred.
 
 @param[in]
@@ -730,7 +1415,19 @@ decl_id : ID
 ==============================================================================*/
 void yyerror( char *err )
 {
-    printf("%s at line %d\n",err, getlineno() + 1);
+    if ( getfilename() != NULL )
+    {
+        LogMessage( LOGLEVEL_eERROR,
+                    "%s at %s line %d",
+                    err,
+                    getfilename(),
+                    getlineno() + 1 );
+    }
+    else
+    {
+        LogMessage( LOGLEVEL_eERROR, "%s at line %d", err, getlineno() + 1 );
+    }
+
     errorFlag = true;
 }
 
@@ -782,6 +1479,8 @@ static void *OnChange( bool init,
         RequestModifiedSignals( pAction->pSignals );
     }
 
+    AttachReferences( pAction );
+
     /* clear the global declaration list */
     SetDeclarations( NULL );
 
@@ -824,6 +1523,8 @@ static void *OnInit( void *declarations, void *statements )
         pAction->pStatements = (Statement *)statements;
     }
 
+    AttachReferences( pAction );
+
     /* clear the global declaration list */
     SetDeclarations( NULL );
 
@@ -845,6 +1546,11 @@ static void *OnInit( void *declarations, void *statements )
     signals
         pointer to a list of signals to watch for
 
+@param[in]
+    cache
+        pointer to the calc result cache specification, or NULL
+        if the calc results are not cached
+
 @param[in]
     declarations
         pointer to a list of variable declarations for this action
@@ -859,12 +1565,14 @@ static void *OnInit( void *declarations, void *statements )
 ==============================================================================*/
 static void *OnCalc( bool init,
                      void *signals,
+                     void *cache,
                      void *declarations,
                      void *statements )
 {
     Signal *pSignal;
     int result;
     Action *pAction;
+    CacheSpec *pCacheSpec = (CacheSpec *)cache;
 
     pAction = (Action *)calloc( 1, sizeof( Action ) );
     if ( pAction != NULL )
@@ -872,12 +1580,38 @@ static void *OnCalc( bool init,
         pAction->init = init;
         pAction->pSignals = (Signal *)signals;
         pAction->signal = CALC_NOTIFICATION;
+
+        if ( pGuard != NULL )
+        {
+            yyerror("when cannot be used with calc actions");
+            pGuard = NULL;
+        }
         pAction->pDeclarations = (Variable *)declarations;
         pAction->pStatements = (Statement *)statements;
 
+        if ( pCacheSpec != NULL )
+        {
+            pAction->cacheMode = pCacheSpec->mode;
+            pAction->cacheTTL = pCacheSpec->ttl;
+        }
+
         RequestCalcSignals( pAction->pSignals );
     }
 
+    AttachReferences( pAction );
+
+    if ( ( pAction != NULL ) &&
+         ( pAction->cacheMode == CACHE_eUNTIL_CHANGE ) )
+    {
+        /* invalidate the cache when any of the inputs change */
+        RequestInputSignals( pAction );
+    }
+
+    if ( pCacheSpec != NULL )
+    {
+        free( pCacheSpec );
+    }
+
     /* clear the global declaration list */
     SetDeclarations( NULL );
 
@@ -935,24 +1669,28 @@ static void *Every( bool init,
         pAction->pStatements = statement_list;
         pAction->signal = TIMER_NOTIFICATION;
 
-        switch ( pVariable->obj.type )
-        {
-            case VARTYPE_UINT16:
-                num = pVariable->obj.val.ui;
-                break;
-
-            case VARTYPE_UINT32:
-                num = pVariable->obj.val.ul;
-                break;
+        num = GetNumber( pVariable );
 
-            default:
-                num = 0;
-                break;
+        if ( ( num != 0 ) && ( aligned == true ) )
+        {
+            pAction->timerID = CreateAligned( num,
+                                              ts,
+                                              offset + ScheduleJitter() );
         }
-
-        if ( num != 0 )
+        else if ( num != 0 )
         {
+            if ( jitter != 0 )
+            {
+                yyerror("jitter requires an aligned schedule");
+            }
+
             pAction->timerID = CreateTick( num, ts );
+            if ( ( pAction->timerID > 0 ) &&
+                 ( fixedOffset == true ) &&
+                 ( SetTickOffset( pAction->timerID, offset ) != EOK ) )
+            {
+                yyerror("offset must be less than the timer interval");
+            }
         }
 
         if( pAction->timerID <= 0 )
@@ -961,12 +1699,133 @@ static void *Every( bool init,
         }
     }
 
+    aligned = false;
+    jitter = 0;
+    offset = 0;
+    fixedOffset = false;
+
+    AttachReferences( pAction );
+
+    /* clear the global declaration list */
+    SetDeclarations( NULL );
+
+    return pAction;
+}
+
+/*============================================================================*/
+/*  At                                                                        */
+/*!
+    Create a new actions group which runs on a calendar schedule
+
+    The At function creates a new actions group which runs daily at
+    a HH:MM local time, or at the local times selected by a five
+    field cron expression.
+
+@param[in]
+    cron
+        true if spec is a cron expression, false if it is a time of day
+
+@param[in]
+    spec
+        pointer to the string variable containing the schedule
+
+@param[in]
+    declaration_list
+        pointer to a declaration list
+
+@param[in]
+    statement_list
+        pointer to the list of statements to execute for this action
+
+@retval pointer to the Action that we created
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *At( bool cron,
+                 void *spec,
+                 void *declaration_list,
+                 void *statement_list )
+{
+    Action *pAction = NULL;
+    Variable *pVariable = (Variable *)spec;
+    CronSpec cronSpec;
+    int rc = EINVAL;
+
+    if ( aligned == true )
+    {
+        yyerror("aligned applies only to every actions");
+    }
+
+    if ( ( pVariable != NULL ) && ( pVariable->obj.val.str != NULL ) )
+    {
+        rc = ( cron == true )
+                ? ParseCron( pVariable->obj.val.str, &cronSpec )
+                : ParseTimeOfDay( pVariable->obj.val.str, &cronSpec );
+    }
+
+    if ( rc != EOK )
+    {
+        yyerror( ( cron == true ) ? "Invalid cron expression"
+                                  : "Invalid time of day" );
+    }
+
+    pAction = (Action *)calloc( 1, sizeof( Action ) );
+    if ( pAction != NULL )
+    {
+        pAction->pDeclarations = declaration_list;
+        pAction->pStatements = statement_list;
+        pAction->signal = TIMER_NOTIFICATION;
+
+        if ( rc == EOK )
+        {
+            pAction->timerID = CreateCron( &cronSpec,
+                                           offset + ScheduleJitter() );
+            if ( pAction->timerID <= 0 )
+            {
+                yyerror("Failed to create timer");
+            }
+        }
+    }
+
+    aligned = false;
+    jitter = 0;
+    offset = 0;
+    fixedOffset = false;
+
+    AttachReferences( pAction );
+
     /* clear the global declaration list */
     SetDeclarations( NULL );
 
     return pAction;
 }
 
+/*============================================================================*/
+/*  ScheduleJitter                                                            */
+/*!
+    Get the schedule offset of the action being parsed
+
+    The ScheduleJitter function calculates the per-instance offset of
+    the wall clock schedule of the action currently being parsed.  The
+    offset is derived from the host name, script name and action line,
+    so it differs between devices but is stable across restarts.
+
+@retval offset of the schedule in milliseconds
+
+==============================================================================*/
+static uint64_t ScheduleJitter( void )
+{
+    char key[BUFSIZ];
+
+    snprintf( key,
+              sizeof( key ),
+              "%s:%d",
+              ( getfilename() != NULL ) ? getfilename() : "",
+              actionLine );
+
+    return InstanceJitter( key, jitter );
+}
+
 /*============================================================================*/
 /*  NewSignal                                                                 */
 /*!
@@ -996,6 +1855,11 @@ static void *NewSignal( void *variable )
             pSignal->lineno = getlineno();
             pSignal->pVariable = pVariable;
             pSignal->id = pVariable->hVar;
+
+            if ( triggerName == NULL )
+            {
+                triggerName = pVariable->id;
+            }
         }
     }
 
@@ -1049,9 +1913,9 @@ static int RequestCalcSignals( Signal *pSignal )
                 else
                 {
                     result = rc;
-                    fprintf( stderr,
-                             "Cannot register calc notification for %s\n",
-                             pVariable->id );
+                    LogMessage( LOGLEVEL_eWARNING,
+                                "Cannot register calc notification for %s",
+                                pVariable->id );
                 }
             }
         }
@@ -1098,9 +1962,7 @@ static int RequestModifiedSignals( Signal *pSignal )
             if ( hVar != VAR_INVALID )
             {
                 /* request a MODIIED notification */
-                rc = VAR_Notify( pActions->hVarServer,
-                                     hVar,
-                                     NOTIFY_MODIFIED );
+                rc = WatchVariable( hVar, pVariable->obj.type );
                 if ( rc == EOK )
                 {
                     /* set flag to make sure we don't request this
@@ -1110,9 +1972,10 @@ static int RequestModifiedSignals( Signal *pSignal )
                 else
                 {
                     result = rc;
-                    fprintf( stderr,
-                             "Cannot register change notification for %s\n",
-                             pVariable->id );
+                    LogMessage(
+                        LOGLEVEL_eWARNING,
+                        "Cannot register change notification for %s",
+                        pVariable->id );
                 }
             }
         }
@@ -1124,3 +1987,3650 @@ static int RequestModifiedSignals( Signal *pSignal )
     return result;
 }
 
+/*============================================================================*/
+/*  AddWatch                                                                  */
+/*!
+    Add a variable to the watched variables list
+
+    The AddWatch function adds a system variable to the list of
+    variables for which change notifications have been requested.
+    Each variable appears in the list only once.
+
+@param[in]
+    hVar
+        handle of the system variable to watch
+
+@param[in]
+    type
+        the VarServer type of the system variable
+
+@return none
+
+==============================================================================*/
+static void AddWatch( VAR_HANDLE hVar, int type )
+{
+    Watch *pWatch = pActions->pWatchList;
+
+    while ( pWatch != NULL )
+    {
+        if ( pWatch->hVar == hVar )
+        {
+            return;
+        }
+
+        pWatch = pWatch->pNext;
+    }
+
+    pWatch = (Watch *)calloc( 1, sizeof( Watch ) );
+    if ( pWatch != NULL )
+    {
+        pWatch->hVar = hVar;
+        pWatch->obj.type = type;
+        pWatch->pNext = pActions->pWatchList;
+        pActions->pWatchList = pWatch;
+    }
+}
+
+/*============================================================================*/
+/*  NoteReference                                                             */
+/*!
+    Record a system variable reference
+
+    The NoteReference function records a reference to a system variable
+    by the action currently being parsed.  References to local variables
+    and constants are ignored, as are repeated references to the
+    same system variable.
+
+@param[in,out]
+    ppRefs
+        pointer to the reference list to update
+
+@param[in]
+    variable
+        pointer to the referenced Variable
+
+@return none
+
+==============================================================================*/
+static void NoteReference( VarRef **ppRefs, void *variable )
+{
+    Variable *pVariable = (Variable *)variable;
+    VarRef *pRef;
+
+    if ( ppRefs == &pReadRefs )
+    {
+        /* the reads of each statement are also kept separately, for
+           the queued assignments */
+        NoteReference( &pStatementReads, variable );
+    }
+
+    if ( ( ppRefs != NULL ) &&
+         ( pVariable != NULL ) &&
+         ( pVariable->hVar != VAR_INVALID ) )
+    {
+        pRef = *ppRefs;
+        while ( pRef != NULL )
+        {
+            if ( pRef->hVar == pVariable->hVar )
+            {
+                return;
+            }
+
+            pRef = pRef->pNext;
+        }
+
+        pRef = (VarRef *)calloc( 1, sizeof( VarRef ) );
+        if ( pRef != NULL )
+        {
+            pRef->hVar = pVariable->hVar;
+            pRef->pNext = *ppRefs;
+            *ppRefs = pRef;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  AttachReferences                                                          */
+/*!
+    Attach the recorded variable references to an action
+
+    The AttachReferences function moves the system variable references
+    and attributes recorded while parsing the action to the action, and
+    resets them for the next action.
+
+@param[in]
+    pAction
+        pointer to the action which owns the references
+
+@return none
+
+==============================================================================*/
+static void AttachReferences( Action *pAction )
+{
+    Action *pTarget;
+    Delay *pDelay;
+
+    if ( ( aligned == true ) || ( jitter != 0 ) || ( fixedOffset == true ) )
+    {
+        yyerror( "aligned, jitter and offset apply only to timer actions" );
+        aligned = false;
+        jitter = 0;
+        offset = 0;
+        fixedOffset = false;
+    }
+
+    if ( pAction != NULL )
+    {
+        pAction->pReads = pReadRefs;
+        pAction->pWrites = pWriteRefs;
+        pAction->priority = priority;
+        pAction->deadline = deadline;
+        pAction->budget = budget;
+        pAction->logLevel = logLevel;
+        pAction->lineno = actionLine;
+        pAction->pAggregates = pAggregateList;
+        pAction->pTriggers = pTriggerList;
+        pAction->pStatics = pStaticList;
+        pAction->pBuilders = AttachStringBuilders( pAction->pStatements );
+        pAction->pAssignments = AttachAssignments( pAction->pStatements );
+        pAction->pDelays = AttachDelays( pAction->pStatements );
+        pAction->pConditions = AttachConditions( pAction->pStatements );
+        pAction->pLoops = AttachLoops( pAction->pStatements );
+        pAction->pReductions = pReductionList;
+        pAction->pGuard = pGuard;
+    }
+
+    pGuard = NULL;
+
+    /* the delayed actions share the state of the action which starts them */
+    while ( pPendingDelays != NULL )
+    {
+        pTarget = pPendingDelays;
+        pPendingDelays = pTarget->pNext;
+
+        if ( pAction != NULL )
+        {
+            pTarget->pWrites = pWriteRefs;
+            pTarget->deadline = deadline;
+            pTarget->budget = budget;
+            pTarget->logLevel = logLevel;
+            pTarget->pAggregates = pAggregateList;
+            pTarget->pStatics = pStaticList;
+            pTarget->pReductions = pReductionList;
+        }
+
+        pTarget->pBuilders = AttachStringBuilders( pTarget->pStatements );
+        pTarget->pAssignments = AttachAssignments( pTarget->pStatements );
+        pTarget->pDelays = AttachDelays( pTarget->pStatements );
+        pTarget->pConditions = AttachConditions( pTarget->pStatements );
+        pTarget->pLoops = AttachLoops( pTarget->pStatements );
+
+        pTarget->pNext = pDelayedActions;
+        pDelayedActions = pTarget;
+    }
+
+    ClearStringBuilders();
+    ClearAssignments();
+    ClearConditions();
+
+    FreeReferences( pStatementReads );
+    pStatementReads = NULL;
+
+    if ( pDelayList != NULL )
+    {
+        yyerror( "after and cancel must be top-level statements" );
+
+        while ( pDelayList != NULL )
+        {
+            pDelay = pDelayList;
+            pDelayList = pDelay->pNext;
+            free( pDelay );
+        }
+    }
+
+    if ( pLoopList != NULL )
+    {
+        yyerror( "for each loops must be top-level statements" );
+        pLoopList = NULL;
+    }
+
+    pStaticList = NULL;
+    pReductionList = NULL;
+    pSetList = NULL;
+    setTriggerName = NULL;
+    ClearLocals();
+
+    pAggregateList = NULL;
+    pTriggerList = NULL;
+    triggerName = NULL;
+
+    ClearConstants();
+    ClearChains();
+    ClearLogicals();
+    ClearShadows();
+
+    pReadRefs = NULL;
+    pWriteRefs = NULL;
+    priority = 0;
+    deadline = 0;
+    budget = 0;
+    logLevel = LOGLEVEL_eDEFAULT;
+}
+
+/*============================================================================*/
+/*  GetNumber                                                                 */
+/*!
+    Get the value of a numeric constant
+
+    The GetNumber function gets the integer value of a numeric
+    constant such as a timer interval
+
+@param[in]
+    pVariable
+        pointer to the numeric constant
+
+@retval the value of the numeric constant
+@retval 0 if the constant is not an integer
+
+==============================================================================*/
+static int GetNumber( Variable *pVariable )
+{
+    int num = 0;
+
+    if ( pVariable != NULL )
+    {
+        switch ( pVariable->obj.type )
+        {
+            case VARTYPE_UINT16:
+                num = pVariable->obj.val.ui;
+                break;
+
+            case VARTYPE_UINT32:
+                num = pVariable->obj.val.ul;
+                break;
+
+            default:
+                num = 0;
+                break;
+        }
+    }
+
+    return num;
+}
+
+/*============================================================================*/
+/*  NewCacheSpec                                                              */
+/*!
+    Create a new calc result cache specification
+
+    The NewCacheSpec function creates a cache specification which
+    is applied to an on calc action when the action is created.
+
+@param[in]
+    mode
+        the caching mode
+
+@param[in]
+    interval
+        pointer to the cache lifetime (CACHE_eTIMED only)
+
+@param[in]
+    timescale
+        time scale of the cache lifetime (CACHE_eTIMED only)
+
+@retval pointer to the cache specification
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewCacheSpec( CacheMode mode, void *interval, void *timescale )
+{
+    CacheSpec *pCacheSpec;
+
+    pCacheSpec = (CacheSpec *)calloc( 1, sizeof( CacheSpec ) );
+    if ( pCacheSpec != NULL )
+    {
+        pCacheSpec->mode = mode;
+
+        if ( mode == CACHE_eTIMED )
+        {
+            pCacheSpec->ttl = TimespanToMs( GetNumber( interval ),
+                                            (Timescale)timescale );
+            if ( pCacheSpec->ttl == 0 )
+            {
+                yyerror("Invalid cache time");
+            }
+        }
+    }
+
+    return pCacheSpec;
+}
+
+/*============================================================================*/
+/*  RequestInputSignals                                                       */
+/*!
+    Request MODIFIED notifications for the inputs of a calc action
+
+    The RequestInputSignals function requests a NOTIFY_MODIFIED
+    notification for each system variable read by the action, other
+    than the variables it calculates, so the action's cached results
+    can be invalidated when its inputs change.
+
+@param[in]
+    pAction
+        pointer to the calc action
+
+@retval EOK the notifications were successfully requested
+@retval other the last notification request error
+
+==============================================================================*/
+static int RequestInputSignals( Action *pAction )
+{
+    int result = EOK;
+    VarRef *pRef;
+    int rc;
+
+    for ( pRef = pAction->pReads; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( FindSignalVariable( pAction->pSignals, pRef->hVar ) == false )
+        {
+            rc = WatchVariable( pRef->hVar, VARTYPE_INVALID );
+            if ( rc != EOK )
+            {
+                result = rc;
+                LogMessage( LOGLEVEL_eWARNING,
+                            "Cannot register change notification for input" );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetPriority                                                               */
+/*!
+    Set the priority of the action being parsed
+
+    The SetPriority function sets the scheduling priority of the
+    action currently being parsed.  Events for higher priority
+    actions are dispatched first.
+
+@param[in]
+    number
+        pointer to the priority number (MIN_PRIORITY to MAX_PRIORITY)
+
+@return none
+
+==============================================================================*/
+static void SetPriority( void *number )
+{
+    int num = GetNumber( (Variable *)number );
+
+    if ( ( num >= MIN_PRIORITY ) && ( num <= MAX_PRIORITY ) )
+    {
+        priority = num;
+    }
+    else
+    {
+        yyerror("Invalid priority");
+    }
+}
+
+/*============================================================================*/
+/*  SetDeadline                                                               */
+/*!
+    Set the deadline of the action being parsed
+
+    The SetDeadline function sets the time by which an event for
+    the action currently being parsed should be dispatched.  Among events
+    of the same priority, the event with the earliest deadline is
+    dispatched first.
+
+@param[in]
+    interval
+        pointer to the deadline interval
+
+@param[in]
+    timescale
+        time scale of the deadline interval
+
+@return none
+
+==============================================================================*/
+static void SetDeadline( void *interval, void *timescale )
+{
+    deadline = TimespanToMs( GetNumber( (Variable *)interval ),
+                             (Timescale)timescale );
+    if ( deadline == 0 )
+    {
+        yyerror("Invalid deadline");
+    }
+}
+
+/*============================================================================*/
+/*  SetBudget                                                                 */
+/*!
+    Set the execution budget of the action being parsed
+
+    The SetBudget function sets the maximum execution time of the
+    action currently being parsed, overriding the default execution
+    budget.  Scripts which are still running when the budget
+    expires are killed.
+
+@param[in]
+    interval
+        pointer to the budget interval
+
+@param[in]
+    timescale
+        time scale of the budget interval
+
+@return none
+
+==============================================================================*/
+static void SetBudget( void *interval, void *timescale )
+{
+    budget = TimespanToMs( GetNumber( (Variable *)interval ),
+                           (Timescale)timescale );
+    if ( budget == 0 )
+    {
+        yyerror("Invalid budget");
+    }
+}
+
+/*============================================================================*/
+/*  SetLogLevel                                                               */
+/*!
+    Set the log level of the action being parsed
+
+    The SetLogLevel function overrides the default log level for
+    the action currently being parsed, so the diagnostics of a single
+    action can be enabled or silenced without changing the others.
+
+@param[in]
+    level
+        pointer to the string variable containing the log level name
+
+@return none
+
+==============================================================================*/
+static void SetLogLevel( void *level )
+{
+    Variable *pVariable = (Variable *)level;
+
+    if ( ( pVariable == NULL ) ||
+         ( pVariable->obj.val.str == NULL ) ||
+         ( ParseLogLevel( pVariable->obj.val.str, &logLevel ) != EOK ) )
+    {
+        yyerror("Invalid log level");
+    }
+}
+
+/*============================================================================*/
+/*  SetJitter                                                                 */
+/*!
+    Set the schedule jitter of the action being parsed
+
+    The SetJitter function sets the range of the per-instance offset
+    added to the firing times of the wall clock schedule of the action
+    currently being parsed.
+
+@param[in]
+    interval
+        pointer to the jitter interval
+
+@param[in]
+    timescale
+        time scale of the jitter interval
+
+@return none
+
+==============================================================================*/
+static void SetJitter( void *interval, void *timescale )
+{
+    jitter = TimespanToMs( GetNumber( (Variable *)interval ),
+                           (Timescale)timescale );
+    if ( jitter == 0 )
+    {
+        yyerror("Invalid jitter");
+    }
+}
+
+/*============================================================================*/
+/*  SetOffset                                                                 */
+/*!
+    Set the timer offset of the action being parsed
+
+    The SetOffset function sets an explicit offset of the firing times
+    of the timer of the action currently being parsed.  An every timer
+    with an explicit offset is not staggered automatically.
+
+@param[in]
+    interval
+        pointer to the offset interval
+
+@param[in]
+    timescale
+        time scale of the offset interval
+
+@return none
+
+==============================================================================*/
+static void SetOffset( void *interval, void *timescale )
+{
+    offset = TimespanToMs( GetNumber( (Variable *)interval ),
+                           (Timescale)timescale );
+    fixedOffset = true;
+}
+
+/*============================================================================*/
+/*  NewGuardOperand                                                           */
+/*!
+    Create a guard system variable operand
+
+    The NewGuardOperand function creates a guard operand for a numeric
+    system variable, and requests change notifications for the variable
+    so its cached value is kept current.
+
+@param[in]
+    variable
+        pointer to the system variable reference
+
+@retval pointer to the guard operand
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewGuardOperand( void *variable )
+{
+    Variable *pVariable = (Variable *)variable;
+    Guard *pOperand = NULL;
+
+    if ( pVariable != NULL )
+    {
+        pOperand = NewGuardInput( pVariable->hVar, pVariable->obj.type );
+        if ( pOperand == NULL )
+        {
+            yyerror( "when guards must use numeric system variables" );
+        }
+        else if ( WatchVariable( pVariable->hVar,
+                                 pVariable->obj.type ) != EOK )
+        {
+            LogMessage( LOGLEVEL_eWARNING,
+                        "Cannot register change notification for %s",
+                        pVariable->id );
+        }
+    }
+
+    return pOperand;
+}
+
+/*============================================================================*/
+/*  FindSignalVariable                                                        */
+/*!
+    Check if a signal list contains a variable
+
+@param[in]
+    pSignal
+        pointer to the first signal in the signal list
+
+@param[in]
+    hVar
+        handle of the variable to look for
+
+@retval true the variable is in the signal list
+@retval false the variable is not in the signal list
+
+==============================================================================*/
+static bool FindSignalVariable( Signal *pSignal, VAR_HANDLE hVar )
+{
+    while ( pSignal != NULL )
+    {
+        if ( pSignal->id == (int)hVar )
+        {
+            return true;
+        }
+
+        pSignal = pSignal->pNext;
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  WatchVariable                                                             */
+/*!
+    Request MODIFIED notifications for a variable
+
+    The WatchVariable function requests a NOTIFY_MODIFIED notification
+    for a system variable, and adds it to the watched variables list.
+    Notifications are only requested once per variable.
+
+@param[in]
+    hVar
+        handle of the system variable to watch
+
+@param[in]
+    type
+        the VarServer type of the system variable
+
+@retval EOK the variable is watched
+@retval other error from VAR_Notify
+
+==============================================================================*/
+static int WatchVariable( VAR_HANDLE hVar, int type )
+{
+    Watch *pWatch;
+    int result = EOK;
+
+    for ( pWatch = pActions->pWatchList;
+          pWatch != NULL;
+          pWatch = pWatch->pNext )
+    {
+        if ( pWatch->hVar == hVar )
+        {
+            /* notifications have already been requested */
+            if ( pWatch->obj.type == VARTYPE_INVALID )
+            {
+                pWatch->obj.type = type;
+            }
+
+            return EOK;
+        }
+    }
+
+    result = VAR_Notify( pActions->hVarServer, hVar, NOTIFY_MODIFIED );
+    if ( result == EOK )
+    {
+        AddWatch( hVar, type );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NewAggregateVariable                                                      */
+/*!
+    Create a new streaming aggregate expression
+
+    The NewAggregateVariable function creates a streaming aggregate over
+    a system variable, and a floating point expression node which holds
+    the aggregate value.  The engine feeds the aggregate from the
+    variable's change notifications, and updates the expression node
+    before the action runs.
+
+@param[in]
+    type
+        the type of aggregate
+
+@param[in]
+    variable
+        pointer to the system variable to aggregate
+
+@param[in]
+    interval
+        pointer to the aggregation window interval
+
+@param[in]
+    timescale
+        time scale of the aggregation window
+
+@param[in]
+    alpha
+        pointer to the smoothing factor for AGGREGATE_eEWMA
+
+@retval pointer to the expression node holding the aggregate value
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewAggregateVariable( AggregateType type,
+                                   void *variable,
+                                   void *interval,
+                                   void *timescale,
+                                   void *alpha )
+{
+    Variable *pVariable = (Variable *)variable;
+    Variable *pAlpha = (Variable *)alpha;
+    Variable *pResult = NULL;
+    Aggregate *pAggregate;
+    uint64_t window = 0;
+    double a = 0.0;
+
+    if ( ( pVariable == NULL ) || ( pVariable->hVar == VAR_INVALID ) )
+    {
+        yyerror("Aggregates require a system variable");
+        return NULL;
+    }
+
+    if ( type == AGGREGATE_eEWMA )
+    {
+        if ( pAlpha != NULL )
+        {
+            a = pAlpha->obj.val.f;
+        }
+
+        if ( ( a <= 0.0 ) || ( a > 1.0 ) )
+        {
+            yyerror("Invalid ewma smoothing factor");
+            return NULL;
+        }
+    }
+    else
+    {
+        window = TimespanToMs( GetNumber( (Variable *)interval ),
+                               (Timescale)timescale );
+        if ( window == 0 )
+        {
+            yyerror("Invalid aggregate window");
+            return NULL;
+        }
+    }
+
+    pResult = NewFloat( "0.0" );
+    pAggregate = NewAggregate( type,
+                               pVariable->hVar,
+                               pVariable->obj.type,
+                               window,
+                               a,
+                               pResult );
+    if ( pAggregate != NULL )
+    {
+        pAggregate->pNext = pAggregateList;
+        pAggregateList = pAggregate;
+
+        if ( WatchVariable( pVariable->hVar, pVariable->obj.type ) != EOK )
+        {
+            LogMessage( LOGLEVEL_eWARNING,
+                        "Cannot register change notification for %s",
+                        pVariable->id );
+        }
+    }
+
+    return pResult;
+}
+
+/*============================================================================*/
+/*  NewWildcardSignals                                                        */
+/*!
+    Create the signals for a wildcard variable pattern
+
+    The NewWildcardSignals function resolves a variable name pattern
+    against the variables in the VarServer, and creates a signal for
+    each matching variable.  A '*' in the pattern matches any sequence
+    of characters including '/', so a pattern ending in '*' selects all
+    the variables with the specified prefix.
+
+    The variables are resolved once on startup.  Variables created
+    after the script is loaded are not matched.
+
+@param[in]
+    pattern
+        pointer to the variable name pattern
+
+@retval pointer to the list of Signals that we created
+@retval NULL if no variables matched the pattern
+
+==============================================================================*/
+static void *NewWildcardSignals( char *pattern )
+{
+    Signal *pFirst = NULL;
+    Signal *pLast = NULL;
+    Signal *pSignal;
+    Variable *pVariable;
+    VarQuery query;
+    VarObject obj;
+    char prefix[MAX_NAME_LEN+1];
+    size_t len;
+    int result;
+
+    if ( pattern == NULL )
+    {
+        return NULL;
+    }
+
+    /* narrow the VarServer query to the literal prefix of the pattern */
+    len = strcspn( pattern, "*" );
+    if ( len > MAX_NAME_LEN )
+    {
+        len = MAX_NAME_LEN;
+    }
+
+    memcpy( prefix, pattern, len );
+    prefix[len] = '\0';
+
+    memset( &query, 0, sizeof( VarQuery ) );
+    query.type = QUERY_MATCH;
+    query.match = prefix;
+
+    result = VAR_GetFirst( pActions->hVarServer, &query, &obj );
+    while ( result == EOK )
+    {
+        if ( ( strncmp( query.name, prefix, len ) == 0 ) &&
+             ( fnmatch( pattern, query.name, 0 ) == 0 ) )
+        {
+            pVariable = NewIdentifier( pActions->hVarServer,
+                                       query.name,
+                                       false );
+            pSignal = NewSignal( pVariable );
+            if ( pSignal != NULL )
+            {
+                if ( pLast == NULL )
+                {
+                    pFirst = pSignal;
+                }
+                else
+                {
+                    pLast->pNext = pSignal;
+                }
+
+                pLast = pSignal;
+            }
+        }
+
+        result = VAR_GetNext( pActions->hVarServer, &query, &obj );
+    }
+
+    if ( pFirst == NULL )
+    {
+        LogMessage( LOGLEVEL_eWARNING, "No variables match %s", pattern );
+    }
+
+    return (void *)pFirst;
+}
+
+/*============================================================================*/
+/*  NewTriggerVariable                                                        */
+/*!
+    Create a reference to the triggering variable
+
+    The NewTriggerVariable function creates an expression node which
+    refers to the variable which triggered the action currently being
+    parsed.  The node is bound to the first signal of the action, and
+    is re-bound by the engine to the triggering variable each time
+    the action runs, so a single action can serve all the variables
+    in its trigger list.
+
+@retval pointer to the expression node for the triggering variable
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewTriggerVariable( void )
+{
+    Variable *pVariable = NULL;
+    Trigger *pTrigger;
+
+    if ( triggerName == NULL )
+    {
+        yyerror("trigger requires a change or calc trigger list");
+        return NULL;
+    }
+
+    pVariable = NewIdentifier( pActions->hVarServer, triggerName, false );
+    if ( pVariable != NULL )
+    {
+        pTrigger = (Trigger *)calloc( 1, sizeof( Trigger ) );
+        if ( pTrigger != NULL )
+        {
+            pTrigger->pVariable = pVariable;
+            pTrigger->pNext = pTriggerList;
+            pTriggerList = pTrigger;
+        }
+    }
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  NoteConstant                                                              */
+/*!
+    Record a numeric constant
+
+    The NoteConstant function records a numeric constant expression node
+    so it can be recognized as a candidate for constant folding.
+
+@param[in]
+    variable
+        pointer to the numeric constant expression node
+
+@return none
+
+==============================================================================*/
+static void NoteConstant( void *variable )
+{
+    Constant *pConstant;
+
+    if ( variable != NULL )
+    {
+        pConstant = (Constant *)calloc( 1, sizeof( Constant ) );
+        if ( pConstant != NULL )
+        {
+            pConstant->pVariable = (Variable *)variable;
+            pConstant->pNext = pConstants;
+            pConstants = pConstant;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TakeConstant                                                              */
+/*!
+    Check if an expression node is a numeric constant
+
+    The TakeConstant function checks if an expression node is a
+    numeric constant, and removes it from the constants list since it
+    is being consumed by an enclosing expression.
+
+@param[in]
+    pVariable
+        pointer to the expression node to check
+
+@retval true the expression node is a numeric constant
+@retval false the expression node is not a numeric constant
+
+==============================================================================*/
+static bool TakeConstant( Variable *pVariable )
+{
+    Constant **ppConstant = &pConstants;
+    Constant *pConstant;
+
+    while ( *ppConstant != NULL )
+    {
+        pConstant = *ppConstant;
+        if ( pConstant->pVariable == pVariable )
+        {
+            *ppConstant = pConstant->pNext;
+            free( pConstant );
+            return true;
+        }
+
+        ppConstant = &pConstant->pNext;
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  ClearConstants                                                            */
+/*!
+    Clear the numeric constants list
+
+@return none
+
+==============================================================================*/
+static void ClearConstants( void )
+{
+    Constant *pConstant;
+
+    while ( pConstants != NULL )
+    {
+        pConstant = pConstants;
+        pConstants = pConstant->pNext;
+        free( pConstant );
+    }
+}
+
+/*============================================================================*/
+/*  FoldConstants                                                             */
+/*!
+    Create a binary expression, folding constant operands
+
+    The FoldConstants function evaluates a binary arithmetic or bitwise
+    expression at parse time if both of its operands are numeric
+    constants of the same type, and the result can be represented in
+    that type.  Otherwise, the expression node is created to be evaluated
+    at run time.  This removes the constant arithmetic introduced by
+    template parameters from the compiled actions.
+
+@param[in]
+    type
+        the expression type (VA_ADD, VA_MUL etc)
+
+@param[in]
+    left
+        pointer to the left operand
+
+@param[in]
+    right
+        pointer to the right operand
+
+@retval pointer to the folded constant or the new expression node
+
+==============================================================================*/
+static void *FoldConstants( int type, void *left, void *right )
+{
+    Variable *pLeft = (Variable *)left;
+    Variable *pRight = (Variable *)right;
+    Variable *pResult = NULL;
+    bool leftConstant;
+    bool rightConstant;
+    VarObject obj;
+    float f;
+
+    leftConstant = TakeConstant( pLeft );
+    rightConstant = TakeConstant( pRight );
+
+    if ( ( leftConstant == true ) &&
+         ( rightConstant == true ) &&
+         ( pLeft->obj.type == pRight->obj.type ) )
+    {
+        memset( &obj, 0, sizeof( VarObject ) );
+
+        if ( pLeft->obj.type == VARTYPE_FLOAT )
+        {
+            if ( FoldFloat( type,
+                            pLeft->obj.val.f,
+                            pRight->obj.val.f,
+                            &f ) == true )
+            {
+                pResult = NewFloat( "0.0" );
+                if ( pResult != NULL )
+                {
+                    pResult->obj.val.f = f;
+                }
+            }
+        }
+        else if ( FoldInteger( type, &pLeft->obj, &pRight->obj, &obj ) )
+        {
+            pResult = NewNumber( "0" );
+            if ( pResult != NULL )
+            {
+                pResult->obj.type = obj.type;
+                pResult->obj.val = obj.val;
+            }
+        }
+    }
+
+    if ( pResult != NULL )
+    {
+        NoteConstant( pResult );
+    }
+    else
+    {
+        pResult = CreateVariable( type, left, right );
+    }
+
+    return pResult;
+}
+
+/*============================================================================*/
+/*  FoldInteger                                                               */
+/*!
+    Evaluate a constant integer expression
+
+@param[in]
+    type
+        the expression type (VA_ADD, VA_MUL etc)
+
+@param[in]
+    pLeft
+        pointer to the left operand value
+
+@param[in]
+    pRight
+        pointer to the right operand value (same type as the left)
+
+@param[out]
+    pResult
+        pointer to the location to store the result
+
+@retval true the expression was evaluated
+@retval false the expression cannot be evaluated at parse time
+
+==============================================================================*/
+static bool FoldInteger( int type, VarObject *pLeft, VarObject *pRight,
+                         VarObject *pResult )
+{
+    int64_t a;
+    int64_t b;
+    int64_t r;
+    int64_t lo;
+    int64_t hi;
+    int bits;
+
+    switch ( pLeft->type )
+    {
+        case VARTYPE_UINT16:
+            a = pLeft->val.ui;
+            b = pRight->val.ui;
+            lo = 0;
+            hi = UINT16_MAX;
+            bits = 16;
+            break;
+
+        case VARTYPE_INT16:
+            a = pLeft->val.i;
+            b = pRight->val.i;
+            lo = INT16_MIN;
+            hi = INT16_MAX;
+            bits = 16;
+            break;
+
+        case VARTYPE_UINT32:
+            a = pLeft->val.ul;
+            b = pRight->val.ul;
+            lo = 0;
+            hi = UINT32_MAX;
+            bits = 32;
+            break;
+
+        case VARTYPE_INT32:
+            a = pLeft->val.l;
+            b = pRight->val.l;
+            lo = INT32_MIN;
+            hi = INT32_MAX;
+            bits = 32;
+            break;
+
+        case VARTYPE_UINT64:
+        case VARTYPE_INT64:
+            return FoldWide( type, pLeft, pRight, pResult );
+
+        default:
+            return false;
+    }
+
+    switch ( type )
+    {
+        case VA_ADD:    r = a + b; break;
+        case VA_SUB:    r = a - b; break;
+        case VA_BAND:   r = a & b; break;
+        case VA_BOR:    r = a | b; break;
+        case VA_XOR:    r = a ^ b; break;
+
+        case VA_MUL:
+            if ( ( (double)a * (double)b < (double)lo ) ||
+                 ( (double)a * (double)b > (double)hi ) )
+            {
+                return false;
+            }
+            r = a * b;
+            break;
+
+        case VA_DIV:
+            if ( b == 0 )
+            {
+                return false;
+            }
+            r = a / b;
+            break;
+
+        case VA_LSHIFT:
+            if ( ( a < 0 ) || ( b < 0 ) || ( b >= bits ) )
+            {
+                return false;
+            }
+            if ( a > ( hi >> b ) )
+            {
+                return false;
+            }
+            r = a << b;
+            break;
+
+        case VA_RSHIFT:
+            if ( ( a < 0 ) || ( b < 0 ) || ( b >= bits ) )
+            {
+                return false;
+            }
+            r = a >> b;
+            break;
+
+        default:
+            return false;
+    }
+
+    if ( ( r < lo ) || ( r > hi ) )
+    {
+        /* leave overflow behavior to the run time */
+        return false;
+    }
+
+    pResult->type = pLeft->type;
+    switch ( pLeft->type )
+    {
+        case VARTYPE_UINT16:    pResult->val.ui = (uint16_t)r; break;
+        case VARTYPE_INT16:     pResult->val.i = (int16_t)r; break;
+        case VARTYPE_UINT32:    pResult->val.ul = (uint32_t)r; break;
+        default:                pResult->val.l = (int32_t)r; break;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  FoldFloat                                                                 */
+/*!
+    Evaluate a constant floating point expression
+
+@param[in]
+    type
+        the expression type (VA_ADD, VA_MUL etc)
+
+@param[in]
+    left
+        the left operand value
+
+@param[in]
+    right
+        the right operand value
+
+@param[out]
+    pResult
+        pointer to the location to store the result
+
+@retval true the expression was evaluated
+@retval false the expression cannot be evaluated at parse time
+
+==============================================================================*/
+static bool FoldFloat( int type, float left, float right, float *pResult )
+{
+    switch ( type )
+    {
+        case VA_ADD:    *pResult = left + right; break;
+        case VA_SUB:    *pResult = left - right; break;
+        case VA_MUL:    *pResult = left * right; break;
+
+        case VA_DIV:
+            if ( right == 0.0f )
+            {
+                return false;
+            }
+            *pResult = left / right;
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  NewStaticDeclaration                                                      */
+/*!
+    Declare a static local variable
+
+    The NewStaticDeclaration function declares a numeric local variable
+    whose value is kept by the engine between executions of the action,
+    rather than being recalculated or stored in a system variable.
+    Static variables start at zero, or at the value of their checkpoint
+    variable, and can be read before they are assigned.
+
+    If a checkpoint variable is specified, the engine periodically
+    writes the static variable's value to it, and restores the value from
+    it on startup.
+
+@param[in]
+    type
+        the local variable type (VA_FLOAT, VA_INT, VA_SHORT or
+        one of the TYPE_xxx script types)
+
+@param[in]
+    id
+        pointer to the declared identifier
+
+@param[in]
+    checkpoint
+        pointer to the checkpoint system variable, or NULL
+
+@retval pointer to the local variable declaration
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewStaticDeclaration( void *type, void *id, void *checkpoint )
+{
+    Variable *pDeclaration;
+    Variable *pVariable = (Variable *)id;
+    Variable *pCheckpoint = (Variable *)checkpoint;
+    StaticVar *pStatic;
+
+    if ( (uintptr_t)type == VA_STRING )
+    {
+        yyerror("Static string variables are not supported");
+        return NULL;
+    }
+
+    if ( ( pCheckpoint != NULL ) && ( pCheckpoint->hVar == VAR_INVALID ) )
+    {
+        yyerror("Invalid checkpoint variable");
+        return NULL;
+    }
+
+    pDeclaration = NewTypedDeclaration( type, id );
+    if ( pVariable != NULL )
+    {
+        /* static variables always have a value */
+        pVariable->assigned = true;
+
+        pStatic = (StaticVar *)calloc( 1, sizeof( StaticVar ) );
+        if ( pStatic != NULL )
+        {
+            pStatic->pVariable = pVariable;
+            pStatic->value = pVariable->obj;
+            pStatic->hCheckpoint = ( pCheckpoint != NULL ) ? pCheckpoint->hVar
+                                                           : VAR_INVALID;
+            pStatic->pNext = pStaticList;
+            pStaticList = pStatic;
+        }
+    }
+
+    return pDeclaration;
+}
+
+/*============================================================================*/
+/*  NoteChain                                                                 */
+/*!
+    Record the segments of a string expression
+
+    The NoteChain function records how a string expression can be
+    built from literal text and formatted variable values, so
+    assignments of the expression can be replaced by a string builder.
+
+@param[in]
+    variable
+        pointer to the string expression node
+
+@param[in]
+    pSegments
+        pointer to the segments which build the expression.  Expressions
+        which cannot be built from segments are not recorded.
+
+@return none
+
+==============================================================================*/
+static void NoteChain( void *variable, Segment *pSegments )
+{
+    Chain *pChain;
+
+    if ( ( variable != NULL ) && ( pSegments != NULL ) )
+    {
+        pChain = (Chain *)calloc( 1, sizeof( Chain ) );
+        if ( pChain != NULL )
+        {
+            pChain->pVariable = (Variable *)variable;
+            pChain->pSegments = pSegments;
+            pChain->pNext = pChains;
+            pChains = pChain;
+        }
+        else
+        {
+            FreeSegments( pSegments );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  TakeChain                                                                 */
+/*!
+    Take the segments of a string expression
+
+    The TakeChain function gets the segments recorded for a string
+    expression, and removes them from the chains list since the
+    expression is being consumed by an enclosing expression.
+
+@param[in]
+    variable
+        pointer to the string expression node
+
+@retval pointer to the segments of the expression
+@retval NULL the expression cannot be built from segments
+
+==============================================================================*/
+static Segment *TakeChain( void *variable )
+{
+    Chain **ppChain = &pChains;
+    Chain *pChain;
+    Segment *pSegments;
+
+    while ( *ppChain != NULL )
+    {
+        pChain = *ppChain;
+        if ( pChain->pVariable == (Variable *)variable )
+        {
+            *ppChain = pChain->pNext;
+            pSegments = pChain->pSegments;
+            free( pChain );
+            return pSegments;
+        }
+
+        ppChain = &pChain->pNext;
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  ClearChains                                                               */
+/*!
+    Clear the string concatenation chains list
+
+@return none
+
+==============================================================================*/
+static void ClearChains( void )
+{
+    Chain *pChain;
+
+    while ( pChains != NULL )
+    {
+        pChain = pChains;
+        pChains = pChain->pNext;
+        FreeSegments( pChain->pSegments );
+        free( pChain );
+    }
+}
+
+/*============================================================================*/
+/*  Concatenate                                                               */
+/*!
+    Create an addition or string concatenation expression
+
+    The Concatenate function creates an addition expression.  If both
+    operands are string literals, they are concatenated into a single
+    string literal.  If both operands can be built from segments,
+    the segments of the result are recorded.
+
+@param[in]
+    left
+        pointer to the left operand
+
+@param[in]
+    right
+        pointer to the right operand
+
+@retval pointer to the new expression node
+
+==============================================================================*/
+static void *Concatenate( void *left, void *right )
+{
+    Segment *pLeft = TakeChain( left );
+    Segment *pRight = TakeChain( right );
+    Segment *pSegments;
+    Variable *pVariable;
+
+    if ( ( pLeft == NULL ) || ( pRight == NULL ) )
+    {
+        FreeSegments( pLeft );
+        FreeSegments( pRight );
+        return FoldConstants( VA_ADD, left, right );
+    }
+
+    pSegments = MergeSegments( pLeft, pRight );
+    if ( ( pSegments->type == SEGMENT_eLITERAL ) &&
+         ( pSegments->pNext == NULL ) )
+    {
+        /* fold the concatenated string literals */
+        pVariable = NewString( pSegments->text );
+    }
+    else
+    {
+        pVariable = CreateVariable( VA_ADD, left, right );
+    }
+
+    NoteChain( pVariable, pSegments );
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  FormatCast                                                                */
+/*!
+    Create a formatted string conversion expression
+
+    The FormatCast function creates a string conversion expression.
+    If the format can be used by a string builder, the formatted field
+    segment of the conversion is recorded.  Otherwise the conversion is
+    left to the expression library, which prevents any concatenation
+    containing it from being replaced by a string builder.
+
+@param[in]
+    format
+        pointer to the format string expression
+
+@param[in]
+    variable
+        pointer to the variable to convert
+
+@retval pointer to the new expression node
+
+==============================================================================*/
+static void *FormatCast( void *format, void *variable )
+{
+    Segment *pFormat = TakeChain( format );
+    Segment *pField = NULL;
+    Variable *pVariable;
+
+    if ( ( pFormat != NULL ) &&
+         ( pFormat->type == SEGMENT_eLITERAL ) &&
+         ( pFormat->pNext == NULL ) )
+    {
+        pField = NewFieldSegment( (Variable *)variable, pFormat->text );
+    }
+
+    pVariable = CreateVariable( VA_TOSTRING, variable, format );
+    NoteChain( pVariable, pField );
+    FreeSegments( pFormat );
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  NoteStringAssignment                                                      */
+/*!
+    Check for a string assignment which can use a string builder
+
+    The NoteStringAssignment function creates a string builder for the
+    assignment of a string concatenation to a string system variable.
+    The string builder replaces the assignment statement if the
+    statement is at the top level of an action.
+
+@param[in]
+    assignment
+        pointer to the assignment expression node
+
+@param[in]
+    variable
+        pointer to the assigned variable
+
+@param[in]
+    expression
+        pointer to the assigned expression
+
+@return none
+
+==============================================================================*/
+static void NoteStringAssignment( void *assignment,
+                                  void *variable,
+                                  void *expression )
+{
+    Variable *pVariable = (Variable *)variable;
+    Segment *pSegments = TakeChain( expression );
+    StringBuilder *pBuilder;
+
+    if ( ( pSegments != NULL ) &&
+         ( pVariable != NULL ) &&
+         ( pVariable->hVar != VAR_INVALID ) &&
+         ( pVariable->obj.type == VARTYPE_STR ) &&
+         ( ( pSegments->pNext != NULL ) ||
+           ( ( pSegments->type == SEGMENT_eFIELD ) &&
+             ( pSegments->conversion != 's' ) ) ) )
+    {
+        pBuilder = NewStringBuilder( pVariable->hVar, pSegments );
+        if ( pBuilder != NULL )
+        {
+            pBuilder->pAssignment = (Variable *)assignment;
+            pBuilder->pNext = pBuilderList;
+            pBuilderList = pBuilder;
+        }
+    }
+    else
+    {
+        FreeSegments( pSegments );
+    }
+}
+
+/*============================================================================*/
+/*  NoteAssignment                                                            */
+/*!
+    Check for an assignment which can use the write queue
+
+    The NoteAssignment function prepares the assignment of an expression
+    to a numeric system variable to be written through the write queue
+    when asynchronous writes are enabled.  The expression is assigned to
+    a hidden local variable of the widest type of the same kind, and the
+    engine queues the write of its value.  The queued assignment
+    replaces the assignment statement if the statement is at the top
+    level of an action.
+
+@param[in]
+    assignment
+        pointer to the assignment expression node
+
+@param[in]
+    variable
+        pointer to the assigned variable
+
+@param[in]
+    expression
+        pointer to the assigned expression
+
+@return none
+
+==============================================================================*/
+static void NoteAssignment( void *assignment,
+                            void *variable,
+                            void *expression )
+{
+    static unsigned int count = 0;
+    Variable *pVariable = (Variable *)variable;
+    Variable *pLocal;
+    QueuedAssignment *pAssignment;
+    uintptr_t type;
+    char name[32];
+
+    if ( ( pActions == NULL ) ||
+         ( pActions->asyncWrites == false ) ||
+         ( pVariable == NULL ) ||
+         ( pVariable->hVar == VAR_INVALID ) ||
+         ( pVariable->obj.type == VARTYPE_INVALID ) ||
+         ( pVariable->obj.type == VARTYPE_STR ) ||
+         ( pVariable->obj.type == VARTYPE_BLOB ) )
+    {
+        return;
+    }
+
+    switch ( pVariable->obj.type )
+    {
+        case VARTYPE_FLOAT:     type = VA_FLOAT; break;
+        case VARTYPE_UINT64:    type = TYPE_UINT64; break;
+        default:                type = TYPE_INT64; break;
+    }
+
+    /* the name is not a valid identifier, so it cannot clash with the
+       script's own local variables */
+    snprintf( name, sizeof( name ), "assign.%u", ++count );
+    pLocal = NewIdentifier( pActions->hVarServer, name, true );
+    (void)NewTypedDeclaration( (void *)type, pLocal );
+
+    pAssignment = (QueuedAssignment *)calloc( 1, sizeof( QueuedAssignment ) );
+    if ( ( pLocal == NULL ) || ( pAssignment == NULL ) )
+    {
+        free( pAssignment );
+        return;
+    }
+
+    pAssignment->pEvaluate = (Statement *)calloc( 1, sizeof( Statement ) );
+    if ( pAssignment->pEvaluate == NULL )
+    {
+        free( pAssignment );
+        return;
+    }
+
+    pLocal->lvalue = true;
+    pLocal->assigned = true;
+    pAssignment->pEvaluate->pVariable = CreateVariable( VA_ASSIGN,
+                                                        pLocal,
+                                                        expression );
+    pAssignment->pAssignment = (Variable *)assignment;
+    pAssignment->pLocal = pLocal;
+    pAssignment->hTarget = pVariable->hVar;
+    pAssignment->type = pVariable->obj.type;
+
+    /* keep the reads of the expression, so the engine only waits for
+       the queued writes the expression depends on */
+    pAssignment->pReads = pStatementReads;
+    pStatementReads = NULL;
+
+    pAssignment->pNext = pAssignmentList;
+    pAssignmentList = pAssignment;
+}
+
+/*============================================================================*/
+/*  NoteStatement                                                             */
+/*!
+    Associate a statement with its string builder or queued assignment
+
+    The NoteStatement function associates a new expression statement
+    with the string builder or queued assignment created for its
+    expression, and starts recording the reads of the next statement.
+
+@param[in]
+    pStatement
+        pointer to the new statement
+
+@return none
+
+==============================================================================*/
+static void NoteStatement( Statement *pStatement )
+{
+    StringBuilder *pBuilder;
+    QueuedAssignment *pAssignment;
+
+    for ( pBuilder = pBuilderList;
+          pBuilder != NULL;
+          pBuilder = pBuilder->pNext )
+    {
+        if ( pBuilder->pAssignment == pStatement->pVariable )
+        {
+            pBuilder->pStatement = pStatement;
+            break;
+        }
+    }
+
+    for ( pAssignment = pAssignmentList;
+          pAssignment != NULL;
+          pAssignment = pAssignment->pNext )
+    {
+        if ( pAssignment->pAssignment == pStatement->pVariable )
+        {
+            pAssignment->pStatement = pStatement;
+            break;
+        }
+    }
+
+    FreeReferences( pStatementReads );
+    pStatementReads = NULL;
+}
+
+/*============================================================================*/
+/*  AttachStringBuilders                                                      */
+/*!
+    Get the string builders for an action's statements
+
+    The AttachStringBuilders function orders the string builders of the
+    action currently being parsed by the position of their statements
+    in the action's statement list.  String builders for statements
+    which are not at the top level of the action are left for
+    ClearStringBuilders to discard.
+
+@param[in]
+    pStatements
+        pointer to the action's statement list
+
+@retval pointer to the ordered string builders of the action
+@retval NULL the action has no string builders
+
+==============================================================================*/
+static StringBuilder *AttachStringBuilders( Statement *pStatements )
+{
+    StringBuilder *pFirst = NULL;
+    StringBuilder *pLast = NULL;
+    StringBuilder **ppBuilder;
+    StringBuilder *pBuilder;
+    Statement *pStatement;
+
+    for ( pStatement = pStatements;
+          pStatement != NULL;
+          pStatement = pStatement->pNext )
+    {
+        ppBuilder = &pBuilderList;
+        while ( *ppBuilder != NULL )
+        {
+            pBuilder = *ppBuilder;
+            if ( pBuilder->pStatement == pStatement )
+            {
+                *ppBuilder = pBuilder->pNext;
+                pBuilder->pNext = NULL;
+
+                if ( pLast == NULL )
+                {
+                    pFirst = pBuilder;
+                }
+                else
+                {
+                    pLast->pNext = pBuilder;
+                }
+
+                pLast = pBuilder;
+                break;
+            }
+
+            ppBuilder = &pBuilder->pNext;
+        }
+    }
+
+    return pFirst;
+}
+
+/*============================================================================*/
+/*  ClearStringBuilders                                                       */
+/*!
+    Discard the unused string builders
+
+    The ClearStringBuilders function discards the string builders of
+    the action currently being parsed which were not attached to a
+    top-level statement.
+
+==============================================================================*/
+static void ClearStringBuilders( void )
+{
+    StringBuilder *pBuilder;
+
+    while ( pBuilderList != NULL )
+    {
+        pBuilder = pBuilderList;
+        pBuilderList = pBuilder->pNext;
+        FreeStringBuilder( pBuilder );
+    }
+}
+
+/*============================================================================*/
+/*  AttachAssignments                                                         */
+/*!
+    Get the queued assignments of a statement list
+
+    The AttachAssignments function removes the queued assignments of the
+    given statement list from those of the action currently being
+    parsed, and returns them in statement order.  Queued assignments of
+    statements which are not at the top level are left for
+    ClearAssignments to discard.
+
+@param[in]
+    pStatements
+        pointer to the statement list
+
+@retval pointer to the ordered queued assignments of the statement list
+@retval NULL the statement list has no queued assignments
+
+==============================================================================*/
+static QueuedAssignment *AttachAssignments( Statement *pStatements )
+{
+    QueuedAssignment *pFirst = NULL;
+    QueuedAssignment *pLast = NULL;
+    QueuedAssignment **ppAssignment;
+    QueuedAssignment *pAssignment;
+    Statement *pStatement;
+
+    for ( pStatement = pStatements;
+          pStatement != NULL;
+          pStatement = pStatement->pNext )
+    {
+        ppAssignment = &pAssignmentList;
+        while ( *ppAssignment != NULL )
+        {
+            pAssignment = *ppAssignment;
+            if ( pAssignment->pStatement == pStatement )
+            {
+                *ppAssignment = pAssignment->pNext;
+                pAssignment->pNext = NULL;
+
+                if ( pLast == NULL )
+                {
+                    pFirst = pAssignment;
+                }
+                else
+                {
+                    pLast->pNext = pAssignment;
+                }
+
+                pLast = pAssignment;
+                break;
+            }
+
+            ppAssignment = &pAssignment->pNext;
+        }
+    }
+
+    return pFirst;
+}
+
+/*============================================================================*/
+/*  ClearAssignments                                                          */
+/*!
+    Discard the unused queued assignments
+
+    The ClearAssignments function discards the queued assignments of
+    the action currently being parsed which were not attached to a
+    top-level statement.  Their statements are evaluated by the
+    expression library as before.
+
+==============================================================================*/
+static void ClearAssignments( void )
+{
+    QueuedAssignment *pAssignment;
+
+    while ( pAssignmentList != NULL )
+    {
+        pAssignment = pAssignmentList;
+        pAssignmentList = pAssignment->pNext;
+        FreeReferences( pAssignment->pReads );
+        free( pAssignment->pEvaluate );
+        free( pAssignment );
+    }
+}
+
+/*============================================================================*/
+/*  FreeReferences                                                            */
+/*!
+    Free a list of system variable references
+
+@param[in]
+    pRefs
+        pointer to the references to free
+
+@return none
+
+==============================================================================*/
+static void FreeReferences( VarRef *pRefs )
+{
+    VarRef *pRef;
+
+    while ( pRefs != NULL )
+    {
+        pRef = pRefs;
+        pRefs = pRef->pNext;
+        free( pRef );
+    }
+}
+
+/*============================================================================*/
+/*  NewDelay                                                                  */
+/*!
+    Create an after or cancel statement
+
+    The NewDelay function creates the statement for an after block
+    or a cancel statement in the action currently being parsed.
+
+    An after block is moved into a new delayed action which is run
+    by a one-shot timer.  The statement which replaces the block in
+    the action's statement list (re)starts the timer.  A cancel
+    statement stops the timers of all the action's after blocks.
+
+@param[in]
+    interval
+        pointer to the delay interval, or NULL for a cancel statement
+
+@param[in]
+    timescale
+        time scale of the delay interval
+
+@param[in]
+    statements
+        pointer to the statements of the after block
+
+@retval pointer to the Statement that we created
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewDelay( void *interval, void *timescale, void *statements )
+{
+    Statement *pStatement;
+    Delay *pDelay;
+    Delay **ppDelay;
+    Action *pTarget = NULL;
+    uint64_t ms = 0;
+
+    if ( interval != NULL )
+    {
+        ms = TimespanToMs( GetNumber( (Variable *)interval ),
+                           (Timescale)timescale );
+        if ( ms == 0 )
+        {
+            yyerror( "Invalid delay" );
+            return NULL;
+        }
+
+        pTarget = (Action *)calloc( 1, sizeof( Action ) );
+        if ( pTarget == NULL )
+        {
+            return NULL;
+        }
+
+        pTarget->pStatements = (Statement *)statements;
+        pTarget->signal = TIMER_NOTIFICATION;
+        pTarget->priority = priority;
+        pTarget->lineno = getlineno() + 1;
+        pTarget->timerID = CreateOneShot();
+        if ( pTarget->timerID <= 0 )
+        {
+            yyerror( "Failed to create timer" );
+        }
+
+        pTarget->pNext = pPendingDelays;
+        pPendingDelays = pTarget;
+    }
+
+    pStatement = (Statement *)calloc( 1, sizeof( Statement ) );
+    pDelay = (Delay *)calloc( 1, sizeof( Delay ) );
+    if ( ( pStatement == NULL ) || ( pDelay == NULL ) )
+    {
+        free( pStatement );
+        free( pDelay );
+        return NULL;
+    }
+
+    pDelay->pStatement = pStatement;
+    pDelay->pTarget = pTarget;
+    pDelay->ms = ms;
+
+    /* keep the delays in source order */
+    ppDelay = &pDelayList;
+    while ( *ppDelay != NULL )
+    {
+        ppDelay = &(*ppDelay)->pNext;
+    }
+
+    *ppDelay = pDelay;
+
+    return pStatement;
+}
+
+/*============================================================================*/
+/*  AttachDelays                                                              */
+/*!
+    Get the after and cancel statements of a statement list
+
+    The AttachDelays function removes the delays of the given statement
+    list from the delays of the action currently being parsed, and
+    returns them in statement order.  Delays nested inside other
+    statements are left in the list.
+
+@param[in]
+    pStatements
+        pointer to the statement list
+
+@retval pointer to the ordered delays of the statement list
+@retval NULL the statement list has no delays
+
+==============================================================================*/
+static Delay *AttachDelays( Statement *pStatements )
+{
+    Delay *pFirst = NULL;
+    Delay *pLast = NULL;
+    Delay **ppDelay;
+    Delay *pDelay;
+    Statement *pStatement;
+
+    for ( pStatement = pStatements;
+          pStatement != NULL;
+          pStatement = pStatement->pNext )
+    {
+        ppDelay = &pDelayList;
+        while ( *ppDelay != NULL )
+        {
+            pDelay = *ppDelay;
+            if ( pDelay->pStatement == pStatement )
+            {
+                *ppDelay = pDelay->pNext;
+                pDelay->pNext = NULL;
+
+                if ( pLast == NULL )
+                {
+                    pFirst = pDelay;
+                }
+                else
+                {
+                    pLast->pNext = pDelay;
+                }
+
+                pLast = pDelay;
+                break;
+            }
+
+            ppDelay = &pDelay->pNext;
+        }
+    }
+
+    return pFirst;
+}
+
+/*============================================================================*/
+/*  AttachDelayedActions                                                      */
+/*!
+    Add the delayed actions to the action list
+
+    The AttachDelayedActions function appends the delayed actions
+    created by the after blocks to the end of the action list, so
+    they are dispatched by their one-shot timers.
+
+@param[in]
+    pActionList
+        pointer to the action list
+
+==============================================================================*/
+static void AttachDelayedActions( Action *pActionList )
+{
+    Action *pAction = pActionList;
+
+    if ( pAction != NULL )
+    {
+        while ( pAction->pNext != NULL )
+        {
+            pAction = pAction->pNext;
+        }
+
+        pAction->pNext = pDelayedActions;
+        pDelayedActions = NULL;
+    }
+}
+
+/*============================================================================*/
+/*  AppendList                                                                */
+/*!
+    Append items to a list being built by a left recursive rule
+
+    The AppendList function appends a chain of items to a list being
+    built by a left recursive grammar rule, in constant time.  Lists
+    under construction are kept circular and are referenced by their
+    last item, whose link points to the first item, so the end of the
+    list is always at hand.  The list is closed with CloseList once all
+    of its items have been parsed.
+
+    Left recursive rules keep the parser stack depth constant however
+    long the list is, whereas right recursive rules push every item
+    onto the stack before the list can be reduced.
+
+@param[in]
+    tail
+        pointer to the last item of the circular list, or NULL
+        if the list is empty
+
+@param[in]
+    items
+        pointer to the NULL terminated chain of items to append,
+        or NULL if there is nothing to append
+
+@param[in]
+    link
+        offset of the link to the next item within an item
+
+@retval pointer to the last item of the circular list
+
+==============================================================================*/
+static void *AppendList( void *tail, void *items, size_t link )
+{
+    void *last = items;
+
+    if ( items == NULL )
+    {
+        return tail;
+    }
+
+    while ( NEXT( last, link ) != NULL )
+    {
+        last = NEXT( last, link );
+    }
+
+    if ( tail != NULL )
+    {
+        NEXT( last, link ) = NEXT( tail, link );
+        NEXT( tail, link ) = items;
+    }
+    else
+    {
+        NEXT( last, link ) = items;
+    }
+
+    return last;
+}
+
+/*============================================================================*/
+/*  CloseList                                                                 */
+/*!
+    Close a list built by a left recursive rule
+
+    The CloseList function converts a circular list built by AppendList
+    into a NULL terminated list.
+
+@param[in]
+    tail
+        pointer to the last item of the circular list, or NULL
+        if the list is empty
+
+@param[in]
+    link
+        offset of the link to the next item within an item
+
+@retval pointer to the first item of the list
+@retval NULL the list is empty
+
+==============================================================================*/
+static void *CloseList( void *tail, size_t link )
+{
+    void *head = NULL;
+
+    if ( tail != NULL )
+    {
+        head = NEXT( tail, link );
+        NEXT( tail, link ) = NULL;
+    }
+
+    return head;
+}
+
+/*============================================================================*/
+/*  NewLogical                                                                */
+/*!
+    Create a logical && or || expression
+
+    The NewLogical function creates a logical expression node and
+    records its operands, so an if statement using it as its condition
+    can be lowered into short-circuit if statements.
+
+@param[in]
+    type
+        logical operation (VA_AND or VA_OR)
+
+@param[in]
+    left
+        pointer to the left operand
+
+@param[in]
+    right
+        pointer to the right operand
+
+@retval pointer to the logical expression node
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewLogical( int type, void *left, void *right )
+{
+    Variable *pVariable;
+    Logical *pLogical;
+
+    pVariable = CreateVariable( type, left, right );
+    if ( pVariable != NULL )
+    {
+        pLogical = (Logical *)calloc( 1, sizeof( Logical ) );
+        if ( pLogical != NULL )
+        {
+            pLogical->pVariable = pVariable;
+            pLogical->type = type;
+            pLogical->pLeft = (Variable *)left;
+            pLogical->pRight = (Variable *)right;
+            pLogical->pNext = pLogicals;
+            pLogicals = pLogical;
+        }
+    }
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  FindLogical                                                               */
+/*!
+    Find the record of a logical expression
+
+@param[in]
+    pVariable
+        pointer to the expression node to look up
+
+@retval pointer to the logical expression record
+@retval NULL the expression node is not a logical && or || expression
+
+==============================================================================*/
+static Logical *FindLogical( Variable *pVariable )
+{
+    Logical *pLogical;
+
+    for ( pLogical = pLogicals; pLogical != NULL; pLogical = pLogical->pNext )
+    {
+        if ( pLogical->pVariable == pVariable )
+        {
+            break;
+        }
+    }
+
+    return ( pVariable != NULL ) ? pLogical : NULL;
+}
+
+/*============================================================================*/
+/*  ClearLogicals                                                             */
+/*!
+    Clear the logical expression list
+
+@return none
+
+==============================================================================*/
+static void ClearLogicals( void )
+{
+    Logical *pLogical;
+
+    while ( pLogicals != NULL )
+    {
+        pLogical = pLogicals;
+        pLogicals = pLogical->pNext;
+        free( pLogical );
+    }
+}
+
+/*============================================================================*/
+/*  NewSelection                                                              */
+/*!
+    Create an if statement expression
+
+    The NewSelection function creates the expression of an if statement.
+    A condition built from && and || operators is lowered into nested
+    if expressions, so an operand which decides the result stops the
+    evaluation of the remaining operands.  When profiling is enabled,
+    a flat chain of && or || operands is recorded as a Condition so
+    its operands can be reordered at run time.
+
+@param[in]
+    condition
+        pointer to the condition expression
+
+@param[in]
+    thenStatements
+        pointer to the statements run when the condition is true
+
+@param[in]
+    elseStatements
+        pointer to the statements run when the condition is false
+
+@retval pointer to the if expression
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewSelection( void *condition,
+                           void *thenStatements,
+                           void *elseStatements )
+{
+    Variable *pCondition = (Variable *)condition;
+    Logical *pLogical;
+    Variable *pIf = NULL;
+
+    pLogical = FindLogical( pCondition );
+    if ( ( pActions->profile == true ) && ( pLogical != NULL ) )
+    {
+        pIf = NewCondition( pLogical->type,
+                            pCondition,
+                            (Statement *)thenStatements,
+                            (Statement *)elseStatements );
+    }
+
+    if ( pIf == NULL )
+    {
+        pIf = LowerCondition( pCondition,
+                              (Statement *)thenStatements,
+                              (Statement *)elseStatements );
+    }
+
+    return pIf;
+}
+
+/*============================================================================*/
+/*  LowerCondition                                                            */
+/*!
+    Lower an if statement condition into short-circuit if expressions
+
+    The LowerCondition function replaces the && and || operators at the
+    top of an if statement condition with nested if expressions.
+
+    if ( A && B ) { T } else { E }
+        becomes if ( A ) { if ( B ) { T } else { E } } else { E }
+
+    if ( A || B ) { T } else { E }
+        becomes if ( A ) { T } else { if ( B ) { T } else { E } }
+
+    The then and else statement lists are shared by the nested if
+    expressions rather than copied.
+
+@param[in]
+    pCondition
+        pointer to the condition expression
+
+@param[in]
+    pThen
+        pointer to the statements run when the condition is true
+
+@param[in]
+    pElse
+        pointer to the statements run when the condition is false
+
+@retval pointer to the outermost if expression
+@retval NULL if an error occurred
+
+==============================================================================*/
+static Variable *LowerCondition( Variable *pCondition,
+                                 Statement *pThen,
+                                 Statement *pElse )
+{
+    Logical *pLogical;
+    Statement *pInner;
+
+    pLogical = FindLogical( pCondition );
+    if ( pLogical == NULL )
+    {
+        return CreateVariable( VA_IF,
+                               pCondition,
+                               CreateVariable( VA_ELSE, pThen, pElse ) );
+    }
+
+    pInner = NewIfStatement( LowerCondition( pLogical->pRight,
+                                             pThen,
+                                             pElse ) );
+    if ( pInner == NULL )
+    {
+        return NULL;
+    }
+
+    if ( pLogical->type == VA_AND )
+    {
+        return LowerCondition( pLogical->pLeft, pInner, pElse );
+    }
+
+    return LowerCondition( pLogical->pLeft, pThen, pInner );
+}
+
+/*============================================================================*/
+/*  NewCondition                                                              */
+/*!
+    Create a profiled compound condition
+
+    The NewCondition function flattens a chain of operands joined by
+    the same && or || operator, and builds the lowered if expression
+    for them.  The condition is recorded so it can be attached to the
+    action if it belongs to a top-level if statement.  Every operand
+    must have a side-effect free guard equivalent so it can be profiled.
+
+@param[in]
+    type
+        logical operation joining the operands (VA_AND or VA_OR)
+
+@param[in]
+    pExpression
+        pointer to the condition expression
+
+@param[in]
+    pThen
+        pointer to the statements run when the condition is true
+
+@param[in]
+    pElse
+        pointer to the statements run when the condition is false
+
+@retval pointer to the lowered if expression
+@retval NULL the condition cannot be profiled
+
+==============================================================================*/
+static Variable *NewCondition( int type,
+                               Variable *pExpression,
+                               Statement *pThen,
+                               Statement *pElse )
+{
+    Condition *pCondition;
+    size_t count;
+
+    count = FlattenCondition( pExpression, type, NULL, NULL );
+    if ( count < 2 )
+    {
+        return NULL;
+    }
+
+    pCondition = (Condition *)calloc( 1, sizeof( Condition ) );
+    if ( pCondition == NULL )
+    {
+        return NULL;
+    }
+
+    pCondition->type = type;
+    pCondition->count = count;
+    pCondition->pThen = pThen;
+    pCondition->pElse = pElse;
+    pCondition->ppOperands = (Variable **)calloc( count, sizeof( Variable * ) );
+    pCondition->ppGuards = (Guard **)calloc( count, sizeof( Guard * ) );
+    pCondition->pDecisive = (uint64_t *)calloc( count, sizeof( uint64_t ) );
+
+    if ( ( pCondition->ppOperands != NULL ) &&
+         ( pCondition->ppGuards != NULL ) &&
+         ( pCondition->pDecisive != NULL ) )
+    {
+        (void)FlattenCondition( pExpression,
+                                type,
+                                pCondition->ppOperands,
+                                pCondition->ppGuards );
+
+        pCondition->pIf = BuildCondition( type,
+                                          pCondition->ppOperands,
+                                          count,
+                                          pThen,
+                                          pElse );
+    }
+
+    if ( pCondition->pIf == NULL )
+    {
+        FreeCondition( pCondition );
+        return NULL;
+    }
+
+    pCondition->pNext = pConditionList;
+    pConditionList = pCondition;
+
+    return pCondition->pIf;
+}
+
+/*============================================================================*/
+/*  FlattenCondition                                                          */
+/*!
+    Flatten a chain of && or || operands
+
+    The FlattenCondition function collects the operands of a chain of
+    logical expressions which all use the same operator, in left to
+    right order.  The chain can only be flattened if none of its
+    operands are logical expressions with a different operator, and
+    all of its operands have guard equivalents.
+
+@param[in]
+    pVariable
+        pointer to the expression to flatten
+
+@param[in]
+    type
+        logical operation of the chain (VA_AND or VA_OR)
+
+@param[in]
+    ppOperands
+        array to receive the operands, or NULL to count them
+
+@param[in]
+    ppGuards
+        array to receive the guard equivalents of the operands,
+        or NULL to count them
+
+@retval number of operands in the chain
+@retval 0 the chain cannot be flattened
+
+==============================================================================*/
+static size_t FlattenCondition( Variable *pVariable,
+                                int type,
+                                Variable **ppOperands,
+                                Guard **ppGuards )
+{
+    Logical *pLogical;
+    Guard *pGuard;
+    size_t left;
+    size_t right;
+
+    pLogical = FindLogical( pVariable );
+    if ( pLogical != NULL )
+    {
+        if ( pLogical->type != type )
+        {
+            return 0;
+        }
+
+        left = FlattenCondition( pLogical->pLeft, type, ppOperands, ppGuards );
+        if ( left == 0 )
+        {
+            return 0;
+        }
+
+        right = FlattenCondition( pLogical->pRight,
+                                  type,
+                                  ( ppOperands != NULL ) ? &ppOperands[left]
+                                                         : NULL,
+                                  ( ppGuards != NULL ) ? &ppGuards[left]
+                                                       : NULL );
+
+        return ( right == 0 ) ? 0 : left + right;
+    }
+
+    pGuard = FindShadow( pVariable );
+    if ( pGuard == NULL )
+    {
+        return 0;
+    }
+
+    if ( ( ppOperands != NULL ) && ( ppGuards != NULL ) )
+    {
+        ppOperands[0] = pVariable;
+        ppGuards[0] = pGuard;
+    }
+
+    return 1;
+}
+
+/*============================================================================*/
+/*  ShadowInput                                                               */
+/*!
+    Record the guard equivalent of a system variable reference
+
+    When profiling is enabled, the ShadowInput function records a guard
+    input which reads the cached value of a numeric system variable,
+    as the side-effect free equivalent of a variable reference.
+    Local variables and trigger references have no guard equivalent.
+
+@param[in]
+    variable
+        pointer to the variable reference expression node
+
+@return none
+
+==============================================================================*/
+static void ShadowInput( void *variable )
+{
+    Variable *pVariable = (Variable *)variable;
+    Trigger *pTrigger;
+
+    if ( ( pActions->profile == false ) || ( pVariable == NULL ) )
+    {
+        return;
+    }
+
+    for ( pTrigger = pTriggerList; pTrigger != NULL; pTrigger = pTrigger->pNext )
+    {
+        if ( pTrigger->pVariable == pVariable )
+        {
+            return;
+        }
+    }
+
+    NoteShadow( pVariable,
+                NewGuardInput( pVariable->hVar, pVariable->obj.type ) );
+}
+
+/*============================================================================*/
+/*  ShadowConstant                                                            */
+/*!
+    Record the guard equivalent of a numeric constant
+
+@param[in]
+    variable
+        pointer to the numeric constant expression node
+
+@return none
+
+==============================================================================*/
+static void ShadowConstant( void *variable )
+{
+    Variable *pVariable = (Variable *)variable;
+
+    if ( ( pActions->profile == true ) && ( pVariable != NULL ) )
+    {
+        NoteShadow( pVariable, NewGuardConstant( &pVariable->obj ) );
+    }
+}
+
+/*============================================================================*/
+/*  ShadowOperation                                                           */
+/*!
+    Record the guard equivalent of a comparison or not expression
+
+    When profiling is enabled, the ShadowOperation function records the
+    guard equivalent of an expression if all of its operands have
+    guard equivalents.
+
+@param[in]
+    op
+        guard operation equivalent to the expression
+
+@param[in]
+    variable
+        pointer to the expression node
+
+@param[in]
+    left
+        pointer to the left operand
+
+@param[in]
+    right
+        pointer to the right operand, or NULL for a not expression
+
+@return none
+
+==============================================================================*/
+static void ShadowOperation( GuardOp op,
+                             void *variable,
+                             void *left,
+                             void *right )
+{
+    Guard *pLeft;
+    Guard *pRight = NULL;
+
+    if ( ( pActions->profile == false ) || ( variable == NULL ) )
+    {
+        return;
+    }
+
+    pLeft = FindShadow( (Variable *)left );
+    if ( right != NULL )
+    {
+        pRight = FindShadow( (Variable *)right );
+        if ( pRight == NULL )
+        {
+            return;
+        }
+    }
+
+    if ( pLeft != NULL )
+    {
+        NoteShadow( (Variable *)variable, NewGuard( op, pLeft, pRight ) );
+    }
+}
+
+/*============================================================================*/
+/*  NoteShadow                                                                */
+/*!
+    Record the guard equivalent of an expression node
+
+@param[in]
+    pVariable
+        pointer to the expression node
+
+@param[in]
+    pGuard
+        pointer to the equivalent guard expression
+
+@return none
+
+==============================================================================*/
+static void NoteShadow( Variable *pVariable, Guard *pGuard )
+{
+    Shadow *pShadow;
+
+    if ( ( pVariable != NULL ) && ( pGuard != NULL ) )
+    {
+        pShadow = (Shadow *)calloc( 1, sizeof( Shadow ) );
+        if ( pShadow != NULL )
+        {
+            pShadow->pVariable = pVariable;
+            pShadow->pGuard = pGuard;
+            pShadow->pNext = pShadows;
+            pShadows = pShadow;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  FindShadow                                                                */
+/*!
+    Find the guard equivalent of an expression node
+
+@param[in]
+    pVariable
+        pointer to the expression node
+
+@retval pointer to the equivalent guard expression
+@retval NULL the expression node has no guard equivalent
+
+==============================================================================*/
+static Guard *FindShadow( Variable *pVariable )
+{
+    Shadow *pShadow;
+
+    for ( pShadow = pShadows; pShadow != NULL; pShadow = pShadow->pNext )
+    {
+        if ( ( pVariable != NULL ) && ( pShadow->pVariable == pVariable ) )
+        {
+            return pShadow->pGuard;
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  ClearShadows                                                              */
+/*!
+    Clear the guard equivalent list
+
+    The guard expressions themselves are not freed since they may be
+    used by the profiled conditions.
+
+@return none
+
+==============================================================================*/
+static void ClearShadows( void )
+{
+    Shadow *pShadow;
+
+    while ( pShadows != NULL )
+    {
+        pShadow = pShadows;
+        pShadows = pShadow->pNext;
+        free( pShadow );
+    }
+}
+
+/*============================================================================*/
+/*  AttachConditions                                                          */
+/*!
+    Get the profiled conditions of a statement list
+
+    The AttachConditions function removes the conditions of the top-level
+    if statements of the given statement list from the conditions of
+    the action currently being parsed, and returns them in statement
+    order.  The system variables read by the attached conditions are
+    watched so their cached values stay current.
+
+@param[in]
+    pStatements
+        pointer to the statement list
+
+@retval pointer to the ordered conditions of the statement list
+@retval NULL the statement list has no profiled conditions
+
+==============================================================================*/
+static Condition *AttachConditions( Statement *pStatements )
+{
+    Condition *pFirst = NULL;
+    Condition *pLast = NULL;
+    Condition **ppCondition;
+    Condition *pCondition;
+    Statement *pStatement;
+    size_t i;
+
+    for ( pStatement = pStatements;
+          pStatement != NULL;
+          pStatement = pStatement->pNext )
+    {
+        ppCondition = &pConditionList;
+        while ( *ppCondition != NULL )
+        {
+            pCondition = *ppCondition;
+            if ( pCondition->pIf == pStatement->pVariable )
+            {
+                *ppCondition = pCondition->pNext;
+                pCondition->pNext = NULL;
+                pCondition->pStatement = pStatement;
+
+                for ( i = 0; i < pCondition->count; i++ )
+                {
+                    WatchGuardInputs( pCondition->ppGuards[i] );
+                }
+
+                if ( pLast == NULL )
+                {
+                    pFirst = pCondition;
+                }
+                else
+                {
+                    pLast->pNext = pCondition;
+                }
+
+                pLast = pCondition;
+                break;
+            }
+
+            ppCondition = &pCondition->pNext;
+        }
+    }
+
+    return pFirst;
+}
+
+/*============================================================================*/
+/*  WatchGuardInputs                                                          */
+/*!
+    Request MODIFIED notifications for the inputs of a guard
+
+@param[in]
+    pGuard
+        pointer to the guard expression
+
+@return none
+
+==============================================================================*/
+static void WatchGuardInputs( Guard *pGuard )
+{
+    if ( pGuard != NULL )
+    {
+        if ( ( pGuard->op == GUARD_eINPUT ) &&
+             ( pGuard->pInput != NULL ) &&
+             ( WatchVariable( pGuard->pInput->hVar,
+                              pGuard->pInput->type ) != EOK ) )
+        {
+            LogMessage( LOGLEVEL_eWARNING,
+                        "Cannot register change notification" );
+        }
+
+        WatchGuardInputs( pGuard->pLeft );
+        WatchGuardInputs( pGuard->pRight );
+    }
+}
+
+/*============================================================================*/
+/*  ClearConditions                                                           */
+/*!
+    Discard the unattached profiled conditions
+
+    The ClearConditions function discards the conditions of the action
+    currently being parsed which do not belong to a top-level if
+    statement.  Their if expressions stay lowered, but are not profiled.
+
+@return none
+
+==============================================================================*/
+static void ClearConditions( void )
+{
+    Condition *pCondition;
+
+    while ( pConditionList != NULL )
+    {
+        pCondition = pConditionList;
+        pConditionList = pCondition->pNext;
+        FreeCondition( pCondition );
+    }
+}
+
+/*============================================================================*/
+/*  FreeCondition                                                             */
+/*!
+    Free a profiled condition record
+
+    The lowered if expression of the condition is not freed.
+
+@param[in]
+    pCondition
+        pointer to the condition to free
+
+@return none
+
+==============================================================================*/
+static void FreeCondition( Condition *pCondition )
+{
+    if ( pCondition != NULL )
+    {
+        free( pCondition->ppOperands );
+        free( pCondition->ppGuards );
+        free( pCondition->pDecisive );
+        free( pCondition );
+    }
+}
+
+/*============================================================================*/
+/*  NewTypedDeclaration                                                       */
+/*!
+    Declare a local variable
+
+    The NewTypedDeclaration function declares a local variable of one
+    of the script types.  The int64, uint64 and bool types have no
+    libvaraction type code, so they are declared with the nearest
+    integer type, and their storage is set to the native VarServer type
+    so arithmetic on them is performed at full width.
+
+@param[in]
+    type
+        the script type (VA_FLOAT, VA_INT, VA_SHORT, VA_STRING,
+        TYPE_INT64, TYPE_UINT64 or TYPE_BOOL)
+
+@param[in]
+    id
+        pointer to the declared identifier
+
+@retval pointer to the local variable declaration
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewTypedDeclaration( void *type, void *id )
+{
+    Variable *pDeclaration;
+    Variable *pVariable = (Variable *)id;
+    uintptr_t base = (uintptr_t)type;
+    VarType native = VARTYPE_INVALID;
+
+    switch ( (uintptr_t)type )
+    {
+        case TYPE_INT64:
+            base = VA_INT;
+            native = VARTYPE_INT64;
+            break;
+
+        case TYPE_UINT64:
+            base = VA_INT;
+            native = VARTYPE_UINT64;
+            break;
+
+        case TYPE_BOOL:
+            base = VA_SHORT;
+            native = VARTYPE_UINT16;
+            break;
+
+        default:
+            break;
+    }
+
+    pDeclaration = CreateDeclaration( base, id );
+    NoteLocal( pVariable );
+    if ( native != VARTYPE_INVALID )
+    {
+        if ( pVariable != NULL )
+        {
+            memset( &pVariable->obj.val, 0, sizeof( pVariable->obj.val ) );
+            pVariable->obj.type = native;
+        }
+
+        if ( ( pDeclaration != NULL ) && ( pDeclaration != pVariable ) )
+        {
+            memset( &pDeclaration->obj.val,
+                    0,
+                    sizeof( pDeclaration->obj.val ) );
+            pDeclaration->obj.type = native;
+        }
+    }
+
+    return pDeclaration;
+}
+
+/*============================================================================*/
+/*  NewWideNumber                                                             */
+/*!
+    Create an integer constant
+
+    The NewWideNumber function creates an integer constant from the
+    current token.  Constants which do not fit in 32 bits are stored
+    as 64-bit values.
+
+@retval pointer to the integer constant
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewWideNumber( void )
+{
+    Variable *pVariable;
+    unsigned long long u;
+    long long s;
+
+    pVariable = NewNumber( yytext );
+    if ( pVariable == NULL )
+    {
+        return NULL;
+    }
+
+    errno = 0;
+    if ( yytext[0] == '-' )
+    {
+        s = strtoll( yytext, NULL, 0 );
+        if ( ( errno == 0 ) && ( s < INT32_MIN ) )
+        {
+            pVariable->obj.type = VARTYPE_INT64;
+            pVariable->obj.val.ll = (int64_t)s;
+        }
+    }
+    else
+    {
+        u = strtoull( yytext, NULL, 0 );
+        if ( ( errno == 0 ) && ( u > UINT32_MAX ) )
+        {
+            pVariable->obj.type = VARTYPE_UINT64;
+            pVariable->obj.val.ull = (uint64_t)u;
+        }
+    }
+
+    if ( errno == ERANGE )
+    {
+        yyerror( "Integer constant out of range" );
+    }
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  NativeCast                                                                */
+/*!
+    Convert a value to an int64, uint64 or bool
+
+    The NativeCast function converts a numeric constant to the target
+    type when the script is loaded.  Variables can be cast to bool,
+    which compares them against zero.  Variables cannot be cast to int64 or uint64 since
+    libvaraction has no run time conversion to those types; declare a
+    64-bit local variable and assign the value to it instead.
+
+@param[in]
+    type
+        target type (TYPE_INT64, TYPE_UINT64 or TYPE_BOOL)
+
+@param[in]
+    variable
+        pointer to the value to convert
+
+@param[in]
+    constant
+        true if the value is a numeric constant
+
+@retval pointer to the converted value
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NativeCast( void *type, void *variable, bool constant )
+{
+    Variable *pVariable = (Variable *)variable;
+    Variable *pZero;
+    VarObject *pObj;
+    long double value;
+
+    if ( pVariable == NULL )
+    {
+        return NULL;
+    }
+
+    if ( constant == false )
+    {
+        switch ( (uintptr_t)type )
+        {
+            case TYPE_BOOL:
+                pZero = NewNumber( "0" );
+                return CreateVariable( VA_NOTEQUALS, pVariable, pZero );
+
+            default:
+                yyerror( "int64 and uint64 casts apply only to constants" );
+                return NULL;
+        }
+    }
+
+    pObj = &pVariable->obj;
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:    value = pObj->val.ui; break;
+        case VARTYPE_INT16:     value = pObj->val.i; break;
+        case VARTYPE_UINT32:    value = pObj->val.ul; break;
+        case VARTYPE_INT32:     value = pObj->val.l; break;
+        case VARTYPE_UINT64:    value = pObj->val.ull; break;
+        case VARTYPE_INT64:     value = pObj->val.ll; break;
+        case VARTYPE_FLOAT:     value = pObj->val.f; break;
+        default:
+            yyerror( "Invalid constant cast" );
+            return NULL;
+    }
+
+    memset( &pObj->val, 0, sizeof( pObj->val ) );
+    switch ( (uintptr_t)type )
+    {
+        case TYPE_INT64:
+            pObj->type = VARTYPE_INT64;
+            pObj->val.ll = (int64_t)value;
+            break;
+
+        case TYPE_UINT64:
+            pObj->type = VARTYPE_UINT64;
+            pObj->val.ull = (uint64_t)value;
+            break;
+
+        default:
+            pObj->type = VARTYPE_UINT16;
+            pObj->val.ui = ( value != 0 ) ? 1 : 0;
+            break;
+    }
+
+    return pVariable;
+}
+
+/*============================================================================*/
+/*  FoldWide                                                                  */
+/*!
+    Evaluate a constant 64-bit integer expression
+
+@param[in]
+    type
+        the expression type (VA_ADD, VA_MUL etc)
+
+@param[in]
+    pLeft
+        pointer to the left operand value
+
+@param[in]
+    pRight
+        pointer to the right operand value (same type as the left)
+
+@param[out]
+    pResult
+        pointer to the location to store the result
+
+@retval true the expression was evaluated
+@retval false the expression cannot be evaluated at parse time
+
+==============================================================================*/
+static bool FoldWide( int type, VarObject *pLeft, VarObject *pRight,
+                      VarObject *pResult )
+{
+    uint64_t a = pLeft->val.ull;
+    uint64_t b = pRight->val.ull;
+    int64_t sa = pLeft->val.ll;
+    int64_t sb = pRight->val.ll;
+    bool isSigned = ( pLeft->type == VARTYPE_INT64 );
+    bool overflow = false;
+
+    pResult->type = pLeft->type;
+
+    switch ( type )
+    {
+        case VA_ADD:
+            overflow = isSigned
+                ? __builtin_add_overflow( sa, sb, &pResult->val.ll )
+                : __builtin_add_overflow( a, b, &pResult->val.ull );
+            break;
+
+        case VA_SUB:
+            overflow = isSigned
+                ? __builtin_sub_overflow( sa, sb, &pResult->val.ll )
+                : __builtin_sub_overflow( a, b, &pResult->val.ull );
+            break;
+
+        case VA_MUL:
+            overflow = isSigned
+                ? __builtin_mul_overflow( sa, sb, &pResult->val.ll )
+                : __builtin_mul_overflow( a, b, &pResult->val.ull );
+            break;
+
+        case VA_DIV:
+            if ( ( b == 0 ) ||
+                 ( isSigned && ( sa == INT64_MIN ) && ( sb == -1 ) ) )
+            {
+                return false;
+            }
+
+            if ( isSigned )
+            {
+                pResult->val.ll = sa / sb;
+            }
+            else
+            {
+                pResult->val.ull = a / b;
+            }
+            break;
+
+        case VA_BAND:   pResult->val.ull = a & b; break;
+        case VA_BOR:    pResult->val.ull = a | b; break;
+        case VA_XOR:    pResult->val.ull = a ^ b; break;
+
+        case VA_LSHIFT:
+            if ( ( b >= 64 ) ||
+                 ( isSigned && ( sa < 0 ) ) ||
+                 ( ( a << b ) >> b != a ) ||
+                 ( isSigned && ( (int64_t)( a << b ) < 0 ) ) )
+            {
+                return false;
+            }
+            pResult->val.ull = a << b;
+            break;
+
+        case VA_RSHIFT:
+            if ( ( b >= 64 ) || ( isSigned && ( sa < 0 ) ) )
+            {
+                return false;
+            }
+            pResult->val.ull = a >> b;
+            break;
+
+        default:
+            return false;
+    }
+
+    /* leave overflow behavior to the run time */
+    return ( overflow == false );
+}
+
+/*============================================================================*/
+/*  NoteLocal                                                                 */
+/*!
+    Record a local variable declaration
+
+    The NoteLocal function records the declared node of a local variable
+    of the action currently being parsed, so statements which assign
+    the variable from the engine, such as for each loops, can find it.
+
+@param[in]
+    pVariable
+        pointer to the declared local variable
+
+@return none
+
+==============================================================================*/
+static void NoteLocal( Variable *pVariable )
+{
+    Local *pLocal;
+
+    if ( pVariable != NULL )
+    {
+        pLocal = (Local *)calloc( 1, sizeof( Local ) );
+        if ( pLocal != NULL )
+        {
+            pLocal->pVariable = pVariable;
+            pLocal->pNext = pLocals;
+            pLocals = pLocal;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  FindLocal                                                                 */
+/*!
+    Find a local variable declaration by name
+
+@param[in]
+    id
+        pointer to the name of the local variable
+
+@retval pointer to the declared local variable
+@retval NULL the action has no local variable with that name
+
+==============================================================================*/
+static Variable *FindLocal( char *id )
+{
+    Local *pLocal;
+
+    for ( pLocal = pLocals; pLocal != NULL; pLocal = pLocal->pNext )
+    {
+        if ( ( id != NULL ) &&
+             ( pLocal->pVariable->id != NULL ) &&
+             ( strcmp( pLocal->pVariable->id, id ) == 0 ) )
+        {
+            return pLocal->pVariable;
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  ClearLocals                                                               */
+/*!
+    Clear the local variable declaration list
+
+@return none
+
+==============================================================================*/
+static void ClearLocals( void )
+{
+    Local *pLocal;
+
+    while ( pLocals != NULL )
+    {
+        pLocal = pLocals;
+        pLocals = pLocal->pNext;
+        free( pLocal );
+    }
+}
+
+/*============================================================================*/
+/*  NewVariableSet                                                            */
+/*!
+    Declare a named variable set
+
+    The NewVariableSet function declares a named set of numeric system
+    variables in the action currently being parsed, from a list of
+    variables and wildcard patterns.  The set is resolved once when
+    the script is loaded, so loops and reductions over it are bounded.
+
+@param[in]
+    name
+        pointer to the name of the set
+
+@param[in]
+    signals
+        pointer to the list of member variables
+
+@retval NULL a set is not a local variable declaration
+
+==============================================================================*/
+static void *NewVariableSet( void *name, void *signals )
+{
+    VarSet *pSet = NULL;
+    Signal *pSignal = (Signal *)signals;
+    Signal *pNext;
+    Variable *pVariable;
+    int type;
+
+    /* set members do not name the action's triggering variable */
+    triggerName = setTriggerName;
+
+    if ( FindVarSet( (char *)name, false ) != NULL )
+    {
+        yyerror( "Duplicate variable set" );
+    }
+    else
+    {
+        pSet = NewVarSet( (char *)name );
+    }
+
+    while ( pSignal != NULL )
+    {
+        pNext = pSignal->pNext;
+        pVariable = pSignal->pVariable;
+        type = ( pVariable != NULL ) ? (int)pVariable->obj.type
+                                     : VARTYPE_INVALID;
+
+        if ( ( pVariable == NULL ) ||
+             ( pVariable->hVar == VAR_INVALID ) ||
+             ( type == VARTYPE_INVALID ) ||
+             ( type == VARTYPE_STR ) ||
+             ( type == VARTYPE_BLOB ) )
+        {
+            yyerror( "set members must be numeric system variables" );
+        }
+        else if ( pSet != NULL )
+        {
+            (void)AddVarSetMember( pSet, pVariable->hVar );
+            NoteReference( &pReadRefs, pVariable );
+        }
+
+        free( pSignal );
+        pSignal = pNext;
+    }
+
+    if ( pSet != NULL )
+    {
+        pSet->pNext = pSetList;
+        pSetList = pSet;
+    }
+
+    free( name );
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  FindVarSet                                                                */
+/*!
+    Find a variable set of the action currently being parsed
+
+@param[in]
+    name
+        pointer to the name of the set
+
+@param[in]
+    required
+        true if a missing set is an error
+
+@retval pointer to the variable set
+@retval NULL the set was not found
+
+==============================================================================*/
+static VarSet *FindVarSet( char *name, bool required )
+{
+    VarSet *pSet;
+
+    for ( pSet = pSetList; pSet != NULL; pSet = pSet->pNext )
+    {
+        if ( ( name != NULL ) && ( strcmp( pSet->name, name ) == 0 ) )
+        {
+            return pSet;
+        }
+    }
+
+    if ( required == true )
+    {
+        yyerror( "Unknown variable set" );
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  NewLoop                                                                   */
+/*!
+    Create a for each loop
+
+    The NewLoop function creates a loop over a variable set in the action
+    currently being parsed.  The loop is run by the engine, which fetches
+    the set's values and runs the loop body once per value with the value
+    stored in the loop variable.  The loop variable counts as assigned
+    in the loop body.
+
+@param[in]
+    variable
+        pointer to the loop variable reference
+
+@param[in]
+    set
+        pointer to the variable set to iterate over
+
+@retval pointer to the loop
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewLoop( void *variable, void *set )
+{
+    Variable *pVariable = (Variable *)variable;
+    Variable *pLocal = NULL;
+    Loop *pLoop;
+    Loop **ppLoop;
+
+    if ( pVariable != NULL )
+    {
+        pLocal = FindLocal( pVariable->id );
+    }
+
+    if ( ( pLocal == NULL ) ||
+         ( pLocal->obj.type == VARTYPE_STR ) ||
+         ( pLocal->obj.type == VARTYPE_INVALID ) )
+    {
+        yyerror( "loop variable must be a numeric local variable" );
+        return NULL;
+    }
+
+    pLocal->assigned = true;
+    pVariable->assigned = true;
+
+    pLoop = (Loop *)calloc( 1, sizeof( Loop ) );
+    if ( pLoop != NULL )
+    {
+        pLoop->pStatement = (Statement *)calloc( 1, sizeof( Statement ) );
+        if ( pLoop->pStatement == NULL )
+        {
+            free( pLoop );
+            return NULL;
+        }
+
+        pLoop->pVariable = pLocal;
+        pLoop->pSet = (VarSet *)set;
+
+        /* keep the loops in source order */
+        ppLoop = &pLoopList;
+        while ( *ppLoop != NULL )
+        {
+            ppLoop = &(*ppLoop)->pNext;
+        }
+
+        *ppLoop = pLoop;
+    }
+
+    return pLoop;
+}
+
+/*============================================================================*/
+/*  SetLoopBody                                                               */
+/*!
+    Set the body of a for each loop
+
+@param[in]
+    loop
+        pointer to the loop
+
+@param[in]
+    statements
+        pointer to the statements of the loop body
+
+@retval pointer to the Statement which the loop replaces
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *SetLoopBody( void *loop, void *statements )
+{
+    Loop *pLoop = (Loop *)loop;
+
+    if ( pLoop == NULL )
+    {
+        return NULL;
+    }
+
+    pLoop->pBody = (Statement *)statements;
+
+    return pLoop->pStatement;
+}
+
+/*============================================================================*/
+/*  AttachLoops                                                               */
+/*!
+    Get the for each loops of a statement list
+
+    The AttachLoops function removes the loops of the given statement
+    list from the loops of the action currently being parsed, and
+    returns them in statement order.  Loops nested inside other
+    statements are left in the list.
+
+@param[in]
+    pStatements
+        pointer to the statement list
+
+@retval pointer to the ordered loops of the statement list
+@retval NULL the statement list has no loops
+
+==============================================================================*/
+static Loop *AttachLoops( Statement *pStatements )
+{
+    Loop *pFirst = NULL;
+    Loop *pLast = NULL;
+    Loop **ppLoop;
+    Loop *pLoop;
+    Statement *pStatement;
+
+    for ( pStatement = pStatements;
+          pStatement != NULL;
+          pStatement = pStatement->pNext )
+    {
+        ppLoop = &pLoopList;
+        while ( *ppLoop != NULL )
+        {
+            pLoop = *ppLoop;
+            if ( pLoop->pStatement == pStatement )
+            {
+                *ppLoop = pLoop->pNext;
+                pLoop->pNext = NULL;
+
+                if ( pLast == NULL )
+                {
+                    pFirst = pLoop;
+                }
+                else
+                {
+                    pLast->pNext = pLoop;
+                }
+
+                pLast = pLoop;
+                break;
+            }
+
+            ppLoop = &pLoop->pNext;
+        }
+    }
+
+    return pFirst;
+}
+
+/*============================================================================*/
+/*  NewReduction                                                              */
+/*!
+    Create a variable set reduction
+
+    The NewReduction function creates an expression node holding the
+    sum, avg, min or max of the values of a variable set.  The engine
+    fetches the set and calculates the value each time the action runs.
+    Reduced values are floating point values.
+
+@param[in]
+    op
+        reduction operation
+
+@param[in]
+    set
+        pointer to the variable set to reduce
+
+@retval pointer to the expression node holding the reduced value
+@retval NULL if an error occurred
+
+==============================================================================*/
+static void *NewReduction( ReduceOp op, void *set )
+{
+    Reduction *pReduction;
+    Variable *pVariable = NULL;
+
+    if ( set != NULL )
+    {
+        pVariable = NewFloat( "0.0" );
+        pReduction = (Reduction *)calloc( 1, sizeof( Reduction ) );
+        if ( ( pVariable != NULL ) && ( pReduction != NULL ) )
+        {
+            pReduction->pVariable = pVariable;
+            pReduction->op = op;
+            pReduction->pSet = (VarSet *)set;
+            pReduction->pNext = pReductionList;
+            pReductionList = pReduction;
+        }
+        else
+        {
+            free( pReduction );
+        }
+    }
+
+    return pVariable;
+}
@@ -0,0 +1,416 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup aggregate aggregate
+ * @brief Streaming window aggregate functions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file aggregate.c
+
+    Streaming Window Aggregates
+
+    The aggregate component maintains rolling statistics over the
+    values of a system variable, updated from its change notifications.
+
+    - average, minimum, maximum and rate over a time window
+    - exponentially weighted moving average
+
+    Samples are held in a fixed size ring buffer, with a running sum for
+    the average, and a monotonic queue of candidates for the minimum and
+    maximum, so each sample is added and expired in constant
+    (amortized) time.  If more than MAX_AGGREGATE_SAMPLES samples arrive
+    within the window, the oldest samples are expired early.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "aggregate.h"
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static void Expire( Aggregate *pAggregate, uint64_t t );
+static void Evict( Aggregate *pAggregate );
+static bool Dominates( Aggregate *pAggregate, double value, double other );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewAggregate                                                              */
+/*!
+    Create a new streaming aggregate
+
+    The NewAggregate function creates a new aggregate over the values
+    of a system variable.
+
+@param[in]
+    type
+        the type of aggregate to create
+
+@param[in]
+    hVar
+        handle of the system variable to aggregate
+
+@param[in]
+    varType
+        VarServer type of the system variable to aggregate
+
+@param[in]
+    window
+        aggregation window in milliseconds (not used by AGGREGATE_eEWMA)
+
+@param[in]
+    alpha
+        smoothing factor (AGGREGATE_eEWMA only)
+
+@param[in]
+    pResult
+        pointer to the expression node which holds the aggregate value
+
+@retval pointer to the new aggregate
+@retval NULL if the aggregate could not be created
+
+==============================================================================*/
+Aggregate *NewAggregate( AggregateType type,
+                         VAR_HANDLE hVar,
+                         int varType,
+                         uint64_t window,
+                         double alpha,
+                         Variable *pResult )
+{
+    Aggregate *pAggregate;
+
+    pAggregate = (Aggregate *)calloc( 1, sizeof( Aggregate ) );
+    if ( pAggregate != NULL )
+    {
+        pAggregate->type = type;
+        pAggregate->hVar = hVar;
+        pAggregate->varType = varType;
+        pAggregate->window = window;
+        pAggregate->alpha = alpha;
+        pAggregate->pResult = pResult;
+
+        if ( type != AGGREGATE_eEWMA )
+        {
+            pAggregate->pSamples = calloc( MAX_AGGREGATE_SAMPLES,
+                                           sizeof( Sample ) );
+            if ( pAggregate->pSamples == NULL )
+            {
+                free( pAggregate );
+                return NULL;
+            }
+        }
+
+        if ( ( type == AGGREGATE_eMIN ) || ( type == AGGREGATE_eMAX ) )
+        {
+            pAggregate->pCandidates = calloc( MAX_AGGREGATE_SAMPLES,
+                                              sizeof( uint64_t ) );
+            if ( pAggregate->pCandidates == NULL )
+            {
+                free( pAggregate->pSamples );
+                free( pAggregate );
+                return NULL;
+            }
+        }
+    }
+
+    return pAggregate;
+}
+
+/*============================================================================*/
+/*  AddSample                                                                 */
+/*!
+    Add a sample to an aggregate
+
+    The AddSample function adds a new sample of the aggregated variable,
+    and expires the samples which have fallen out of the window.
+
+@param[in]
+    pAggregate
+        pointer to the aggregate to update
+
+@param[in]
+    value
+        the sample value
+
+@param[in]
+    t
+        the sample time in milliseconds (CLOCK_MONOTONIC)
+
+@return none
+
+==============================================================================*/
+void AddSample( Aggregate *pAggregate, double value, uint64_t t )
+{
+    Sample *pSample;
+    Sample *pBack;
+
+    if ( pAggregate == NULL )
+    {
+        return;
+    }
+
+    if ( pAggregate->type == AGGREGATE_eEWMA )
+    {
+        pAggregate->ewma = ( pAggregate->next == 0 )
+                           ? value
+                           : ( pAggregate->alpha * value ) +
+                             ( 1.0 - pAggregate->alpha ) * pAggregate->ewma;
+        pAggregate->next++;
+        return;
+    }
+
+    Expire( pAggregate, t );
+
+    if ( pAggregate->next - pAggregate->first >= MAX_AGGREGATE_SAMPLES )
+    {
+        Evict( pAggregate );
+    }
+
+    pSample = &pAggregate->pSamples[pAggregate->next % MAX_AGGREGATE_SAMPLES];
+    pSample->value = value;
+    pSample->t = t;
+    pAggregate->sum += value;
+
+    if ( pAggregate->pCandidates != NULL )
+    {
+        /* remove the candidates which can no longer be the min/max */
+        while ( pAggregate->tail > pAggregate->head )
+        {
+            pBack = &pAggregate->pSamples[
+                pAggregate->pCandidates[( pAggregate->tail - 1 ) %
+                                        MAX_AGGREGATE_SAMPLES] %
+                MAX_AGGREGATE_SAMPLES];
+
+            if ( Dominates( pAggregate, pBack->value, value ) == true )
+            {
+                break;
+            }
+
+            pAggregate->tail--;
+        }
+
+        pAggregate->pCandidates[pAggregate->tail % MAX_AGGREGATE_SAMPLES] =
+            pAggregate->next;
+        pAggregate->tail++;
+    }
+
+    pAggregate->next++;
+}
+
+/*============================================================================*/
+/*  GetAggregate                                                              */
+/*!
+    Get the value of an aggregate
+
+    The GetAggregate function expires the samples which have fallen out
+    of the window and calculates the aggregate over the remaining samples.
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@param[in]
+    t
+        the current time in milliseconds (CLOCK_MONOTONIC)
+
+@return the aggregate value, or 0 if the window is empty
+
+==============================================================================*/
+double GetAggregate( Aggregate *pAggregate, uint64_t t )
+{
+    double result = 0.0;
+    uint64_t n;
+    Sample *pOldest;
+    Sample *pNewest;
+
+    if ( pAggregate == NULL )
+    {
+        return result;
+    }
+
+    if ( pAggregate->type == AGGREGATE_eEWMA )
+    {
+        return pAggregate->ewma;
+    }
+
+    Expire( pAggregate, t );
+
+    n = pAggregate->next - pAggregate->first;
+    if ( n == 0 )
+    {
+        return result;
+    }
+
+    pOldest = &pAggregate->pSamples[pAggregate->first % MAX_AGGREGATE_SAMPLES];
+    pNewest = &pAggregate->pSamples[( pAggregate->next - 1 ) %
+                                    MAX_AGGREGATE_SAMPLES];
+
+    switch ( pAggregate->type )
+    {
+        case AGGREGATE_eAVG:
+            result = pAggregate->sum / (double)n;
+            break;
+
+        case AGGREGATE_eMIN:
+        case AGGREGATE_eMAX:
+            result = pAggregate->pSamples[
+                pAggregate->pCandidates[pAggregate->head %
+                                        MAX_AGGREGATE_SAMPLES] %
+                MAX_AGGREGATE_SAMPLES].value;
+            break;
+
+        case AGGREGATE_eRATE:
+            if ( pNewest->t > pOldest->t )
+            {
+                result = ( pNewest->value - pOldest->value ) * 1000.0 /
+                         (double)( pNewest->t - pOldest->t );
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Expire                                                                    */
+/*!
+    Expire the samples which have fallen out of the window
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@param[in]
+    t
+        the current time in milliseconds (CLOCK_MONOTONIC)
+
+@return none
+
+==============================================================================*/
+static void Expire( Aggregate *pAggregate, uint64_t t )
+{
+    Sample *pSample;
+
+    while ( pAggregate->first < pAggregate->next )
+    {
+        pSample = &pAggregate->pSamples[pAggregate->first %
+                                        MAX_AGGREGATE_SAMPLES];
+        if ( t - pSample->t <= pAggregate->window )
+        {
+            break;
+        }
+
+        Evict( pAggregate );
+    }
+}
+
+/*============================================================================*/
+/*  Evict                                                                     */
+/*!
+    Remove the oldest sample from the window
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@return none
+
+==============================================================================*/
+static void Evict( Aggregate *pAggregate )
+{
+    Sample *pSample;
+
+    pSample = &pAggregate->pSamples[pAggregate->first % MAX_AGGREGATE_SAMPLES];
+    pAggregate->sum -= pSample->value;
+
+    if ( ( pAggregate->pCandidates != NULL ) &&
+         ( pAggregate->tail > pAggregate->head ) &&
+         ( pAggregate->pCandidates[pAggregate->head %
+                                   MAX_AGGREGATE_SAMPLES] ==
+           pAggregate->first ) )
+    {
+        pAggregate->head++;
+    }
+
+    pAggregate->first++;
+
+    if ( pAggregate->first == pAggregate->next )
+    {
+        /* avoid accumulating rounding errors in the running sum */
+        pAggregate->sum = 0.0;
+    }
+}
+
+/*============================================================================*/
+/*  Dominates                                                                 */
+/*!
+    Check if an older min/max candidate remains a candidate
+
+    An older candidate remains a candidate for the maximum (minimum)
+    only if it is greater (less) than the newer sample.
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@param[in]
+    value
+        the value of the older candidate
+
+@param[in]
+    other
+        the value of the newer sample
+
+@retval true the older candidate remains a candidate
+@retval false the older candidate can be discarded
+
+==============================================================================*/
+static bool Dominates( Aggregate *pAggregate, double value, double other )
+{
+    return ( pAggregate->type == AGGREGATE_eMAX ) ? ( value > other )
+                                                  : ( value < other );
+}
+
+/*! @}
+ * end of aggregate group */
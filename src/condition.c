@@ -0,0 +1,373 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup condition condition
+ * @brief Short-circuit compound conditions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file condition.c
+
+    Compound Conditions
+
+    The condition component lowers the && and || operators of if
+    statement conditions into nested if statements, so the right hand
+    operand is never evaluated (and its system variables are never
+    fetched) when the left hand operand decides the result.
+
+    if ( A && B ) { S1 } else { S2 }
+
+    is lowered to
+
+    if ( A ) { if ( B ) { S1 } else { S2 } } else { S2 }
+
+    and
+
+    if ( A || B ) { S1 } else { S2 }
+
+    is lowered to
+
+    if ( A ) { S1 } else { if ( B ) { S1 } else { S2 } }
+
+    When profiling is enabled, the operands of the compound conditions
+    of top-level if statements are evaluated from cached values each
+    time the condition runs, to count how often each operand would
+    decide the result.  After PROFILE_SAMPLES executions, the operands
+    are reordered so the most selective and cheapest operand runs first.
+
+    - build lowered compound conditions
+    - profile the operands of compound conditions
+    - reorder the operands of profiled conditions
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "condition.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static size_t GuardCost( Guard *pGuard );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  BuildCondition                                                            */
+/*!
+    Build a lowered compound condition
+
+    The BuildCondition function builds the nested if expressions which
+    evaluate a chain of operands joined by && or || from left to right,
+    stopping at the first operand which decides the result.
+
+@param[in]
+    type
+        logical operation joining the operands (VA_AND or VA_OR)
+
+@param[in]
+    ppOperands
+        pointer to the array of operand expressions
+
+@param[in]
+    count
+        number of operands
+
+@param[in]
+    pThen
+        statements to run when the condition is true
+
+@param[in]
+    pElse
+        statements to run when the condition is false
+
+@retval pointer to the outermost if expression
+@retval NULL if an error occurred
+
+==============================================================================*/
+Variable *BuildCondition( int type,
+                          Variable **ppOperands,
+                          size_t count,
+                          Statement *pThen,
+                          Statement *pElse )
+{
+    Variable *pInner;
+    Statement *pStatement;
+
+    if ( ( ppOperands == NULL ) || ( count == 0 ) )
+    {
+        return NULL;
+    }
+
+    if ( count == 1 )
+    {
+        return CreateVariable( VA_IF,
+                               ppOperands[0],
+                               CreateVariable( VA_ELSE, pThen, pElse ) );
+    }
+
+    pInner = BuildCondition( type, &ppOperands[1], count - 1, pThen, pElse );
+    pStatement = NewIfStatement( pInner );
+    if ( pStatement == NULL )
+    {
+        return NULL;
+    }
+
+    if ( type == VA_AND )
+    {
+        /* the remaining operands are only evaluated if this one is true */
+        return CreateVariable( VA_IF,
+                               ppOperands[0],
+                               CreateVariable( VA_ELSE, pStatement, pElse ) );
+    }
+
+    /* the remaining operands are only evaluated if this one is false */
+    return CreateVariable( VA_IF,
+                           ppOperands[0],
+                           CreateVariable( VA_ELSE, pThen, pStatement ) );
+}
+
+/*============================================================================*/
+/*  NewIfStatement                                                            */
+/*!
+    Create an if statement
+
+    The NewIfStatement function wraps an if expression in a statement
+    so it can be nested inside another if statement
+
+@param[in]
+    pIf
+        pointer to the if expression
+
+@retval pointer to the statement
+@retval NULL if an error occurred
+
+==============================================================================*/
+Statement *NewIfStatement( Variable *pIf )
+{
+    Statement *pStatement = NULL;
+
+    if ( pIf != NULL )
+    {
+        pStatement = (Statement *)calloc( 1, sizeof( Statement ) );
+        if ( pStatement != NULL )
+        {
+            pStatement->pVariable = pIf;
+        }
+    }
+
+    return pStatement;
+}
+
+/*============================================================================*/
+/*  ProfileCondition                                                          */
+/*!
+    Profile a compound condition
+
+    The ProfileCondition function evaluates every operand of a compound
+    condition from the cached values of its system variables, and counts
+    the operands which would decide the result: false operands of an &&
+    condition and true operands of an || condition.  The operands are
+    reordered after PROFILE_SAMPLES executions, and profiling of the
+    condition then stops.
+
+@param[in]
+    pCondition
+        pointer to the condition to profile
+
+@retval true the operands of the condition were reordered
+@retval false the condition is still being profiled, or is complete
+
+==============================================================================*/
+bool ProfileCondition( Condition *pCondition )
+{
+    bool decisive;
+    size_t i;
+
+    if ( ( pCondition == NULL ) || ( pCondition->samples >= PROFILE_SAMPLES ) )
+    {
+        return false;
+    }
+
+    for ( i = 0; i < pCondition->count; i++ )
+    {
+        decisive = EvalGuard( pCondition->ppGuards[i] );
+        if ( pCondition->type == VA_AND )
+        {
+            decisive = !decisive;
+        }
+
+        if ( decisive == true )
+        {
+            pCondition->pDecisive[i]++;
+        }
+    }
+
+    pCondition->samples++;
+
+    return ( pCondition->samples == PROFILE_SAMPLES ) &&
+           ( ReorderCondition( pCondition ) == EOK );
+}
+
+/*============================================================================*/
+/*  ReorderCondition                                                          */
+/*!
+    Reorder the operands of a compound condition
+
+    The ReorderCondition function sorts the operands of a profiled
+    condition by the number of times they decided the result, divided
+    by their cost, and rebuilds the lowered condition in the new order.
+    The cost of an operand is one plus the number of system variables
+    it reads.  Operand evaluation has no side effects, so the order does
+    not change the result of the condition.
+
+@param[in]
+    pCondition
+        pointer to the profiled condition
+
+@retval EOK the operands were reordered
+@retval EALREADY the operands are already in the best order
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int ReorderCondition( Condition *pCondition )
+{
+    Variable *pIf;
+    Variable *pOperand;
+    Guard *pGuard;
+    uint64_t decisive;
+    bool moved = false;
+    size_t i;
+    size_t j;
+
+    if ( ( pCondition == NULL ) || ( pCondition->pStatement == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    /* stable insertion sort by decisiveness per unit cost */
+    for ( i = 1; i < pCondition->count; i++ )
+    {
+        pOperand = pCondition->ppOperands[i];
+        pGuard = pCondition->ppGuards[i];
+        decisive = pCondition->pDecisive[i];
+
+        for ( j = i;
+              ( j > 0 ) &&
+              ( decisive * GuardCost( pCondition->ppGuards[j - 1] ) >
+                pCondition->pDecisive[j - 1] * GuardCost( pGuard ) );
+              j-- )
+        {
+            pCondition->ppOperands[j] = pCondition->ppOperands[j - 1];
+            pCondition->ppGuards[j] = pCondition->ppGuards[j - 1];
+            pCondition->pDecisive[j] = pCondition->pDecisive[j - 1];
+            moved = true;
+        }
+
+        pCondition->ppOperands[j] = pOperand;
+        pCondition->ppGuards[j] = pGuard;
+        pCondition->pDecisive[j] = decisive;
+    }
+
+    if ( moved == false )
+    {
+        return EALREADY;
+    }
+
+    pIf = BuildCondition( pCondition->type,
+                          pCondition->ppOperands,
+                          pCondition->count,
+                          pCondition->pThen,
+                          pCondition->pElse );
+    if ( pIf == NULL )
+    {
+        return ENOMEM;
+    }
+
+    /* the engine runs the statement's new expression from now on */
+    pCondition->pIf = pIf;
+    pCondition->pStatement->pVariable = pIf;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  GuardCost                                                                 */
+/*!
+    Calculate the cost of an operand
+
+    The GuardCost function estimates the cost of evaluating an operand
+    as one plus the number of system variables it reads
+
+@param[in]
+    pGuard
+        pointer to the guard equivalent of the operand
+
+@retval the cost of the operand
+
+==============================================================================*/
+static size_t GuardCost( Guard *pGuard )
+{
+    size_t cost = 1;
+
+    if ( pGuard != NULL )
+    {
+        if ( pGuard->op == GUARD_eINPUT )
+        {
+            cost++;
+        }
+
+        cost += GuardCost( pGuard->pLeft ) - 1;
+        cost += GuardCost( pGuard->pRight ) - 1;
+    }
+
+    return cost;
+}
+
+/*! @}
+ * end of condition group */
@@ -0,0 +1,924 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup control control
+ * @brief Runtime control interface
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file control.c
+
+    Runtime Control Interface
+
+    The control component lets an operator inspect and adjust a running
+    actions engine without editing and reloading its script.  Requests
+    are single line text datagrams sent to a UNIX domain socket, and
+    each request is answered with a single text datagram sent back to
+    the requesting socket.
+
+    - list the loaded actions and their execution statistics
+    - enable and disable individual actions
+    - enable and disable the change triggers of a variable
+    - change the interval of an every action
+    - dump the state of the engine
+
+    The socket raises CONTROL_NOTIFICATION when a request arrives, so
+    requests are collected by the engine thread along with the other
+    notifications, and are applied between action executions.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "control.h"
+#include "dispatch.h"
+#include "scheduler.h"
+#include "timer.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! control response under construction */
+typedef struct _response
+{
+    /*! response text */
+    char text[MAX_CONTROL_RESPONSE];
+
+    /*! length of the response text */
+    size_t len;
+} Response;
+
+/*==============================================================================
+       File Scoped Variables
+==============================================================================*/
+
+/*! control socket */
+static int controlFd = -1;
+
+/*! path of the control socket */
+static char *controlPath = NULL;
+
+/*! response to the current control request */
+static Response response;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static void Execute( Actions *pActions, char *request );
+static void Reply( const char *format, ... )
+    __attribute__(( format( printf, 1, 2 ) ));
+static Action *FindAction( Actions *pActions, char *number );
+static unsigned int ActionNumber( Actions *pActions, Action *pAction );
+static void EnableAction( Actions *pActions, char *number, bool enable );
+static void EnableTrigger( Actions *pActions, char *name, bool enable );
+static void SetPeriod( Actions *pActions, char *number, char *interval );
+static void ListActions( Actions *pActions );
+static void DumpState( Actions *pActions );
+static const char *ActionKind( Action *pAction );
+static const char *TriggerName( DispatchUnit *pUnit );
+static void FormatValue( VarObject *pObj, char *buf, size_t len );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  OpenControl                                                               */
+/*!
+    Open the control socket
+
+    The OpenControl function creates the control socket, replacing any
+    stale socket left at its path, and arranges for CONTROL_NOTIFICATION
+    to be raised when a control request arrives.  Any other kind of file
+    at the path is left alone.  The socket is only accessible by its
+    owner, since control requests can change how the actions run.
+
+@param[in]
+    path
+        path of the control socket
+
+@retval EOK the control socket was opened
+@retval EINVAL invalid arguments
+@retval ENAMETOOLONG the path is too long for a socket address
+@retval EEXIST a file which is not a socket exists at the path
+@retval other error from creating the socket
+
+==============================================================================*/
+int OpenControl( const char *path )
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    sigset_t mask;
+    mode_t oldMask;
+    int flags;
+    int result;
+    int rc;
+
+    if ( ( path == NULL ) || ( controlFd != -1 ) )
+    {
+        return EINVAL;
+    }
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    if ( strlen( path ) >= sizeof( addr.sun_path ) )
+    {
+        return ENAMETOOLONG;
+    }
+
+    strcpy( addr.sun_path, path );
+
+    if ( lstat( path, &st ) == 0 )
+    {
+        if ( !S_ISSOCK( st.st_mode ) )
+        {
+            /* never remove a file which is not a stale control socket */
+            return EEXIST;
+        }
+
+        (void)unlink( path );
+    }
+
+    /* the notification is collected by the engine with sigwaitinfo */
+    sigemptyset( &mask );
+    sigaddset( &mask, CONTROL_NOTIFICATION );
+    sigprocmask( SIG_BLOCK, &mask, NULL );
+
+    controlFd = socket( AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( controlFd == -1 )
+    {
+        return errno;
+    }
+
+    flags = fcntl( controlFd, F_GETFL );
+
+    /* create the socket file with owner only (0600) permissions */
+    oldMask = umask( 077 );
+    rc = bind( controlFd, (struct sockaddr *)&addr, sizeof( addr ) );
+    (void)umask( oldMask );
+    if ( ( rc != 0 ) ||
+         ( fcntl( controlFd, F_SETOWN, getpid() ) != 0 ) ||
+         ( fcntl( controlFd, F_SETSIG, CONTROL_NOTIFICATION ) != 0 ) ||
+         ( fcntl( controlFd, F_SETFL, flags | O_ASYNC | O_NONBLOCK ) != 0 ) )
+    {
+        result = errno;
+        close( controlFd );
+        controlFd = -1;
+        return result;
+    }
+
+    controlPath = strdup( path );
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  CloseControl                                                              */
+/*!
+    Close the control socket
+
+    The CloseControl function closes the control socket and removes it
+    from the file system.  It only uses async-signal-safe calls, so it
+    can be called from a termination handler.
+
+==============================================================================*/
+void CloseControl( void )
+{
+    if ( controlFd != -1 )
+    {
+        close( controlFd );
+        controlFd = -1;
+    }
+
+    if ( controlPath != NULL )
+    {
+        (void)unlink( controlPath );
+    }
+}
+
+/*============================================================================*/
+/*  HandleControl                                                             */
+/*!
+    Handle the pending control requests
+
+    The HandleControl function executes all of the requests waiting on
+    the control socket, and sends each response to the socket which
+    sent the request.  Requests from unbound sockets are executed,
+    but cannot be answered.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the control requests were handled
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int HandleControl( Actions *pActions )
+{
+    char request[MAX_CONTROL_REQUEST];
+    struct sockaddr_un client;
+    socklen_t len;
+    ssize_t n;
+
+    if ( ( pActions == NULL ) || ( controlFd == -1 ) )
+    {
+        return EINVAL;
+    }
+
+    while ( true )
+    {
+        len = sizeof( client );
+        n = recvfrom( controlFd,
+                      request,
+                      sizeof( request ) - 1,
+                      0,
+                      (struct sockaddr *)&client,
+                      &len );
+        if ( n < 0 )
+        {
+            break;
+        }
+
+        request[n] = '\0';
+        response.len = 0;
+        response.text[0] = '\0';
+
+        Execute( pActions, request );
+
+        if ( len > sizeof( sa_family_t ) )
+        {
+            (void)sendto( controlFd,
+                          response.text,
+                          response.len,
+                          MSG_DONTWAIT,
+                          (struct sockaddr *)&client,
+                          len );
+        }
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  Execute                                                                   */
+/*!
+    Execute a control request
+
+    The Execute function splits a control request into words and
+    runs the requested command.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    request
+        pointer to the NUL terminated request
+
+==============================================================================*/
+static void Execute( Actions *pActions, char *request )
+{
+    char *save = NULL;
+    char *command;
+    char *arg1;
+    char *arg2;
+    bool enable;
+
+    command = strtok_r( request, " \t\r\n", &save );
+    arg1 = strtok_r( NULL, " \t\r\n", &save );
+    arg2 = strtok_r( NULL, " \t\r\n", &save );
+
+    if ( command == NULL )
+    {
+        Reply( "error: empty request\n" );
+    }
+    else if ( strcmp( command, "list" ) == 0 )
+    {
+        ListActions( pActions );
+    }
+    else if ( strcmp( command, "dump" ) == 0 )
+    {
+        DumpState( pActions );
+    }
+    else if ( ( strcmp( command, "enable" ) == 0 ) ||
+              ( strcmp( command, "disable" ) == 0 ) )
+    {
+        enable = ( command[0] == 'e' );
+
+        if ( ( arg1 != NULL ) &&
+             ( strcmp( arg1, "trigger" ) == 0 ) &&
+             ( arg2 != NULL ) )
+        {
+            EnableTrigger( pActions, arg2, enable );
+        }
+        else if ( arg1 != NULL )
+        {
+            EnableAction( pActions, arg1, enable );
+        }
+        else
+        {
+            Reply( "error: usage: %s <action> | %s trigger <variable>\n",
+                   command,
+                   command );
+        }
+    }
+    else if ( strcmp( command, "period" ) == 0 )
+    {
+        if ( ( arg1 != NULL ) && ( arg2 != NULL ) )
+        {
+            SetPeriod( pActions, arg1, arg2 );
+        }
+        else
+        {
+            Reply( "error: usage: period <action> <milliseconds>\n" );
+        }
+    }
+    else
+    {
+        if ( strcmp( command, "help" ) != 0 )
+        {
+            Reply( "error: unknown request: %s\n", command );
+        }
+
+        Reply( "commands:\n"
+               "  list\n"
+               "  dump\n"
+               "  enable <action>\n"
+               "  disable <action>\n"
+               "  enable trigger <variable>\n"
+               "  disable trigger <variable>\n"
+               "  period <action> <milliseconds>\n" );
+    }
+}
+
+/*============================================================================*/
+/*  Reply                                                                     */
+/*!
+    Append text to the control response
+
+    The Reply function appends formatted text to the response to the
+    current control request.  A response which does not fit in
+    MAX_CONTROL_RESPONSE is truncated.
+
+@param[in]
+    format
+        printf style format of the text
+
+@param[in]
+    ...
+        text arguments
+
+==============================================================================*/
+static void Reply( const char *format, ... )
+{
+    va_list args;
+    size_t space = sizeof( response.text ) - response.len;
+    int n;
+
+    if ( space > 1 )
+    {
+        va_start( args, format );
+        n = vsnprintf( &response.text[response.len], space, format, args );
+        va_end( args );
+
+        if ( n > 0 )
+        {
+            response.len += ( (size_t)n < space ) ? (size_t)n : space - 1;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  FindAction                                                                */
+/*!
+    Find an action by its number
+
+    The FindAction function finds an action by its position in the
+    actions script, counting from 1, as shown by the list command.
+    Actions are numbered in the order they are loaded, including those
+    from include files and template instances, so the number of an
+    action is unambiguous and does not change until the script does.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    number
+        pointer to the action number text
+
+@retval pointer to the action with the number
+@retval NULL there is no action with the number
+
+==============================================================================*/
+static Action *FindAction( Actions *pActions, char *number )
+{
+    Action *pAction = NULL;
+    char *end = NULL;
+    unsigned long n;
+    unsigned long ordinal;
+
+    n = strtoul( number, &end, 10 );
+    if ( ( end == number ) || ( *end != '\0' ) || ( n == 0 ) )
+    {
+        Reply( "error: invalid action number: %s\n", number );
+    }
+    else
+    {
+        for ( pAction = pActions->pActionList, ordinal = 1;
+              ( pAction != NULL ) && ( ordinal < n );
+              pAction = pAction->pNext, ordinal++ );
+
+        if ( pAction == NULL )
+        {
+            Reply( "error: no action %lu\n", n );
+        }
+    }
+
+    return pAction;
+}
+
+/*============================================================================*/
+/*  ActionNumber                                                              */
+/*!
+    Get the number of an action
+
+    The ActionNumber function gets the position of an action in the
+    actions script, counting from 1, as used by FindAction.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the action
+
+@retval the number of the action
+
+==============================================================================*/
+static unsigned int ActionNumber( Actions *pActions, Action *pAction )
+{
+    Action *p;
+    unsigned int ordinal;
+
+    for ( p = pActions->pActionList, ordinal = 1;
+          ( p != NULL ) && ( p != pAction );
+          p = p->pNext, ordinal++ );
+
+    return ordinal;
+}
+
+/*============================================================================*/
+/*  EnableAction                                                              */
+/*!
+    Enable or disable an action
+
+    The EnableAction function enables or disables the action with the
+    specified number.  A disabled action is skipped whenever it is
+    triggered, as if its guard was not satisfied.  Calc actions cannot
+    be disabled, since a calc request must always be answered.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    number
+        pointer to the action number text
+
+@param[in]
+    enable
+        true to enable the action, false to disable it
+
+==============================================================================*/
+static void EnableAction( Actions *pActions, char *number, bool enable )
+{
+    Action *pAction = FindAction( pActions, number );
+
+    if ( ( pAction != NULL ) && ( pAction->signal == CALC_NOTIFICATION ) )
+    {
+        Reply( "error: action %u is a calc action\n",
+               ActionNumber( pActions, pAction ) );
+    }
+    else if ( pAction != NULL )
+    {
+        pAction->disabled = ( enable == false );
+        Reply( "action %u %s\n",
+               ActionNumber( pActions, pAction ),
+               ( enable == true ) ? "enabled" : "disabled" );
+    }
+}
+
+/*============================================================================*/
+/*  EnableTrigger                                                             */
+/*!
+    Enable or disable the change trigger of a variable
+
+    The EnableTrigger function enables or disables the change
+    notifications of a system variable as an action trigger.  The
+    notifications of a disabled trigger are still received, so the
+    aggregates, caches and guards which use the variable stay current,
+    but the actions triggered by it are not run.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    name
+        pointer to the name of the system variable
+
+@param[in]
+    enable
+        true to enable the triggers, false to disable them
+
+==============================================================================*/
+static void EnableTrigger( Actions *pActions, char *name, bool enable )
+{
+    VAR_HANDLE hVar;
+    DispatchUnit *pUnit;
+
+    hVar = VAR_FindByName( pActions->hVarServer, name );
+    if ( hVar == VAR_INVALID )
+    {
+        Reply( "error: variable not found: %s\n", name );
+        return;
+    }
+
+    pUnit = FindDispatchUnit( pActions, VAR_NOTIFICATION, (int)hVar );
+    if ( pUnit == NULL )
+    {
+        Reply( "error: no actions are triggered by %s\n", name );
+    }
+    else
+    {
+        pUnit->disabled = ( enable == false );
+        Reply( "trigger %s %s\n",
+               name,
+               ( enable == true ) ? "enabled" : "disabled" );
+    }
+}
+
+/*============================================================================*/
+/*  SetPeriod                                                                 */
+/*!
+    Change the interval of an every action
+
+    The SetPeriod function changes the repeat interval of the timer of
+    the every action with the specified number.  The new interval
+    takes effect immediately, and lasts until the engine is restarted.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    number
+        pointer to the action number text
+
+@param[in]
+    interval
+        pointer to the new interval in milliseconds
+
+==============================================================================*/
+static void SetPeriod( Actions *pActions, char *number, char *interval )
+{
+    Action *pAction = FindAction( pActions, number );
+    char *end = NULL;
+    uint64_t ms;
+    int rc;
+
+    if ( pAction == NULL )
+    {
+        return;
+    }
+
+    ms = strtoull( interval, &end, 10 );
+    if ( ( end == interval ) || ( *end != '\0' ) || ( ms == 0 ) )
+    {
+        Reply( "error: invalid interval: %s\n", interval );
+        return;
+    }
+
+    if ( ( pAction->signal != TIMER_NOTIFICATION ) ||
+         ( GetTickPeriod( pAction->timerID ) == 0 ) )
+    {
+        Reply( "error: action %u is not an every action\n",
+               ActionNumber( pActions, pAction ) );
+        return;
+    }
+
+    rc = SetTickPeriod( pAction->timerID, ms );
+    if ( rc == EOK )
+    {
+        Reply( "action %u period %" PRIu64 " ms\n",
+               ActionNumber( pActions, pAction ),
+               ms );
+    }
+    else
+    {
+        Reply( "error: %s\n", strerror( rc ) );
+    }
+}
+
+/*============================================================================*/
+/*  ListActions                                                               */
+/*!
+    List the loaded actions
+
+    The ListActions function adds a line for each loaded action to the
+    response, containing its number, the line it was declared at, its
+    trigger type, state, priority, and execution statistics.  Execution times are in
+    microseconds.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+==============================================================================*/
+static void ListActions( Actions *pActions )
+{
+    Action *pAction;
+    uint64_t period;
+    unsigned int ordinal;
+
+    for ( pAction = pActions->pActionList, ordinal = 1;
+          pAction != NULL;
+          pAction = pAction->pNext, ordinal++ )
+    {
+        Reply( "action %u line %d %s %s priority %d runs %" PRIu64
+               " avg %" PRIu64 " max %" PRIu64 " overruns %" PRIu64,
+               ordinal,
+               pAction->lineno,
+               ActionKind( pAction ),
+               ( pAction->disabled == true ) ? "disabled" : "enabled",
+               pAction->priority,
+               pAction->runs,
+               ( pAction->runs > 0 ) ? pAction->totalTime / pAction->runs
+                                     : 0,
+               pAction->maxTime,
+               pAction->overruns );
+
+        period = ( pAction->signal == TIMER_NOTIFICATION )
+                    ? GetTickPeriod( pAction->timerID )
+                    : 0;
+        if ( period != 0 )
+        {
+            Reply( " period %" PRIu64, period );
+        }
+
+        Reply( "\n" );
+    }
+}
+
+/*============================================================================*/
+/*  DumpState                                                                 */
+/*!
+    Dump the state of the actions engine
+
+    The DumpState function adds the engine's event counters, the list
+    of actions, the values of their static variables, and the disabled
+    triggers to the response.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+==============================================================================*/
+static void DumpState( Actions *pActions )
+{
+    Action *pAction;
+    StaticVar *pStatic;
+    DispatchUnit *pUnit;
+    char value[MAX_CACHED_STRING_LEN];
+    unsigned int ordinal;
+    size_t i;
+
+    Reply( "pending %zu shed %" PRIu64 " overruns %" PRIu64 "\n",
+           PendingEvents(),
+           pActions->shedCount,
+           pActions->overruns );
+
+    ListActions( pActions );
+
+    for ( pAction = pActions->pActionList, ordinal = 1;
+          pAction != NULL;
+          pAction = pAction->pNext, ordinal++ )
+    {
+        for ( pStatic = pAction->pStatics;
+              pStatic != NULL;
+              pStatic = pStatic->pNext )
+        {
+            FormatValue( &pStatic->value, value, sizeof( value ) );
+            Reply( "action %u static %s = %s\n",
+                   ordinal,
+                   ( pStatic->pVariable->id != NULL ) ? pStatic->pVariable->id
+                                                      : "?",
+                   value );
+        }
+    }
+
+    for ( i = 0;
+          ( pActions->ppUnits != NULL ) && ( i < pActions->numBuckets );
+          i++ )
+    {
+        for ( pUnit = pActions->ppUnits[i];
+              pUnit != NULL;
+              pUnit = pUnit->pNext )
+        {
+            if ( pUnit->disabled == true )
+            {
+                Reply( "trigger %s disabled\n", TriggerName( pUnit ) );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ActionKind                                                                */
+/*!
+    Get the trigger type of an action
+
+    The ActionKind function gets the name of the type of event which
+    triggers an action.
+
+@param[in]
+    pAction
+        pointer to the action
+
+@retval name of the trigger type
+
+==============================================================================*/
+static const char *ActionKind( Action *pAction )
+{
+    if ( pAction->signal == VAR_NOTIFICATION )
+    {
+        return "change";
+    }
+    else if ( pAction->signal == CALC_NOTIFICATION )
+    {
+        return "calc";
+    }
+    else if ( pAction->signal == NO_NOTIFICATION )
+    {
+        return "init";
+    }
+
+    return ( GetTickPeriod( pAction->timerID ) != 0 ) ? "every" : "at";
+}
+
+/*============================================================================*/
+/*  TriggerName                                                               */
+/*!
+    Get the name of the variable of a trigger
+
+    The TriggerName function gets the name of the system variable whose
+    notifications trigger the actions of a dispatch unit, from the
+    signals of the unit's first action.
+
+@param[in]
+    pUnit
+        pointer to the dispatch unit
+
+@retval name of the trigger variable
+@retval "?" the name is not known
+
+==============================================================================*/
+static const char *TriggerName( DispatchUnit *pUnit )
+{
+    Signal *pSignal;
+
+    if ( pUnit->count > 0 )
+    {
+        for ( pSignal = pUnit->ppActions[0]->pSignals;
+              pSignal != NULL;
+              pSignal = pSignal->pNext )
+        {
+            if ( ( pSignal->id == pUnit->id ) &&
+                 ( pSignal->pVariable != NULL ) &&
+                 ( pSignal->pVariable->id != NULL ) )
+            {
+                return pSignal->pVariable->id;
+            }
+        }
+    }
+
+    return "?";
+}
+
+/*============================================================================*/
+/*  FormatValue                                                               */
+/*!
+    Format a variable value as text
+
+    The FormatValue function writes the value of a variable object
+    into a text buffer.
+
+@param[in]
+    pObj
+        pointer to the variable object
+
+@param[out]
+    buf
+        pointer to the text buffer
+
+@param[in]
+    len
+        size of the text buffer
+
+==============================================================================*/
+static void FormatValue( VarObject *pObj, char *buf, size_t len )
+{
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            snprintf( buf, len, "%u", pObj->val.ui );
+            break;
+
+        case VARTYPE_INT16:
+            snprintf( buf, len, "%d", pObj->val.i );
+            break;
+
+        case VARTYPE_UINT32:
+            snprintf( buf, len, "%" PRIu32, pObj->val.ul );
+            break;
+
+        case VARTYPE_INT32:
+            snprintf( buf, len, "%" PRId32, pObj->val.l );
+            break;
+
+        case VARTYPE_UINT64:
+            snprintf( buf, len, "%" PRIu64, pObj->val.ull );
+            break;
+
+        case VARTYPE_INT64:
+            snprintf( buf, len, "%" PRId64, pObj->val.ll );
+            break;
+
+        case VARTYPE_FLOAT:
+            snprintf( buf, len, "%f", pObj->val.f );
+            break;
+
+        case VARTYPE_STR:
+            snprintf( buf, len, "\"%s\"",
+                      ( pObj->val.str != NULL ) ? pObj->val.str : "" );
+            break;
+
+        default:
+            snprintf( buf, len, "?" );
+            break;
+    }
+}
+
+/*! @}
+ * end of control group */
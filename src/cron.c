@@ -0,0 +1,504 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup cron cron
+ * @brief Cron style calendar schedules
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file cron.c
+
+    Cron Schedules
+
+    The cron component parses calendar schedules and calculates
+    the next local time at which a schedule fires.
+
+    - parse five field cron expressions
+    - parse HH:MM times of day
+    - calculate the next firing time of a schedule
+
+    A cron expression has five whitespace separated fields:
+
+    minute (0-59) hour (0-23) day-of-month (1-31) month (1-12)
+    day-of-week (0-7, where 0 and 7 are Sunday)
+
+    Each field is a comma separated list of items, where each item
+    is *, a value, or a range a-b, optionally followed by a /step.
+    As with cron, when both the day of the month and the day of the
+    week are restricted, the schedule fires on days matching either.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include "cron.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! maximum number of calendar steps taken to find the next firing time.
+    This bounds the search for schedules which never fire, such as
+    the 30th of February */
+#define MAX_CRON_STEPS ( 20000 )
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int ParseField( const char **ppSpec,
+                       int min,
+                       int max,
+                       uint64_t *pBits,
+                       bool *pRestricted );
+static int ParseValue( const char **ppSpec, int min, int max, int *pValue );
+static bool DayMatches( CronSpec *pSpec, struct tm *pTm );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseCron                                                                 */
+/*!
+    Parse a cron expression
+
+    The ParseCron function parses a five field cron expression
+    into a calendar schedule
+
+@param[in]
+    spec
+        pointer to the cron expression
+
+@param[in,out]
+    pSpec
+        pointer to the calendar schedule to populate
+
+@retval EOK the cron expression was parsed
+@retval EINVAL invalid cron expression
+
+==============================================================================*/
+int ParseCron( const char *spec, CronSpec *pSpec )
+{
+    int result = EINVAL;
+    uint64_t bits[5];
+    bool restricted[5];
+
+    if ( ( spec != NULL ) && ( pSpec != NULL ) )
+    {
+        if ( ( ParseField( &spec, 0, 59, &bits[0], &restricted[0] ) == EOK ) &&
+             ( ParseField( &spec, 0, 23, &bits[1], &restricted[1] ) == EOK ) &&
+             ( ParseField( &spec, 1, 31, &bits[2], &restricted[2] ) == EOK ) &&
+             ( ParseField( &spec, 1, 12, &bits[3], &restricted[3] ) == EOK ) &&
+             ( ParseField( &spec, 0, 7, &bits[4], &restricted[4] ) == EOK ) )
+        {
+            while ( isspace( (unsigned char)*spec ) )
+            {
+                spec++;
+            }
+
+            if ( *spec == '\0' )
+            {
+                /* Sunday may be specified as 0 or 7 */
+                if ( bits[4] & ( 1 << 7 ) )
+                {
+                    bits[4] |= 1;
+                }
+
+                memset( pSpec, 0, sizeof( CronSpec ) );
+                pSpec->minutes = bits[0];
+                pSpec->hours = (uint32_t)bits[1];
+                pSpec->days = (uint32_t)bits[2];
+                pSpec->months = (uint16_t)bits[3];
+                pSpec->weekdays = (uint8_t)( bits[4] & 0x7F );
+                pSpec->restrictDays = restricted[2];
+                pSpec->restrictWeekdays = restricted[4];
+
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseTimeOfDay                                                            */
+/*!
+    Parse a time of day
+
+    The ParseTimeOfDay function parses a HH:MM time of day into a
+    calendar schedule which fires once a day at that local time.
+
+@param[in]
+    spec
+        pointer to the time of day
+
+@param[in,out]
+    pSpec
+        pointer to the calendar schedule to populate
+
+@retval EOK the time of day was parsed
+@retval EINVAL invalid time of day
+
+==============================================================================*/
+int ParseTimeOfDay( const char *spec, CronSpec *pSpec )
+{
+    int result = EINVAL;
+    int hour;
+    int minute;
+
+    if ( ( spec != NULL ) && ( pSpec != NULL ) )
+    {
+        if ( ( ParseValue( &spec, 0, 23, &hour ) == EOK ) &&
+             ( *spec++ == ':' ) &&
+             ( ParseValue( &spec, 0, 59, &minute ) == EOK ) &&
+             ( *spec == '\0' ) )
+        {
+            memset( pSpec, 0, sizeof( CronSpec ) );
+            pSpec->minutes = (uint64_t)1 << minute;
+            pSpec->hours = (uint32_t)1 << hour;
+            pSpec->days = 0xFFFFFFFE;
+            pSpec->months = 0x1FFE;
+            pSpec->weekdays = 0x7F;
+
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NextCron                                                                  */
+/*!
+    Get the next firing time of a calendar schedule
+
+    The NextCron function calculates the first minute after the
+    specified time which matches the calendar schedule, in local time.
+
+@param[in]
+    pSpec
+        pointer to the calendar schedule
+
+@param[in]
+    after
+        the time after which to search
+
+@retval the next firing time of the schedule
+@retval (time_t)-1 if the schedule never fires
+
+==============================================================================*/
+time_t NextCron( CronSpec *pSpec, time_t after )
+{
+    struct tm tm;
+    time_t t;
+    int i;
+
+    if ( pSpec == NULL )
+    {
+        return (time_t)-1;
+    }
+
+    /* start at the next whole minute */
+    localtime_r( &after, &tm );
+    tm.tm_sec = 0;
+    tm.tm_min++;
+    tm.tm_isdst = -1;
+    t = mktime( &tm );
+
+    for ( i = 0; ( i < MAX_CRON_STEPS ) && ( t != (time_t)-1 ); i++ )
+    {
+        localtime_r( &t, &tm );
+
+        if ( ( pSpec->months & ( 1 << ( tm.tm_mon + 1 ) ) ) == 0 )
+        {
+            /* skip to the start of the next month */
+            tm.tm_mon++;
+            tm.tm_mday = 1;
+            tm.tm_hour = 0;
+            tm.tm_min = 0;
+        }
+        else if ( DayMatches( pSpec, &tm ) == false )
+        {
+            /* skip to the start of the next day */
+            tm.tm_mday++;
+            tm.tm_hour = 0;
+            tm.tm_min = 0;
+        }
+        else if ( ( pSpec->hours & ( 1 << tm.tm_hour ) ) == 0 )
+        {
+            /* skip to the start of the next hour */
+            tm.tm_hour++;
+            tm.tm_min = 0;
+        }
+        else if ( ( pSpec->minutes & ( (uint64_t)1 << tm.tm_min ) ) == 0 )
+        {
+            tm.tm_min++;
+        }
+        else
+        {
+            return t;
+        }
+
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        t = mktime( &tm );
+    }
+
+    return (time_t)-1;
+}
+
+/*============================================================================*/
+/*  ParseField                                                                */
+/*!
+    Parse a cron expression field
+
+    The ParseField function parses one whitespace separated field of
+    a cron expression into a bit mask of the values it selects.
+
+@param[in,out]
+    ppSpec
+        pointer to the cron expression pointer, which is advanced
+        past the field
+
+@param[in]
+    min
+        minimum value of the field
+
+@param[in]
+    max
+        maximum value of the field
+
+@param[in,out]
+    pBits
+        pointer to the bit mask to populate
+
+@param[in,out]
+    pRestricted
+        set to false if the field is *, true otherwise
+
+@retval EOK the field was parsed
+@retval EINVAL invalid field
+
+==============================================================================*/
+static int ParseField( const char **ppSpec,
+                       int min,
+                       int max,
+                       uint64_t *pBits,
+                       bool *pRestricted )
+{
+    const char *p = *ppSpec;
+    int first;
+    int last;
+    int step;
+    int value;
+
+    *pBits = 0;
+    *pRestricted = true;
+
+    while ( isspace( (unsigned char)*p ) )
+    {
+        p++;
+    }
+
+    if ( ( p[0] == '*' ) &&
+         ( ( p[1] == '\0' ) || isspace( (unsigned char)p[1] ) ) )
+    {
+        *pRestricted = false;
+    }
+
+    do
+    {
+        if ( *p == '*' )
+        {
+            p++;
+            first = min;
+            last = max;
+        }
+        else if ( ParseValue( &p, min, max, &first ) == EOK )
+        {
+            last = first;
+            if ( *p == '-' )
+            {
+                p++;
+                if ( ( ParseValue( &p, first, max, &last ) != EOK ) )
+                {
+                    return EINVAL;
+                }
+            }
+        }
+        else
+        {
+            return EINVAL;
+        }
+
+        step = 1;
+        if ( *p == '/' )
+        {
+            p++;
+            if ( ParseValue( &p, 1, max, &step ) != EOK )
+            {
+                return EINVAL;
+            }
+        }
+
+        for ( value = first; value <= last; value += step )
+        {
+            *pBits |= (uint64_t)1 << value;
+        }
+
+    } while ( *p++ == ',' );
+
+    p--;
+    if ( ( *p != '\0' ) && ( !isspace( (unsigned char)*p ) ) )
+    {
+        return EINVAL;
+    }
+
+    *ppSpec = p;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ParseValue                                                                */
+/*!
+    Parse a decimal value
+
+    The ParseValue function parses a decimal value and checks that
+    it is within the specified range
+
+@param[in,out]
+    ppSpec
+        pointer to the string pointer, which is advanced past the value
+
+@param[in]
+    min
+        minimum allowed value
+
+@param[in]
+    max
+        maximum allowed value
+
+@param[in,out]
+    pValue
+        pointer to the location to store the value
+
+@retval EOK the value was parsed
+@retval EINVAL no value, or the value is out of range
+
+==============================================================================*/
+static int ParseValue( const char **ppSpec, int min, int max, int *pValue )
+{
+    const char *p = *ppSpec;
+    int value = 0;
+
+    if ( !isdigit( (unsigned char)*p ) )
+    {
+        return EINVAL;
+    }
+
+    while ( isdigit( (unsigned char)*p ) )
+    {
+        value = value * 10 + ( *p++ - '0' );
+        if ( value > max )
+        {
+            return EINVAL;
+        }
+    }
+
+    if ( value < min )
+    {
+        return EINVAL;
+    }
+
+    *pValue = value;
+    *ppSpec = p;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  DayMatches                                                                */
+/*!
+    Check if a day matches a calendar schedule
+
+    The DayMatches function checks the day of the month and the day
+    of the week against the calendar schedule.  When both are
+    restricted, a day matching either one matches the schedule.
+
+@param[in]
+    pSpec
+        pointer to the calendar schedule
+
+@param[in]
+    pTm
+        pointer to the broken down local time
+
+@retval true the day matches the schedule
+@retval false the day does not match the schedule
+
+==============================================================================*/
+static bool DayMatches( CronSpec *pSpec, struct tm *pTm )
+{
+    bool day = ( pSpec->days & ( (uint32_t)1 << pTm->tm_mday ) ) != 0;
+    bool weekday = ( pSpec->weekdays & ( 1 << pTm->tm_wday ) ) != 0;
+
+    if ( pSpec->restrictDays && pSpec->restrictWeekdays )
+    {
+        return day || weekday;
+    }
+    else if ( pSpec->restrictDays )
+    {
+        return day;
+    }
+    else if ( pSpec->restrictWeekdays )
+    {
+        return weekday;
+    }
+
+    return true;
+}
+
+/*! @}
+ * end of cron group */
@@ -0,0 +1,528 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup dispatch dispatch
+ * @brief Signal dispatch table
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file dispatch.c
+
+    Signal Dispatch Table
+
+    The dispatch component indexes the actions by their triggers, so
+    the actions engine can find all the actions triggered by a signal
+    with a single hash table lookup, instead of searching the signal
+    lists of every action on every signal.
+
+    - build the dispatch units when the script is loaded
+    - find the dispatch unit of a received signal
+    - check which units can share one read snapshot
+
+    Each dispatch unit is keyed by the signal number and the signal
+    identifier: the variable handle for change and calc notifications,
+    and the timer id for timer notifications.  The actions of a unit
+    are kept in declaration order.  The priority levels of a unit's
+    actions, and the shortest deadline at each level, are precalculated
+    so a signal can be queued as one event per priority level.
+
+    The actions of a unit are still evaluated one after another.  When
+    none of them writes a system variable which a later action of the
+    unit reads, writes or reduces, the unit is marked as shared, and the
+    engine waits for the queued writes and fetches the variable sets
+    once for the whole unit, instead of once for each action.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "dispatch.h"
+#include "timer.h"
+#include "scheduler.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int AddToUnit( Actions *pActions, int signum, int id, Action *pAction );
+static size_t Bucket( Actions *pActions, int signum, int id );
+static bool SharedReads( DispatchUnit *pUnit );
+static bool UsesVariable( Action *pAction, VAR_HANDLE hVar );
+static bool InSet( VarSet *pSet, VAR_HANDLE hVar );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  BuildDispatchTable                                                        */
+/*!
+    Build the dispatch table
+
+    The BuildDispatchTable function creates a dispatch unit for each
+    distinct trigger of the actions, containing all the actions
+    triggered by it in declaration order, and checks which units can
+    share one read snapshot.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the dispatch table was built
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int BuildDispatchTable( Actions *pActions )
+{
+    int result = EINVAL;
+    Action *pAction;
+    Signal *pSignal;
+    DispatchUnit *pUnit;
+    size_t n = 0;
+    size_t buckets = MIN_DISPATCH_BUCKETS;
+    size_t i;
+    int rc;
+
+    if ( pActions != NULL )
+    {
+        /* count the triggers to size the hash table */
+        for ( pAction = pActions->pActionList;
+              pAction != NULL;
+              pAction = pAction->pNext )
+        {
+            n++;
+            for ( pSignal = pAction->pSignals;
+                  pSignal != NULL;
+                  pSignal = pSignal->pNext )
+            {
+                n++;
+            }
+        }
+
+        while ( buckets < 2 * n )
+        {
+            buckets *= 2;
+        }
+
+        pActions->ppUnits = (DispatchUnit **)calloc( buckets,
+                                                     sizeof( DispatchUnit * ) );
+        if ( pActions->ppUnits == NULL )
+        {
+            return ENOMEM;
+        }
+
+        pActions->numBuckets = buckets;
+
+        result = EOK;
+
+        for ( pAction = pActions->pActionList;
+              pAction != NULL;
+              pAction = pAction->pNext )
+        {
+            if ( pAction->signal == TIMER_NOTIFICATION )
+            {
+                if ( pAction->timerID > 0 )
+                {
+                    rc = AddToUnit( pActions,
+                                    pAction->signal,
+                                    pAction->timerID,
+                                    pAction );
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+                }
+
+                continue;
+            }
+
+            for ( pSignal = pAction->pSignals;
+                  pSignal != NULL;
+                  pSignal = pSignal->pNext )
+            {
+                rc = AddToUnit( pActions,
+                                pAction->signal,
+                                pSignal->id,
+                                pAction );
+                if ( rc != EOK )
+                {
+                    result = rc;
+                }
+            }
+        }
+
+        for ( i = 0; i < pActions->numBuckets; i++ )
+        {
+            for ( pUnit = pActions->ppUnits[i];
+                  pUnit != NULL;
+                  pUnit = pUnit->pNext )
+            {
+                pUnit->shared = SharedReads( pUnit );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindDispatchUnit                                                          */
+/*!
+    Find the dispatch unit of a signal
+
+    The FindDispatchUnit function looks up the dispatch unit containing
+    the actions triggered by the specified signal
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    signum
+        signal number
+
+@param[in]
+    id
+        signal identifier
+
+@retval pointer to the dispatch unit of the signal
+@retval NULL no actions are triggered by the signal
+
+==============================================================================*/
+DispatchUnit *FindDispatchUnit( Actions *pActions, int signum, int id )
+{
+    DispatchUnit *pUnit = NULL;
+
+    if ( ( pActions != NULL ) && ( pActions->ppUnits != NULL ) )
+    {
+        pUnit = pActions->ppUnits[Bucket( pActions, signum, id )];
+        while ( pUnit != NULL )
+        {
+            if ( ( pUnit->signum == signum ) && ( pUnit->id == id ) )
+            {
+                break;
+            }
+
+            pUnit = pUnit->pNext;
+        }
+    }
+
+    return pUnit;
+}
+
+/*============================================================================*/
+/*  AddToUnit                                                                 */
+/*!
+    Add an action to a dispatch unit
+
+    The AddToUnit function appends an action to the dispatch unit of
+    the specified trigger, creating the unit if it does not exist.
+    An action is added to a unit at most once.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    signum
+        signal number of the trigger
+
+@param[in]
+    id
+        signal identifier of the trigger
+
+@param[in]
+    pAction
+        pointer to the action to add
+
+@retval EOK the action was added
+@retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int AddToUnit( Actions *pActions, int signum, int id, Action *pAction )
+{
+    DispatchUnit *pUnit;
+    Action **ppActions;
+    size_t bucket;
+    size_t i;
+    int level;
+
+    pUnit = FindDispatchUnit( pActions, signum, id );
+    if ( pUnit == NULL )
+    {
+        pUnit = (DispatchUnit *)calloc( 1, sizeof( DispatchUnit ) );
+        if ( pUnit == NULL )
+        {
+            return ENOMEM;
+        }
+
+        pUnit->signum = signum;
+        pUnit->id = id;
+
+        bucket = Bucket( pActions, signum, id );
+        pUnit->pNext = pActions->ppUnits[bucket];
+        pActions->ppUnits[bucket] = pUnit;
+    }
+
+    for ( i = 0; i < pUnit->count; i++ )
+    {
+        if ( pUnit->ppActions[i] == pAction )
+        {
+            return EOK;
+        }
+    }
+
+    ppActions = (Action **)realloc( pUnit->ppActions,
+                                    ( pUnit->count + 1 ) * sizeof( Action * ) );
+    if ( ppActions == NULL )
+    {
+        return ENOMEM;
+    }
+
+    ppActions[pUnit->count++] = pAction;
+    pUnit->ppActions = ppActions;
+
+    level = pAction->priority - MIN_PRIORITY;
+    pUnit->levels |= ( 1U << level );
+
+    if ( ( pAction->deadline != 0 ) &&
+         ( ( pUnit->deadlines[level] == 0 ) ||
+           ( pAction->deadline < pUnit->deadlines[level] ) ) )
+    {
+        pUnit->deadlines[level] = pAction->deadline;
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  SharedReads                                                               */
+/*!
+    Check if the actions of a dispatch unit can share their reads
+
+    The SharedReads function checks that no action of a dispatch unit
+    writes a system variable which a later action of the unit reads,
+    writes, or fetches as part of a variable set, so the later actions
+    see the same values whether they are read before or after the
+    earlier actions run.  Actions which run scripts may write any
+    variable, so they are only shared when no action follows them.
+
+@param[in]
+    pUnit
+        pointer to the dispatch unit
+
+@retval true the actions can share one read snapshot
+@retval false some action uses a variable written by an earlier action
+
+==============================================================================*/
+static bool SharedReads( DispatchUnit *pUnit )
+{
+    bool shared = true;
+    Action *pAction;
+    Statement *pStatement;
+    VarRef *pWrite;
+    size_t i;
+    size_t j;
+
+    for ( i = 0; ( shared == true ) && ( i + 1 < pUnit->count ); i++ )
+    {
+        pAction = pUnit->ppActions[i];
+
+        for ( pStatement = pAction->pStatements;
+              pStatement != NULL;
+              pStatement = pStatement->pNext )
+        {
+            if ( pStatement->script != NULL )
+            {
+                shared = false;
+            }
+        }
+
+        for ( pWrite = pAction->pWrites;
+              ( shared == true ) && ( pWrite != NULL );
+              pWrite = pWrite->pNext )
+        {
+            for ( j = i + 1; ( shared == true ) && ( j < pUnit->count ); j++ )
+            {
+                if ( UsesVariable( pUnit->ppActions[j],
+                                   pWrite->hVar ) == true )
+                {
+                    shared = false;
+                }
+            }
+        }
+    }
+
+    return shared;
+}
+
+/*============================================================================*/
+/*  UsesVariable                                                              */
+/*!
+    Check if an action uses a system variable
+
+@param[in]
+    pAction
+        pointer to the action
+
+@param[in]
+    hVar
+        handle of the system variable
+
+@retval true the action reads or writes the variable, or fetches it
+        as part of a variable set
+@retval false the action does not use the variable
+
+==============================================================================*/
+static bool UsesVariable( Action *pAction, VAR_HANDLE hVar )
+{
+    VarRef *pRef;
+    Reduction *pReduction;
+    Loop *pLoop;
+
+    for ( pRef = pAction->pReads; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( pRef->hVar == hVar )
+        {
+            return true;
+        }
+    }
+
+    for ( pRef = pAction->pWrites; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( pRef->hVar == hVar )
+        {
+            return true;
+        }
+    }
+
+    for ( pReduction = pAction->pReductions;
+          pReduction != NULL;
+          pReduction = pReduction->pNext )
+    {
+        if ( InSet( pReduction->pSet, hVar ) == true )
+        {
+            return true;
+        }
+    }
+
+    for ( pLoop = pAction->pLoops; pLoop != NULL; pLoop = pLoop->pNext )
+    {
+        if ( InSet( pLoop->pSet, hVar ) == true )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  InSet                                                                     */
+/*!
+    Check if a variable set contains a system variable
+
+@param[in]
+    pSet
+        pointer to the variable set
+
+@param[in]
+    hVar
+        handle of the system variable
+
+@retval true the set contains the variable
+@retval false the set does not contain the variable
+
+==============================================================================*/
+static bool InSet( VarSet *pSet, VAR_HANDLE hVar )
+{
+    size_t i;
+
+    for ( i = 0; ( pSet != NULL ) && ( i < pSet->count ); i++ )
+    {
+        if ( pSet->pHandles[i] == hVar )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  Bucket                                                                    */
+/*!
+    Get the hash bucket of a trigger
+
+    The Bucket function calculates the dispatch table hash bucket
+    of a signal number and identifier
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    signum
+        signal number
+
+@param[in]
+    id
+        signal identifier
+
+@retval index of the hash bucket
+
+==============================================================================*/
+static size_t Bucket( Actions *pActions, int signum, int id )
+{
+    uint32_t hash = (uint32_t)id * 2654435761U;
+
+    hash ^= (uint32_t)signum;
+
+    /* the number of buckets is a power of two */
+    return hash & ( pActions->numBuckets - 1 );
+}
+
+/*! @}
+ * end of dispatch group */
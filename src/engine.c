@@ -41,7 +41,21 @@ SOFTWARE.
 
     - wait for signals
     - evaluate Action execution rules
-    - manage timers
+    - manage timers and re-arm wall clock schedules
+    - propagate derived values between actions in dependency order
+    - cache calc results
+    - dispatch pending events by priority and deadline
+    - look up the actions triggered by a signal in the dispatch table
+    - shed low priority events and resynchronize under overload
+    - enforce action execution budgets
+    - maintain streaming window aggregates
+    - bind the triggering variable of wildcard actions
+    - keep and checkpoint static local variables
+    - run the string builders which replace string assignments
+    - start and cancel the one-shot timers of after blocks
+    - skip actions whose when guards are not satisfied
+    - save and restore engine state snapshots for warm restarts
+    - order queued variable writes with the actions which use them
 
 
 */
@@ -61,25 +75,109 @@ SOFTWARE.
 #include <unistd.h>
 #include <stdbool.h>
 #include <errno.h>
-#include <syslog.h>
+#include <time.h>
 #include "actiontypes.h"
 #include "actions.tab.h"
 #include "timer.h"
+#include "scheduler.h"
+#include "watchdog.h"
+#include "dispatch.h"
+#include "guard.h"
+#include "condition.h"
+#include "varset.h"
+#include "log.h"
+#include "control.h"
+#include "snapshot.h"
+#include "writer.h"
 #include <varaction/varaction.h>
 
 /*==============================================================================
        Function declarations
 ==============================================================================*/
 
-static int waitSignal( int *signum, int *id );
-static int HandleSignal( Actions *pActions, int signum, int id );
+static int waitSignal( int *signum, int *id, bool wait );
+static void CollectSignals( Actions *pActions );
+static int QueueEvent( Actions *pActions, int signum, int id );
+static int QueueLevel( Actions *pActions,
+                       int signum,
+                       int id,
+                       int priority,
+                       uint64_t deadline );
+static int HandleSignal( Actions *pActions, int signum, int id, int priority );
 static int ProcessAction( Actions *pActions, Action *pAction );
 static int RunInitActions( Actions *pActions );
+static int BuildDependencyGraph( Actions *pActions );
+static bool HasReference( VarRef *pRef, VAR_HANDLE hVar );
+static bool IsTriggeredBy( Action *pAction, VAR_HANDLE hVar );
+static Signal *FindSignal( Action *pAction, VAR_HANDLE hVar );
+static int HandleCalc( Actions *pActions, Action *pAction, Signal *pSignal );
+static bool CacheHit( Actions *pActions, Action *pAction, Signal *pSignal );
+static void UpdateCache( Actions *pActions, Signal *pSignal );
+static void InvalidateCaches( Actions *pActions, VAR_HANDLE hVar );
+static uint64_t ElapsedMs( struct timespec *pStart );
+static int Propagate( Actions *pActions );
+static void ExpectEcho( Actions *pActions, Action *pAction );
+static bool Covered( DispatchUnit *pUnit, Action *pAction );
+static bool IsEcho( Actions *pActions, VAR_HANDLE hVar );
+static void ClearEchoes( Actions *pActions );
+static bool SameValue( VarObject *pObj1, VarObject *pObj2 );
+static bool ShedEvent( Actions *pActions, Event *pEvent );
+static bool SignalQueueSaturated( void );
+static void Overload( Actions *pActions, const char *reason );
+static int Resync( Actions *pActions );
+static bool WatchChanged( Actions *pActions, Watch *pWatch );
+static uint64_t ElapsedUs( struct timespec *pStart );
+static void Overrun( Actions *pActions, Action *pAction, uint64_t elapsed );
+static void PublishMetric( Actions *pActions,
+                           const char *name,
+                           VarObject *pObj );
+static void FeedAggregates( Actions *pActions, VAR_HANDLE hVar );
+static void RefreshAggregates( Action *pAction );
+static bool ToDouble( VarObject *pObj, double *pValue );
+static uint64_t NowMs( void );
+static void BindTrigger( Action *pAction, VAR_HANDLE hVar );
+static void RestoreStatics( Action *pAction );
+static void SaveStatics( Action *pAction );
+static int StartCheckpoints( Actions *pActions );
+static void LoadCheckpoints( Actions *pActions );
+static void Checkpoint( Actions *pActions );
+static bool ConvertValue( VarObject *pFrom, VarObject *pTo );
+static int RunDelay( Action *pAction, Delay *pDelay );
+static void RefreshReductions( Actions *pActions, Action *pAction );
+static int RunLoop( Actions *pActions, Loop *pLoop );
+static int RunStatement( Actions *pActions, Statement *pStatement );
+static int RunAssignment( Actions *pActions, QueuedAssignment *pAssignment );
+static DispatchUnit *ActiveUnit( Actions *pActions, int signum, int id );
+static bool WarmStart( Actions *pActions );
+static bool WritesQueued( Action *pAction );
+static void TakeSnapshot( DispatchUnit *pUnit, int priority );
+static bool InSnapshot( Action *pAction );
+static void StopActions( Actions *pActions );
 
 /*==============================================================================
        Definitions
 ==============================================================================*/
 
+/*! number of signals collected at once which triggers a check of
+    the real-time signal queue */
+#define SATURATION_CHECK_BATCH ( 32 )
+
+/*! percentage of the real-time signal queue limit above which
+    the signal queue is considered saturated */
+#define SATURATION_PERCENT ( 90 )
+
+/*! fetch generation of the variable sets, advanced for each action run,
+    or once for the actions of a shared dispatch unit */
+static uint64_t fetchGeneration = 0;
+
+/*! dispatch unit whose actions share the current read snapshot */
+static DispatchUnit *pSnapshot = NULL;
+
+/*! number of change notifications expected from propagated writes */
+static size_t expectedEchoes = 0;
+
+/*! true if termination requests are received by the engine thread */
+static bool catchStop = false;
 
 /*==============================================================================
        Function definitions
@@ -90,7 +188,10 @@ static int RunInitActions( Actions *pActions );
 /*!
     Run the Actions processor
 
-    The RunActions function executes the actions in the program
+    The RunActions function executes the actions in the program.
+    When engine state snapshots or checkpointed static variables are
+    used, it returns after saving them when the engine is asked to
+    terminate.
 
 @param[in]
     pActions
@@ -106,37 +207,125 @@ int RunActions( Actions *pActions )
     int result = EINVAL;
     int signum;
     int id;
+    Event event;
+    Watch *pWatch;
+    bool warm;
 
     if ( pActions != NULL )
     {
-        /* Run the initial actions */
-        (void)RunInitActions( pActions );
+        /* index the actions by their triggers */
+        (void)BuildDispatchTable( pActions );
+
+        /* order the actions for derived value propagation */
+        (void)BuildDependencyGraph( pActions );
+
+        /* read the initial values of the guard inputs */
+        RefreshGuardInputs( pActions->hVarServer );
+
+        /* restore the static variables from their checkpoints */
+        LoadCheckpoints( pActions );
+        (void)StartCheckpoints( pActions );
 
-        /* run the actions processor forever */
-        while( true )
+        /* carry on from the snapshot of a previous instance */
+        warm = WarmStart( pActions );
+
+        /* arm the tick timers, spreading their phases if requested */
+        (void)StartTimers( pActions->stagger );
+
+        if ( warm == true )
         {
-            /* wait for a signal to occur */
-            waitSignal( &signum, &id );
+            /* only run the actions whose inputs changed while
+               the engine was stopped */
+            (void)Resync( pActions );
+        }
+        else
+        {
+            /* Run the initial actions */
+            (void)RunInitActions( pActions );
+
+            /* record the initial values of the watched variables */
+            for ( pWatch = pActions->pWatchList;
+                  pWatch != NULL;
+                  pWatch = pWatch->pNext )
+            {
+                (void)WatchChanged( pActions, pWatch );
+            }
+        }
 
-            if( pActions->verbose )
+        /* run the actions processor until asked to stop */
+        while( pActions->stopping == false )
+        {
+            /* wait for a signal to occur */
+            if ( waitSignal( &signum, &id, true ) == EOK )
             {
-                fprintf( stdout,
-                         "Received signal %d id = %d\n",
-                         signum,
-                         id );
+                (void)QueueEvent( pActions, signum, id );
             }
 
-            /* handle the received signal */
-            result = HandleSignal( pActions, signum, id );
-            if( pActions->verbose )
+            while ( pActions->stopping == false )
             {
-                fprintf( stdout,
-                         "signal %d %d: %s\n",
-                         signum,
-                         id,
-                         strerror(result) );
+                /* queue all other pending signals, so higher priority
+                   events are dispatched ahead of the queued ones */
+                CollectSignals( pActions );
+
+                if ( NextEvent( &event ) != EOK )
+                {
+                    if ( ( expectedEchoes > 0 ) &&
+                         ( WritesIdle() == false ) )
+                    {
+                        /* the notifications of the queued writes have
+                           not been sent yet, so complete the writes and
+                           collect their notifications */
+                        (void)FlushWrites();
+                        continue;
+                    }
+
+                    if ( expectedEchoes > 0 )
+                    {
+                        /* the notifications of the propagated writes
+                           have been handled, so any still expected
+                           were never sent */
+                        ClearEchoes( pActions );
+                    }
+
+                    if ( pActions->resync == true )
+                    {
+                        /* recover change notifications which were lost
+                           or shed while the engine was overloaded */
+                        (void)Resync( pActions );
+                        continue;
+                    }
+
+                    break;
+                }
+
+                if ( LogEnabled( LOGLEVEL_eDEBUG, LOGLEVEL_eDEFAULT ) )
+                {
+                    LogRecord( LOGLEVEL_eDEBUG,
+                               LOGCODE_eSIGNAL,
+                               event.signum,
+                               event.id,
+                               0 );
+                }
+
+                /* handle the received signal */
+                result = HandleSignal( pActions,
+                                       event.signum,
+                                       event.id,
+                                       event.priority );
+                if ( LogEnabled( LOGLEVEL_eDEBUG, LOGLEVEL_eDEFAULT ) )
+                {
+                    /* the log thread formats the result text */
+                    LogRecord( LOGLEVEL_eDEBUG,
+                               LOGCODE_eHANDLED,
+                               event.signum,
+                               event.id,
+                               result );
+                }
             }
         }
+
+        StopActions( pActions );
+        result = EOK;
     }
 
     return result;
@@ -158,14 +347,21 @@ int RunActions( Actions *pActions )
     id
         Pointer to a location to store the signal identifier
 
-@retval 0 signal received successfully
-@retval -1 an error occurred
+@param[in]
+    wait
+        true to block until a signal arrives, false to return
+        immediately if no signal is pending
+
+@retval EOK signal received successfully
+@retval EAGAIN no signal is pending
+@retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int waitSignal( int *signum, int *id )
+static int waitSignal( int *signum, int *id, bool wait )
 {
     sigset_t mask;
     siginfo_t info;
+    struct timespec timeout = { 0, 0 };
     int result = EINVAL;
     int sig;
 
@@ -184,86 +380,232 @@ static int waitSignal( int *signum, int *id )
         /* calc notification */
         sigaddset( &mask, CALC_NOTIFICATION );
 
+        /* control request notification */
+        sigaddset( &mask, CONTROL_NOTIFICATION );
+
+        if ( catchStop == true )
+        {
+            /* termination requests */
+            sigaddset( &mask, SIGTERM );
+            sigaddset( &mask, SIGINT );
+        }
+
         /* apply signal mask */
         sigprocmask( SIG_BLOCK, &mask, NULL );
 
         /* wait for the signal */
-        sig = sigwaitinfo( &mask, &info );
+        if ( wait == true )
+        {
+            sig = sigwaitinfo( &mask, &info );
+        }
+        else
+        {
+            sig = sigtimedwait( &mask, &info, &timeout );
+        }
 
-        /* return the signal information */
-        *signum = sig;
-        *id = info.si_value.sival_int;
+        if ( sig > 0 )
+        {
+            /* return the signal information */
+            *signum = sig;
+            *id = info.si_value.sival_int;
 
-        /* indicate success */
-        result = EOK;
+            /* indicate success */
+            result = EOK;
+        }
+        else
+        {
+            result = EAGAIN;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  RunInitActions                                                            */
+/*  CollectSignals                                                            */
 /*!
-    Run the Init Actions processors
+    Queue all pending signals
 
-    The RunInitActions function iterates through all of the actions
-    and runs any that have the init flag set.
+    The CollectSignals function receives all of the signals which are
+    currently pending without blocking, and queues them as events
+    for priority dispatch.  If a large burst of signals is received,
+    the real-time signal queue is checked for saturation, since
+    change notifications are lost when it overflows.
 
 @param[in]
     pActions
-        Pointer to the Actions to execute
+        Pointer to the Actions object
 
-@retval EOK the actions completed normally
-@retval EINVAL invalid arguments
-@retval other actions error
+@return none
 
 ==============================================================================*/
-static int RunInitActions( Actions *pActions )
+static void CollectSignals( Actions *pActions )
 {
-    int result = EINVAL;
+    int signum;
+    int id;
+    size_t count = 0;
+
+    while ( waitSignal( &signum, &id, false ) == EOK )
+    {
+        (void)QueueEvent( pActions, signum, id );
+        count++;
+    }
+
+    if ( ( count >= SATURATION_CHECK_BATCH ) &&
+         ( SignalQueueSaturated() == true ) )
+    {
+        /* notifications may have been lost */
+        Overload( pActions, "signal queue saturated" );
+    }
+}
+
+/*============================================================================*/
+/*  QueueEvent                                                                */
+/*!
+    Queue a received signal for dispatch
+
+    The QueueEvent function queues a received signal as events.  A
+    change notification or timer expiry is queued as one event for each
+    priority level of the actions it triggers, with the earliest
+    deadline of the actions at that level, so a low priority action is
+    not run at the priority of a higher priority action which shares its
+    trigger.  A calc request is queued as a single event with the
+    highest priority and earliest deadline of its actions, since its
+    client is waiting for all of them.
+
+    The caches, aggregates and guard inputs of a changed variable are
+    updated once per notification when it is received, and the
+    notifications of propagated writes which have already run all of
+    the variable's actions are discarded here.
+
+    Low priority events are shed when the backlog is too large.  If the
+    event queue is full, change notifications are dropped and
+    resynchronized later, and other signals are handled immediately.
+
+@param[in]
+    pActions
+        Pointer to the Actions object
+
+@param[in]
+    signum
+        the type of signal received
+
+@param[in]
+    id
+        the identifier of the signal
+
+@retval EOK the event was queued
+@retval ECANCELED the event was shed
+@retval other the event could not be queued
+
+==============================================================================*/
+static int QueueEvent( Actions *pActions, int signum, int id )
+{
+    int result = EOK;
     int rc;
-    Action *pAction;
+    DispatchUnit *pUnit;
+    uint64_t deadline = 0;
+    int priority = MIN_PRIORITY;
+    int level;
 
-    if ( pActions != NULL )
+    if ( signum == CONTROL_NOTIFICATION )
     {
-        result = EOK;
+        /* control requests are applied between action executions,
+           ahead of the queued events */
+        return HandleControl( pActions );
+    }
 
-        pAction = pActions->pActionList;
-        while ( pAction != NULL )
+    if ( ( signum == SIGTERM ) || ( signum == SIGINT ) )
+    {
+        /* stop once the current event has been handled */
+        pActions->stopping = true;
+        return EOK;
+    }
+
+    if ( signum == TIMER_NOTIFICATION )
+    {
+        /* arm wall clock schedules for their next firing time */
+        (void)RearmTimer( id );
+    }
+    else if ( signum == VAR_NOTIFICATION )
+    {
+        /* keep the guard inputs current, even if the event is shed */
+        (void)UpdateGuardInput( pActions->hVarServer, (VAR_HANDLE)id );
+
+        /* discard calc results which depend on this variable */
+        InvalidateCaches( pActions, (VAR_HANDLE)id );
+
+        /* update the streaming aggregates of this variable */
+        FeedAggregates( pActions, (VAR_HANDLE)id );
+
+        if ( IsEcho( pActions, (VAR_HANDLE)id ) == true )
         {
-            if ( pAction->init == true )
+            /* the dependent actions have already been run
+               by the propagation which wrote this value */
+            return EOK;
+        }
+    }
+
+    pUnit = FindDispatchUnit( pActions, signum, id );
+    if ( ( pUnit == NULL ) || ( pUnit->levels == 0 ) )
+    {
+        /* no actions, or a checkpoint or snapshot timer */
+        result = QueueLevel( pActions, signum, id, MIN_PRIORITY, 0 );
+    }
+    else if ( signum == CALC_NOTIFICATION )
+    {
+        for ( level = 0; level < NUM_PRIORITIES; level++ )
+        {
+            if ( ( pUnit->levels & ( 1U << level ) ) != 0 )
             {
-                /* perform action processing */
-                rc = ProcessAction( pActions, pAction );
+                priority = MIN_PRIORITY + level;
+                if ( ( pUnit->deadlines[level] != 0 ) &&
+                     ( ( deadline == 0 ) ||
+                       ( pUnit->deadlines[level] < deadline ) ) )
+                {
+                    deadline = pUnit->deadlines[level];
+                }
+            }
+        }
+
+        result = QueueLevel( pActions, signum, id, priority, deadline );
+    }
+    else
+    {
+        /* queue the highest priority level first */
+        for ( level = NUM_PRIORITIES - 1; level >= 0; level-- )
+        {
+            if ( ( pUnit->levels & ( 1U << level ) ) != 0 )
+            {
+                rc = QueueLevel( pActions,
+                                 signum,
+                                 id,
+                                 MIN_PRIORITY + level,
+                                 pUnit->deadlines[level] );
                 if ( rc != EOK )
                 {
                     result = rc;
                 }
             }
-
-            pAction = pAction->pNext;
         }
-
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  HandleSignal                                                              */
+/*  QueueLevel                                                                */
 /*!
-    Handle a received signal
+    Queue the event of one priority level of a signal
 
-    The HandleSignal function drives action execution.
-    It searches through the action processor's action list
-    looking for where the received signal is used, if at all, and then
-    evaluates the conditions around the signal.  If the conditions
-    related to the received signal evaluate to true, then the
-    appropriate action is executed.
+    The QueueLevel function queues an event for the actions of a signal
+    at one priority level, unless it is shed.  If the event queue is
+    full, change notifications are dropped and resynchronized later,
+    and other signals are handled immediately.
 
 @param[in]
     pActions
-        pointer to the actions processor
+        Pointer to the Actions object
 
 @param[in]
     signum
@@ -273,85 +615,62 @@ static int RunInitActions( Actions *pActions )
     id
         the identifier of the signal
 
-@retval EINVAL invalid argument
-@retval EOK the signal was processed
+@param[in]
+    priority
+        the priority of the event
+
+@param[in]
+    deadline
+        the deadline of the event in milliseconds (0 = none)
+
+@retval EOK the event was queued
+@retval ECANCELED the event was shed
+@retval other the event could not be queued
 
 ==============================================================================*/
-static int HandleSignal( Actions *pActions, int signum, int id )
+static int QueueLevel( Actions *pActions,
+                       int signum,
+                       int id,
+                       int priority,
+                       uint64_t deadline )
 {
-    Action *pAction;
-    int result = EINVAL;
-    VAR_HANDLE hVar;
-    bool found = false;
-    Signal *pSignal = NULL;
+    int result;
+    Event event;
 
-    if ( pActions != NULL )
+    memset( &event, 0, sizeof( Event ) );
+    event.signum = signum;
+    event.id = id;
+    event.priority = priority;
+
+    if ( deadline != 0 )
     {
-        if ( ( signum == VAR_NOTIFICATION ) ||
-             ( signum == CALC_NOTIFICATION ) )
+        clock_gettime( CLOCK_MONOTONIC, &event.deadline );
+        event.deadline.tv_sec += deadline / 1000;
+        event.deadline.tv_nsec += ( deadline % 1000 ) * 1000000L;
+        if ( event.deadline.tv_nsec >= 1000000000L )
         {
-            result = ENOENT;
-
-            /* point to the start of the actions list */
-            pAction = pActions->pActionList;
-            while ( pAction != NULL )
-            {
-                found = false;
-
-                /* check for the type of signal we have received */
-                if( pAction->signal == signum )
-                {
-                    /* get signals associated with the action */
-                    pSignal = pAction->pSignals;
-                    while( pSignal != NULL )
-                    {
-                        /* check the signal id (Variable handle) */
-                        if ( pSignal->id == id )
-                        {
-                            /* indicate that the signal is associated with
-                             * the current action */
-                            found = true;
-                        }
+            event.deadline.tv_sec++;
+            event.deadline.tv_nsec -= 1000000000L;
+        }
 
-                        /* look for the next signal */
-                        pSignal = pSignal->pNext;
-                    }
+        event.hasDeadline = true;
+    }
 
-                    if ( found )
-                    {
-                        /* perform action processing */
-                        result = ProcessAction( pActions, pAction );
-                    }
-                }
+    if ( ShedEvent( pActions, &event ) == true )
+    {
+        return ECANCELED;
+    }
 
-                /* move on to the next action */
-                pAction = pAction->pNext;
-            }
+    result = ScheduleEvent( &event );
+    if ( result != EOK )
+    {
+        if ( signum == VAR_NOTIFICATION )
+        {
+            Overload( pActions, "event queue full" );
         }
-        else if ( signum == TIMER_NOTIFICATION )
+        else
         {
-            result = ENOENT;
-
-            /* point to the start of the actions list */
-            pAction = pActions->pActionList;
-            while ( pAction != NULL )
-            {
-                found = false;
-
-                /* check for the type of signal we have received */
-                if( pAction->signal == signum )
-                {
-                    if ( pAction->timerID == id )
-                    {
-                        /* perform action processing */
-                        result = ProcessAction( pActions, pAction );
-                        break;
-                    }
-                }
-
-                /* move on to the next action */
-                pAction = pAction->pNext;
-            }
+            (void)HandleSignal( pActions, signum, id, priority );
         }
     }
 
@@ -359,50 +678,2530 @@ static int HandleSignal( Actions *pActions, int signum, int id )
 }
 
 /*============================================================================*/
-/*  ProcessAction                                                             */
+/*  ShedEvent                                                                 */
 /*!
-    Process an action
+    Shed a low priority event under overload
 
-    The ProcessAction function performs all of the statements
-    contained within the action.
+    The ShedEvent function checks if an event should be discarded because
+    the event backlog exceeds the configured limit and the event's
+    priority is below the configured shedding priority.  Calc requests
+    are never shed since their clients are waiting for a response.
+    Shed change notifications are recovered by a resynchronization
+    once the backlog has cleared.
 
 @param[in]
     pActions
-        pointer to the actions object
+        Pointer to the Actions object
 
 @param[in]
-    pAction
-        pointer to the action to be executed
+    pEvent
+        pointer to the event to check
 
-@retval EINVAL invalid argument
-@retval EOK the action was successfully processed
+@retval true the event was shed
+@retval false the event should be queued
 
 ==============================================================================*/
-static int ProcessAction( Actions *pActions, Action *pAction )
+static bool ShedEvent( Actions *pActions, Event *pEvent )
 {
-    int result = EINVAL;
-    int rc;
-    Statement *pStatement;
+    static bool shedding = false;
 
-    if ( pAction != NULL )
+    if ( ( pActions->backlogLimit == 0 ) ||
+         ( PendingEvents() < pActions->backlogLimit ) )
     {
-        result = EOK;
-        pStatement = pAction->pStatements;
-        while ( pStatement != NULL )
+        shedding = false;
+        return false;
+    }
+
+    if ( ( pEvent->signum == CALC_NOTIFICATION ) ||
+         ( pEvent->priority >= pActions->shedPriority ) )
+    {
+        return false;
+    }
+
+    if ( shedding == false )
+    {
+        LogMessage( LOGLEVEL_eWARNING,
+                    "backlog of %zu events, shedding priority < %d",
+                    PendingEvents(),
+                    pActions->shedPriority );
+        shedding = true;
+    }
+
+    pActions->shedCount++;
+
+    if ( pEvent->signum == VAR_NOTIFICATION )
+    {
+        pActions->resync = true;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  SignalQueueSaturated                                                      */
+/*!
+    Check if the real-time signal queue is saturated
+
+    The SignalQueueSaturated function compares the number of queued
+    signals for the process with the process's queued signal limit
+    (RLIMIT_SIGPENDING), as reported in /proc/self/status.
+
+@retval true the signal queue is saturated
+@retval false the signal queue is not saturated, or its state is unknown
+
+==============================================================================*/
+static bool SignalQueueSaturated( void )
+{
+    FILE *fp;
+    char line[128];
+    unsigned long queued;
+    unsigned long limit;
+    bool result = false;
+
+    fp = fopen( "/proc/self/status", "r" );
+    if ( fp != NULL )
+    {
+        while ( fgets( line, sizeof( line ), fp ) != NULL )
         {
-            rc = ProcessStatement( pActions->hVarServer, pStatement );
-            if ( rc != EOK )
+            if ( sscanf( line, "SigQ: %lu/%lu", &queued, &limit ) == 2 )
             {
-                result = rc;
+                result = ( queued * 100 >= limit * SATURATION_PERCENT );
+                break;
             }
-
-            pStatement = pStatement->pNext;
         }
+
+        fclose( fp );
     }
 
     return result;
 }
 
+/*============================================================================*/
+/*  Overload                                                                  */
+/*!
+    Handle possible loss of change notifications
+
+    The Overload function is called when change notifications may have
+    been lost.  The queued change notifications are discarded since
+    they are superseded by the resynchronization which is scheduled
+    for when the event backlog has cleared.
+
+@param[in]
+    pActions
+        Pointer to the Actions object
+
+@param[in]
+    reason
+        pointer to the NUL terminated reason for the overload
+
+@return none
+
+==============================================================================*/
+static void Overload( Actions *pActions, const char *reason )
+{
+    size_t discarded;
+
+    discarded = DiscardEvents( VAR_NOTIFICATION );
+
+    if ( pActions->resync == false )
+    {
+        LogMessage( LOGLEVEL_eWARNING,
+                    "%s, resynchronizing (%zu events discarded)",
+                    reason,
+                    discarded );
+    }
+
+    pActions->resync = true;
+}
+
+/*============================================================================*/
+/*  Resync                                                                    */
+/*!
+    Resynchronize the watched variables
+
+    The Resync function re-reads all of the watched variables, and runs
+    the on change actions triggered by the variables which have changed
+    since the last resynchronization, once each, in dependency order.
+    Cached calc results which depend on changed variables are discarded.
+
+@param[in]
+    pActions
+        Pointer to the Actions object
+
+@retval EOK the actions ran successfully
+@retval ENOENT no variables changed
+@retval other error from the last failed action
+
+==============================================================================*/
+static int Resync( Actions *pActions )
+{
+    Watch *pWatch;
+    Action *pAction;
+
+    pActions->resync = false;
+
+    /* the guard inputs may have missed change notifications */
+    RefreshGuardInputs( pActions->hVarServer );
+
+    for ( pWatch = pActions->pWatchList;
+          pWatch != NULL;
+          pWatch = pWatch->pNext )
+    {
+        if ( WatchChanged( pActions, pWatch ) == true )
+        {
+            InvalidateCaches( pActions, pWatch->hVar );
+
+            for ( pAction = pActions->pActionList;
+                  pAction != NULL;
+                  pAction = pAction->pNext )
+            {
+                if ( ( pAction->signal == VAR_NOTIFICATION ) &&
+                     ( IsTriggeredBy( pAction, pWatch->hVar ) == true ) )
+                {
+                    pAction->pending = true;
+                }
+            }
+        }
+    }
+
+    /* any expected notification may have been lost */
+    ClearEchoes( pActions );
+
+    return Propagate( pActions );
+}
+
+/*============================================================================*/
+/*  WatchChanged                                                              */
+/*!
+    Check if a watched variable has changed
+
+    The WatchChanged function reads the current value of a watched
+    variable and compares it with the value seen at the last check.
+    Variables which are not numeric are always considered changed.
+
+@param[in]
+    pActions
+        Pointer to the Actions object
+
+@param[in]
+    pWatch
+        pointer to the watched variable
+
+@retval true the variable may have changed
+@retval false the variable has not changed
+
+==============================================================================*/
+static bool WatchChanged( Actions *pActions, Watch *pWatch )
+{
+    VarObject obj;
+    bool changed = true;
+
+    if ( ( pWatch->obj.type != VARTYPE_STR ) &&
+         ( pWatch->obj.type != VARTYPE_INVALID ) )
+    {
+        memset( &obj, 0, sizeof( VarObject ) );
+        obj.type = pWatch->obj.type;
+
+        if ( VAR_Get( pActions->hVarServer, pWatch->hVar, &obj ) == EOK )
+        {
+            changed = ( pWatch->seen == false ) ||
+                      ( SameValue( &obj, &pWatch->last ) == false );
+
+            pWatch->last = obj;
+            pWatch->seen = true;
+        }
+    }
+
+    return changed;
+}
+
+/*============================================================================*/
+/*  RunInitActions                                                            */
+/*!
+    Run the Init Actions processors
+
+    The RunInitActions function iterates through all of the actions
+    and runs any that have the init flag set.
+
+@param[in]
+    pActions
+        Pointer to the Actions to execute
+
+@retval EOK the actions completed normally
+@retval EINVAL invalid arguments
+@retval other actions error
+
+==============================================================================*/
+static int RunInitActions( Actions *pActions )
+{
+    int result = EINVAL;
+    int rc;
+    Action *pAction;
+
+    if ( pActions != NULL )
+    {
+        result = EOK;
+
+        pAction = pActions->pActionList;
+        while ( pAction != NULL )
+        {
+            if ( pAction->init == true )
+            {
+                /* perform action processing */
+                rc = ProcessAction( pActions, pAction );
+                if ( ( rc != EOK ) && ( rc != ECANCELED ) )
+                {
+                    result = rc;
+                }
+            }
+
+            pAction = pAction->pNext;
+        }
+
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HandleSignal                                                              */
+/*!
+    Handle a received signal
+
+    The HandleSignal function drives action execution.
+    It searches through the action processor's action list
+    looking for where the received signal is used, if at all, and then
+    evaluates the conditions around the signal.  If the conditions
+    related to the received signal evaluate to true, then the
+    appropriate action is executed.
+
+@param[in]
+    pActions
+        pointer to the actions processor
+
+@param[in]
+    signum
+        the type of signal received
+
+@param[in]
+    id
+        the identifier of the signal
+
+@param[in]
+    priority
+        the priority level of the change or timer actions to run
+
+@retval EINVAL invalid argument
+@retval EOK the signal was processed
+
+==============================================================================*/
+static int HandleSignal( Actions *pActions, int signum, int id, int priority )
+{
+    Action *pAction;
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    Signal *pSignal = NULL;
+    DispatchUnit *pUnit;
+    size_t i;
+
+    if ( pActions != NULL )
+    {
+        if ( signum == VAR_NOTIFICATION )
+        {
+            /* mark the actions at this priority triggered by the variable */
+            pUnit = ActiveUnit( pActions, signum, id );
+            for ( i = 0; ( pUnit != NULL ) && ( i < pUnit->count ); i++ )
+            {
+                pAction = pUnit->ppActions[i];
+                if ( pAction->priority == priority )
+                {
+                    BindTrigger( pAction, (VAR_HANDLE)id );
+                    pAction->pending = true;
+                }
+            }
+
+            /* run the triggered actions and their dependents */
+            TakeSnapshot( pUnit, priority );
+            result = Propagate( pActions );
+            pSnapshot = NULL;
+        }
+        else if ( signum == CALC_NOTIFICATION )
+        {
+            result = ENOENT;
+
+            /* run the calc actions of this variable in declaration order */
+            pUnit = FindDispatchUnit( pActions, signum, id );
+            for ( i = 0; ( pUnit != NULL ) && ( i < pUnit->count ); i++ )
+            {
+                pAction = pUnit->ppActions[i];
+
+                /* get the signal (Variable handle) for the action */
+                pSignal = FindSignal( pAction, (VAR_HANDLE)id );
+                if ( pSignal != NULL )
+                {
+                    /* perform calc processing */
+                    BindTrigger( pAction, (VAR_HANDLE)id );
+                    result = HandleCalc( pActions, pAction, pSignal );
+                }
+            }
+        }
+        else if ( ( signum == TIMER_NOTIFICATION ) &&
+                  ( pActions->checkpointTimer != 0 ) &&
+                  ( id == pActions->checkpointTimer ) )
+        {
+            Checkpoint( pActions );
+            result = EOK;
+        }
+        else if ( ( signum == TIMER_NOTIFICATION ) &&
+                  ( pActions->snapshotTimer != 0 ) &&
+                  ( id == pActions->snapshotTimer ) )
+        {
+            result = SaveSnapshot( pActions );
+        }
+        else if ( signum == TIMER_NOTIFICATION )
+        {
+            result = ENOENT;
+
+            /* process the timer's actions at this priority */
+            pUnit = FindDispatchUnit( pActions, signum, id );
+            TakeSnapshot( pUnit, priority );
+            for ( i = 0; ( pUnit != NULL ) && ( i < pUnit->count ); i++ )
+            {
+                if ( pUnit->ppActions[i]->priority == priority )
+                {
+                    result = ProcessAction( pActions, pUnit->ppActions[i] );
+                }
+            }
+
+            pSnapshot = NULL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BuildDependencyGraph                                                      */
+/*!
+    Build the action dependency graph
+
+    The BuildDependencyGraph function links each action to the on change
+    actions which are triggered by the system variables it writes,
+    found through the dispatch table, and sorts the actions
+    topologically so derived values can be propagated from their
+    sources to their consumers in a single pass.
+
+    The sort keeps a queue of the actions which have no unplaced
+    writers, seeded in declaration order, so the graph is sorted in
+    time proportional to the number of actions and dependencies.
+    Actions which are part of a dependency cycle are appended in
+    declaration order after the acyclic actions.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the dependency graph was built
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int BuildDependencyGraph( Actions *pActions )
+{
+    int result = EINVAL;
+    Action *pAction;
+    Action *pTarget;
+    Action **ppIndex;
+    Action **ppQueue;
+    Dependency *pDependency;
+    DispatchUnit *pUnit;
+    VarRef *pWrite;
+    size_t *pInDegree;
+    size_t *pLinked;
+    bool *pPlaced;
+    size_t n = 0;
+    size_t i;
+    size_t j;
+    size_t first = 0;
+    size_t last = 0;
+    size_t count = 0;
+
+    if ( pActions != NULL )
+    {
+        for ( pAction = pActions->pActionList;
+              pAction != NULL;
+              pAction = pAction->pNext )
+        {
+            n++;
+        }
+
+        pActions->ppOrder = (Action **)calloc( n + 1, sizeof( Action * ) );
+        ppIndex = (Action **)calloc( n + 1, sizeof( Action * ) );
+        ppQueue = (Action **)calloc( n + 1, sizeof( Action * ) );
+        pInDegree = (size_t *)calloc( n + 1, sizeof( size_t ) );
+        pLinked = (size_t *)calloc( n + 1, sizeof( size_t ) );
+        pPlaced = (bool *)calloc( n + 1, sizeof( bool ) );
+
+        if ( ( pActions->ppOrder != NULL ) &&
+             ( ppIndex != NULL ) &&
+             ( ppQueue != NULL ) &&
+             ( pInDegree != NULL ) &&
+             ( pLinked != NULL ) &&
+             ( pPlaced != NULL ) )
+        {
+            /* index the actions in declaration order */
+            for ( pAction = pActions->pActionList, i = 0;
+                  pAction != NULL;
+                  pAction = pAction->pNext, i++ )
+            {
+                ppIndex[i] = pAction;
+                pAction->rank = i;
+            }
+
+            /* link each writer to the on change actions it triggers */
+            for ( i = 0; i < n; i++ )
+            {
+                pAction = ppIndex[i];
+                for ( pWrite = pAction->pWrites;
+                      pWrite != NULL;
+                      pWrite = pWrite->pNext )
+                {
+                    pUnit = FindDispatchUnit( pActions,
+                                              VAR_NOTIFICATION,
+                                              (int)pWrite->hVar );
+
+                    for ( j = 0;
+                          ( pUnit != NULL ) && ( j < pUnit->count );
+                          j++ )
+                    {
+                        pTarget = pUnit->ppActions[j];
+
+                        /* pLinked holds one more than the index of the
+                           last writer linked to the target */
+                        if ( ( pTarget == pAction ) ||
+                             ( pLinked[pTarget->rank] == i + 1 ) )
+                        {
+                            continue;
+                        }
+
+                        pDependency = calloc( 1, sizeof( Dependency ) );
+                        if ( pDependency != NULL )
+                        {
+                            pDependency->pAction = pTarget;
+                            pDependency->pNext = pAction->pDependents;
+                            pAction->pDependents = pDependency;
+                            pInDegree[pTarget->rank]++;
+                            pLinked[pTarget->rank] = i + 1;
+                        }
+                    }
+                }
+            }
+
+            /* queue the actions without writers in declaration order */
+            for ( i = 0; i < n; i++ )
+            {
+                if ( pInDegree[i] == 0 )
+                {
+                    ppQueue[last++] = ppIndex[i];
+                }
+            }
+
+            /* place the queued actions, queueing their dependents
+               once all of their writers have been placed */
+            while ( first < last )
+            {
+                pAction = ppQueue[first++];
+                pPlaced[pAction->rank] = true;
+                pActions->ppOrder[count++] = pAction;
+
+                for ( pDependency = pAction->pDependents;
+                      pDependency != NULL;
+                      pDependency = pDependency->pNext )
+                {
+                    j = pDependency->pAction->rank;
+                    if ( --pInDegree[j] == 0 )
+                    {
+                        ppQueue[last++] = ppIndex[j];
+                    }
+                }
+            }
+
+            /* append any actions in dependency cycles */
+            for ( i = 0; i < n; i++ )
+            {
+                if ( pPlaced[i] == false )
+                {
+                    pActions->ppOrder[count++] = ppIndex[i];
+                }
+            }
+
+            /* record each action's position in the propagation order */
+            for ( i = 0; i < n; i++ )
+            {
+                pActions->ppOrder[i]->rank = i;
+            }
+
+            pActions->numActions = n;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+
+        free( ppIndex );
+        free( ppQueue );
+        free( pInDegree );
+        free( pLinked );
+        free( pPlaced );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HasReference                                                              */
+/*!
+    Check if a variable reference list contains a variable
+
+@param[in]
+    pRef
+        pointer to the first reference in the list
+
+@param[in]
+    hVar
+        handle of the variable to look for
+
+@retval true the variable is in the list
+@retval false the variable is not in the list
+
+==============================================================================*/
+static bool HasReference( VarRef *pRef, VAR_HANDLE hVar )
+{
+    while ( pRef != NULL )
+    {
+        if ( pRef->hVar == hVar )
+        {
+            return true;
+        }
+
+        pRef = pRef->pNext;
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  IsTriggeredBy                                                             */
+/*!
+    Check if an action is triggered by a variable
+
+@param[in]
+    pAction
+        pointer to the action to check
+
+@param[in]
+    hVar
+        handle of the triggering variable
+
+@retval true the variable is in the action's signal list
+@retval false the variable does not trigger the action
+
+==============================================================================*/
+static bool IsTriggeredBy( Action *pAction, VAR_HANDLE hVar )
+{
+    return ( FindSignal( pAction, hVar ) != NULL );
+}
+
+/*============================================================================*/
+/*  FindSignal                                                                */
+/*!
+    Find an action's signal for a variable
+
+@param[in]
+    pAction
+        pointer to the action to search
+
+@param[in]
+    hVar
+        handle of the signal variable
+
+@retval pointer to the action's signal for the variable
+@retval NULL the variable is not in the action's signal list
+
+==============================================================================*/
+static Signal *FindSignal( Action *pAction, VAR_HANDLE hVar )
+{
+    Signal *pSignal = pAction->pSignals;
+
+    while ( pSignal != NULL )
+    {
+        if ( pSignal->id == (int)hVar )
+        {
+            break;
+        }
+
+        pSignal = pSignal->pNext;
+    }
+
+    return pSignal;
+}
+
+/*============================================================================*/
+/*  HandleCalc                                                                */
+/*!
+    Handle a calc request
+
+    The HandleCalc function responds to a calc request for one of
+    a calc action's variables.  If the action caches its results and
+    the cached result for the variable is still valid, the cached
+    result is returned without running the action.
+
+    The queued variable writes are flushed first, and the calc action
+    writes immediately, so the calc result is the last value written
+    when the request is answered.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the calc action
+
+@param[in]
+    pSignal
+        pointer to the signal of the requested variable
+
+@retval EOK the calc request was handled
+@retval other error from the calc action
+
+==============================================================================*/
+static int HandleCalc( Actions *pActions, Action *pAction, Signal *pSignal )
+{
+    int result;
+
+    (void)FlushWrites();
+    SetDirectWrites( true );
+
+    if ( CacheHit( pActions, pAction, pSignal ) == true )
+    {
+        result = EOK;
+    }
+    else
+    {
+        result = ProcessAction( pActions, pAction );
+        if ( ( result != ECANCELED ) &&
+             ( pAction->cacheMode != CACHE_eNONE ) )
+        {
+            UpdateCache( pActions, pSignal );
+        }
+    }
+
+    SetDirectWrites( false );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CacheHit                                                                  */
+/*!
+    Answer a calc request from the cache
+
+    The CacheHit function checks if a valid cached calc result exists
+    for the requested variable, and if so, writes it back to the
+    variable to complete the calc request.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the calc action
+
+@param[in]
+    pSignal
+        pointer to the signal of the requested variable
+
+@retval true the calc request was answered from the cache
+@retval false the calc action must be run
+
+==============================================================================*/
+static bool CacheHit( Actions *pActions, Action *pAction, Signal *pSignal )
+{
+    bool hit = false;
+
+    if ( ( pAction->cacheMode != CACHE_eNONE ) &&
+         ( pSignal->cached == true ) )
+    {
+        if ( ( pAction->cacheMode == CACHE_eTIMED ) &&
+             ( ElapsedMs( &pSignal->cacheTime ) >= pAction->cacheTTL ) )
+        {
+            pSignal->cached = false;
+        }
+        else if ( VAR_Set( pActions->hVarServer,
+                           (VAR_HANDLE)pSignal->id,
+                           &pSignal->cache ) == EOK )
+        {
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+/*============================================================================*/
+/*  UpdateCache                                                               */
+/*!
+    Cache a calc result
+
+    The UpdateCache function reads back the value calculated for
+    the requested variable and stores it in the signal's cache.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pSignal
+        pointer to the signal of the requested variable
+
+@return none
+
+==============================================================================*/
+static void UpdateCache( Actions *pActions, Signal *pSignal )
+{
+    pSignal->cached = false;
+
+    if ( pSignal->pVariable != NULL )
+    {
+        memset( &pSignal->cache, 0, sizeof( VarObject ) );
+        pSignal->cache.type = pSignal->pVariable->obj.type;
+
+        if ( pSignal->cache.type == VARTYPE_STR )
+        {
+            if ( pSignal->pCacheBuffer == NULL )
+            {
+                pSignal->pCacheBuffer = calloc( 1, MAX_CACHED_STRING_LEN );
+            }
+
+            if ( pSignal->pCacheBuffer == NULL )
+            {
+                return;
+            }
+
+            pSignal->cache.val.str = pSignal->pCacheBuffer;
+            pSignal->cache.len = MAX_CACHED_STRING_LEN;
+        }
+
+        if ( VAR_Get( pActions->hVarServer,
+                      (VAR_HANDLE)pSignal->id,
+                      &pSignal->cache ) == EOK )
+        {
+            clock_gettime( CLOCK_MONOTONIC, &pSignal->cacheTime );
+            pSignal->cached = true;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  InvalidateCaches                                                          */
+/*!
+    Invalidate cached calc results which depend on a variable
+
+    The InvalidateCaches function discards the cached results of
+    all calc actions which read the specified variable.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    hVar
+        handle of the variable which changed
+
+@return none
+
+==============================================================================*/
+static void InvalidateCaches( Actions *pActions, VAR_HANDLE hVar )
+{
+    Action *pAction;
+    Signal *pSignal;
+
+    for ( pAction = pActions->pActionList;
+          pAction != NULL;
+          pAction = pAction->pNext )
+    {
+        if ( ( pAction->cacheMode == CACHE_eUNTIL_CHANGE ) &&
+             ( HasReference( pAction->pReads, hVar ) == true ) )
+        {
+            for ( pSignal = pAction->pSignals;
+                  pSignal != NULL;
+                  pSignal = pSignal->pNext )
+            {
+                pSignal->cached = false;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ElapsedMs                                                                 */
+/*!
+    Get the time elapsed since a point in time
+
+@param[in]
+    pStart
+        pointer to the start time (CLOCK_MONOTONIC)
+
+@retval the number of milliseconds elapsed since the start time
+
+==============================================================================*/
+static uint64_t ElapsedMs( struct timespec *pStart )
+{
+    struct timespec now;
+    int64_t ms;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    ms = ( (int64_t)now.tv_sec - (int64_t)pStart->tv_sec ) * 1000 +
+         ( now.tv_nsec - pStart->tv_nsec ) / 1000000;
+
+    return ( ms > 0 ) ? (uint64_t)ms : 0;
+}
+
+/*============================================================================*/
+/*  Propagate                                                                 */
+/*!
+    Propagate changes through the pending actions
+
+    The Propagate function runs all pending actions in dependency order.
+    When an action runs, the on change actions which consume the variables
+    it writes are marked pending and run later in the same pass, so each
+    action runs at most once per dispatch cycle and sees fully updated
+    inputs.  Actions which were skipped wrote nothing, so their
+    dependents are not marked.  The VarServer notifications generated
+    by these intermediate writes are discarded when they arrive, if
+    all of the actions they trigger have already been run.
+
+    Dependencies which point backwards in the order (cycles) are not
+    followed, and are handled by the regular VarServer notifications.
+    Neither are dependencies on actions which refer to their triggering
+    variable, since they must run once for each variable which changed.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK all actions ran successfully
+@retval ENOENT no action was pending
+@retval other error from the last failed action
+
+==============================================================================*/
+static int Propagate( Actions *pActions )
+{
+    int result = ENOENT;
+    int rc;
+    size_t i;
+    Action *pAction;
+    Dependency *pDependency;
+
+    for ( i = 0; i < pActions->numActions; i++ )
+    {
+        pAction = pActions->ppOrder[i];
+        if ( pAction->pending == false )
+        {
+            continue;
+        }
+
+        pAction->pending = false;
+
+        rc = ProcessAction( pActions, pAction );
+        if ( rc == ECANCELED )
+        {
+            /* the action did not run */
+            continue;
+        }
+
+        if ( ( result == ENOENT ) || ( rc != EOK ) )
+        {
+            result = rc;
+        }
+
+        for ( pDependency = pAction->pDependents;
+              pDependency != NULL;
+              pDependency = pDependency->pNext )
+        {
+            if ( ( pDependency->pAction->rank > pAction->rank ) &&
+                 ( pDependency->pAction->pTriggers == NULL ) )
+            {
+                pDependency->pAction->pending = true;
+            }
+        }
+
+        ExpectEcho( pActions, pAction );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ExpectEcho                                                                */
+/*!
+    Expect the change notifications of propagated writes
+
+    The ExpectEcho function counts a change notification for each
+    variable written by an action which has just run, if every action
+    triggered by the variable has been scheduled by the propagation.
+    The notification is then redundant, and is discarded when it
+    arrives.  Variables which trigger any other action, such as an
+    earlier action in the order, an action in a cycle, or an action
+    which refers to its triggering variable, get their notifications
+    as normal.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the action which wrote the variables
+
+@return none
+
+==============================================================================*/
+static void ExpectEcho( Actions *pActions, Action *pAction )
+{
+    VarRef *pWrite;
+    DispatchUnit *pUnit;
+
+    for ( pWrite = pAction->pWrites; pWrite != NULL; pWrite = pWrite->pNext )
+    {
+        pUnit = FindDispatchUnit( pActions,
+                                  VAR_NOTIFICATION,
+                                  (int)pWrite->hVar );
+        if ( ( pUnit != NULL ) && ( Covered( pUnit, pAction ) == true ) )
+        {
+            pUnit->echoes++;
+            expectedEchoes++;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  Covered                                                                   */
+/*!
+    Check if a propagation runs all the actions of a trigger
+
+    The Covered function checks if all of the actions triggered by a
+    variable are run by the propagation of an action's writes, because
+    they follow the action in the propagation order, and do not refer
+    to their triggering variable.
+
+@param[in]
+    pUnit
+        pointer to the dispatch unit of the written variable
+
+@param[in]
+    pAction
+        pointer to the action which wrote the variable
+
+@retval true the propagation runs all of the unit's actions
+@retval false some of the unit's actions need the notification
+
+==============================================================================*/
+static bool Covered( DispatchUnit *pUnit, Action *pAction )
+{
+    bool covered = ( pUnit->count > 0 );
+    size_t i;
+
+    for ( i = 0; ( covered == true ) && ( i < pUnit->count ); i++ )
+    {
+        covered = ( pUnit->ppActions[i]->rank > pAction->rank ) &&
+                  ( pUnit->ppActions[i]->pTriggers == NULL );
+    }
+
+    return covered;
+}
+
+/*============================================================================*/
+/*  IsEcho                                                                    */
+/*!
+    Check if a change notification was caused by a propagated write
+
+    The IsEcho function checks if a change notification for the
+    specified variable is expected as the result of a propagated
+    write, whose triggered actions have all been run already.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    hVar
+        handle of the variable which changed
+
+@retval true the notification should be discarded
+@retval false the notification should be processed
+
+==============================================================================*/
+static bool IsEcho( Actions *pActions, VAR_HANDLE hVar )
+{
+    DispatchUnit *pUnit;
+    bool echo = false;
+
+    if ( expectedEchoes > 0 )
+    {
+        pUnit = FindDispatchUnit( pActions, VAR_NOTIFICATION, (int)hVar );
+        if ( ( pUnit != NULL ) && ( pUnit->echoes > 0 ) )
+        {
+            pUnit->echoes--;
+            expectedEchoes--;
+            echo = true;
+        }
+    }
+
+    return echo;
+}
+
+/*============================================================================*/
+/*  ClearEchoes                                                               */
+/*!
+    Stop expecting the notifications of propagated writes
+
+    The ClearEchoes function discards the expected notification counts,
+    for example when a propagated write did not change its variable,
+    so no later notification is mistaken for an echo.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@return none
+
+==============================================================================*/
+static void ClearEchoes( Actions *pActions )
+{
+    DispatchUnit *pUnit;
+    size_t i;
+
+    for ( i = 0; ( expectedEchoes > 0 ) && ( i < pActions->numBuckets ); i++ )
+    {
+        for ( pUnit = pActions->ppUnits[i];
+              pUnit != NULL;
+              pUnit = pUnit->pNext )
+        {
+            expectedEchoes -= pUnit->echoes;
+            pUnit->echoes = 0;
+        }
+    }
+
+    expectedEchoes = 0;
+}
+
+/*============================================================================*/
+/*  SameValue                                                                 */
+/*!
+    Compare two numeric variable values
+
+@param[in]
+    pObj1
+        pointer to the first value
+
+@param[in]
+    pObj2
+        pointer to the second value
+
+@retval true the values have the same type and value
+@retval false the values differ or are not numeric
+
+==============================================================================*/
+static bool SameValue( VarObject *pObj1, VarObject *pObj2 )
+{
+    if ( pObj1->type != pObj2->type )
+    {
+        return false;
+    }
+
+    switch ( pObj1->type )
+    {
+        case VARTYPE_UINT16:
+            return pObj1->val.ui == pObj2->val.ui;
+
+        case VARTYPE_INT16:
+            return pObj1->val.i == pObj2->val.i;
+
+        case VARTYPE_UINT32:
+            return pObj1->val.ul == pObj2->val.ul;
+
+        case VARTYPE_INT32:
+            return pObj1->val.l == pObj2->val.l;
+
+        case VARTYPE_UINT64:
+            return pObj1->val.ull == pObj2->val.ull;
+
+        case VARTYPE_INT64:
+            return pObj1->val.ll == pObj2->val.ll;
+
+        case VARTYPE_FLOAT:
+            return pObj1->val.f == pObj2->val.f;
+
+        default:
+            return false;
+    }
+}
+
+/*============================================================================*/
+/*  ProcessAction                                                             */
+/*!
+    Process an action
+
+    The ProcessAction function performs all of the statements
+    contained within the action.
+
+    The execution time of the action is measured, and checked against
+    the action's execution budget (or the default budget).  While
+    the action is running, a watchdog kills any script which
+    is still running when the budget expires.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the action to be executed
+
+@retval EINVAL invalid argument
+@retval EOK the action was successfully processed
+@retval ECANCELED the action is disabled or its guard is not satisfied,
+        so it did not run
+
+==============================================================================*/
+static int ProcessAction( Actions *pActions, Action *pAction )
+{
+    int result = EINVAL;
+    int rc;
+    Statement *pStatement;
+    StringBuilder *pBuilder;
+    Delay *pDelay;
+    Condition *pCondition;
+    Loop *pLoop;
+    QueuedAssignment *pAssignment;
+    struct timespec start;
+    uint64_t budget;
+    uint64_t elapsed;
+    bool queued = false;
+
+    if ( ( pAction != NULL ) &&
+         ( ( pAction->disabled == true ) ||
+           ( EvalGuard( pAction->pGuard ) == false ) ) )
+    {
+        /* the action has been disabled, or its guard is not satisfied,
+           so skip the action before doing any of the work of running it */
+        result = ECANCELED;
+    }
+    else if ( pAction != NULL )
+    {
+        budget = ( pAction->budget != 0 ) ? pAction->budget
+                                          : pActions->budget;
+
+        if ( InSnapshot( pAction ) == false )
+        {
+            if ( WritesQueued( pAction ) == true )
+            {
+                /* the action must see, and write after, the queued
+                   writes of the variables it uses */
+                (void)FlushWrites();
+            }
+
+            /* fetch the action's own values of the variable sets */
+            fetchGeneration++;
+        }
+
+        /* bring the action's aggregate values up to date */
+        RefreshAggregates( pAction );
+
+        /* fetch and reduce the variable sets used by the action */
+        RefreshReductions( pActions, pAction );
+
+        /* restore the values of the static variables */
+        RestoreStatics( pAction );
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+        if ( budget != 0 )
+        {
+            (void)StartWatchdog( budget );
+        }
+
+        result = EOK;
+        pStatement = pAction->pStatements;
+        pBuilder = pAction->pBuilders;
+        pDelay = pAction->pDelays;
+        pCondition = pAction->pConditions;
+        pLoop = pAction->pLoops;
+        pAssignment = pAction->pAssignments;
+        while ( pStatement != NULL )
+        {
+            if ( ( queued == true ) &&
+                 ( ( pAssignment == NULL ) ||
+                   ( pAssignment->pStatement != pStatement ) ) )
+            {
+                /* the statement may read or write the variable of the
+                   queued write, so complete the write first */
+                (void)FlushWrites();
+                queued = false;
+            }
+
+            if ( ( pDelay != NULL ) &&
+                 ( pDelay->pStatement == pStatement ) )
+            {
+                /* start or cancel the one-shot timers */
+                rc = RunDelay( pAction, pDelay );
+                pDelay = pDelay->pNext;
+            }
+            else if ( ( pLoop != NULL ) &&
+                      ( pLoop->pStatement == pStatement ) )
+            {
+                /* run the loop body over the fetched variable set */
+                rc = RunLoop( pActions, pLoop );
+                pLoop = pLoop->pNext;
+            }
+            else if ( ( pAssignment != NULL ) &&
+                      ( pAssignment->pStatement == pStatement ) )
+            {
+                /* queue the write of the assigned value */
+                rc = RunAssignment( pActions, pAssignment );
+                queued = WritePending( pAssignment->hTarget );
+                pAssignment = pAssignment->pNext;
+            }
+            else if ( ( pBuilder != NULL ) &&
+                 ( pBuilder->pStatement == pStatement ) )
+            {
+                /* build the string in the pre-sized buffer */
+                rc = RunStringBuilder( pActions->hVarServer, pBuilder );
+                if ( rc == ENOENT )
+                {
+                    /* a field could not be read into the buffer, or
+                       the result did not fit, so evaluate the original
+                       assignment instead */
+                    rc = RunStatement( pActions, pStatement );
+                }
+
+                queued = WritePending( pBuilder->hTarget );
+                pBuilder = pBuilder->pNext;
+            }
+            else
+            {
+                if ( ( pCondition != NULL ) &&
+                     ( pCondition->pStatement == pStatement ) )
+                {
+                    /* count the operands which decide the condition */
+                    if ( ( ProfileCondition( pCondition ) == true ) &&
+                         ( LogEnabled( LOGLEVEL_eINFO, pAction->logLevel ) ) )
+                    {
+                        LogRecord( LOGLEVEL_eINFO,
+                                   LOGCODE_eREORDER,
+                                   pAction->lineno,
+                                   0,
+                                   0 );
+                    }
+
+                    pCondition = pCondition->pNext;
+                }
+
+                rc = RunStatement( pActions, pStatement );
+            }
+
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+
+            pStatement = pStatement->pNext;
+        }
+
+        if ( budget != 0 )
+        {
+            (void)StopWatchdog();
+        }
+
+        /* keep the values of the static variables */
+        SaveStatics( pAction );
+
+        elapsed = ElapsedUs( &start );
+
+        if ( LogEnabled( LOGLEVEL_eDEBUG, pAction->logLevel ) )
+        {
+            LogRecord( LOGLEVEL_eDEBUG,
+                       LOGCODE_eACTION,
+                       pAction->lineno,
+                       (int64_t)elapsed,
+                       result );
+        }
+
+        pAction->runs++;
+        pAction->totalTime += elapsed;
+        if ( elapsed > pAction->maxTime )
+        {
+            pAction->maxTime = elapsed;
+        }
+
+        if ( ( budget != 0 ) &&
+             ( ( elapsed > budget * 1000 ) || WatchdogExpired() ) )
+        {
+            Overrun( pActions, pAction, elapsed );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ElapsedUs                                                                 */
+/*!
+    Get the time elapsed since a point in time
+
+@param[in]
+    pStart
+        pointer to the start time (CLOCK_MONOTONIC)
+
+@retval the number of microseconds elapsed since the start time
+
+==============================================================================*/
+static uint64_t ElapsedUs( struct timespec *pStart )
+{
+    struct timespec now;
+    int64_t us;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    us = ( (int64_t)now.tv_sec - (int64_t)pStart->tv_sec ) * 1000000 +
+         ( now.tv_nsec - pStart->tv_nsec ) / 1000;
+
+    return ( us > 0 ) ? (uint64_t)us : 0;
+}
+
+/*============================================================================*/
+/*  Overrun                                                                   */
+/*!
+    Record an execution budget overrun
+
+    The Overrun function records an action which exceeded its execution
+    budget, logs it, and publishes the overrun metrics.
+
+    If a metrics prefix is configured, the total number of overruns is
+    published to the <prefix>/overruns variable, and a description of
+    the last overrun is published to the <prefix>/overrun variable,
+    if these variables exist.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAction
+        pointer to the action which exceeded its budget
+
+@param[in]
+    elapsed
+        execution time of the action in microseconds
+
+@return none
+
+==============================================================================*/
+static void Overrun( Actions *pActions, Action *pAction, uint64_t elapsed )
+{
+    VarObject obj;
+    char buf[128];
+
+    pAction->overruns++;
+    pActions->overruns++;
+
+    snprintf( buf,
+              sizeof( buf ),
+              "%s:%d %llu ms",
+              ( pActions->filename != NULL ) ? pActions->filename : "",
+              pAction->lineno,
+              (unsigned long long)( elapsed / 1000 ) );
+
+    LogMessage( LOGLEVEL_eWARNING, "execution budget exceeded: %s", buf );
+
+    if ( pActions->metrics != NULL )
+    {
+        memset( &obj, 0, sizeof( VarObject ) );
+        obj.type = VARTYPE_UINT32;
+        obj.len = sizeof( uint32_t );
+        obj.val.ul = (uint32_t)pActions->overruns;
+        PublishMetric( pActions, "overruns", &obj );
+
+        memset( &obj, 0, sizeof( VarObject ) );
+        obj.type = VARTYPE_STR;
+        obj.len = strlen( buf ) + 1;
+        obj.val.str = buf;
+        PublishMetric( pActions, "overrun", &obj );
+    }
+}
+
+/*============================================================================*/
+/*  PublishMetric                                                             */
+/*!
+    Publish a metric to the variable server
+
+    The PublishMetric function writes a metric value to the
+    <prefix>/<name> variable, where <prefix> is the configured metrics
+    prefix.  Metrics whose variables do not exist are not published.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    name
+        pointer to the NUL terminated name of the metric
+
+@param[in]
+    pObj
+        pointer to the metric value
+
+@return none
+
+==============================================================================*/
+static void PublishMetric( Actions *pActions,
+                           const char *name,
+                           VarObject *pObj )
+{
+    char varname[MAX_NAME_LEN + 1];
+    VAR_HANDLE hVar;
+
+    snprintf( varname, sizeof( varname ), "%s/%s", pActions->metrics, name );
+
+    hVar = VAR_FindByName( pActions->hVarServer, varname );
+    if ( hVar != VAR_INVALID )
+    {
+        (void)WriteVar( pActions->hVarServer, hVar, pObj );
+    }
+}
+
+/*============================================================================*/
+/*  FeedAggregates                                                            */
+/*!
+    Feed a variable change to the streaming aggregates
+
+    The FeedAggregates function reads the new value of a changed variable
+    once, and adds it as a sample to all of the aggregates of the variable.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    hVar
+        handle of the variable which changed
+
+@return none
+
+==============================================================================*/
+static void FeedAggregates( Actions *pActions, VAR_HANDLE hVar )
+{
+    Action *pAction;
+    Aggregate *pAggregate;
+    VarObject obj;
+    double value = 0.0;
+    bool valid = false;
+    bool read = false;
+    uint64_t now = 0;
+
+    for ( pAction = pActions->pActionList;
+          pAction != NULL;
+          pAction = pAction->pNext )
+    {
+        for ( pAggregate = pAction->pAggregates;
+              pAggregate != NULL;
+              pAggregate = pAggregate->pNext )
+        {
+            if ( pAggregate->hVar != hVar )
+            {
+                continue;
+            }
+
+            if ( read == false )
+            {
+                read = true;
+                now = NowMs();
+
+                memset( &obj, 0, sizeof( VarObject ) );
+                obj.type = pAggregate->varType;
+                if ( VAR_Get( pActions->hVarServer, hVar, &obj ) == EOK )
+                {
+                    valid = ToDouble( &obj, &value );
+                }
+            }
+
+            if ( valid == true )
+            {
+                AddSample( pAggregate, value, now );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  RefreshAggregates                                                         */
+/*!
+    Update the aggregate values used by an action
+
+    The RefreshAggregates function calculates the current value of each
+    aggregate used by the action, and stores it in the aggregate's
+    expression node.
+
+@param[in]
+    pAction
+        pointer to the action about to run
+
+@return none
+
+==============================================================================*/
+static void RefreshAggregates( Action *pAction )
+{
+    Aggregate *pAggregate;
+    uint64_t now;
+
+    if ( pAction->pAggregates != NULL )
+    {
+        now = NowMs();
+
+        for ( pAggregate = pAction->pAggregates;
+              pAggregate != NULL;
+              pAggregate = pAggregate->pNext )
+        {
+            if ( pAggregate->pResult != NULL )
+            {
+                pAggregate->pResult->obj.val.f =
+                    (float)GetAggregate( pAggregate, now );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  RefreshReductions                                                         */
+/*!
+    Calculate the variable set reductions used by an action
+
+    The RefreshReductions function fetches the values of each variable
+    set reduced by the action, once per fetch generation, and stores the
+    sum, avg, min or max of the values in the reduction's expression
+    node.  The actions of a shared dispatch unit use one generation, so
+    a set they all reduce is fetched once for the unit.
+
+@param[in]
+    pActions
+        pointer to the Actions object
+
+@param[in]
+    pAction
+        pointer to the action about to run
+
+@return none
+
+==============================================================================*/
+static void RefreshReductions( Actions *pActions, Action *pAction )
+{
+    Reduction *pReduction;
+    VarSet *pSet;
+
+    if ( pAction->pReductions != NULL )
+    {
+        for ( pReduction = pAction->pReductions;
+              pReduction != NULL;
+              pReduction = pReduction->pNext )
+        {
+            pSet = pReduction->pSet;
+            if ( ( pSet != NULL ) && ( pSet->generation != fetchGeneration ) )
+            {
+                (void)FetchVarSet( pActions->hVarServer, pSet );
+                pSet->generation = fetchGeneration;
+            }
+
+            if ( pReduction->pVariable != NULL )
+            {
+                pReduction->pVariable->obj.val.f =
+                    (float)ReduceVarSet( pSet, pReduction->op );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  RunLoop                                                                   */
+/*!
+    Run a for each loop
+
+    The RunLoop function fetches the values of the loop's variable set,
+    and runs the loop body once for each value, with the value stored
+    in the loop variable.
+
+@param[in]
+    pActions
+        pointer to the Actions object
+
+@param[in]
+    pLoop
+        pointer to the loop to run
+
+@retval EOK the loop was run
+@retval EINVAL invalid arguments
+@retval other error from the last failed statement
+
+==============================================================================*/
+static int RunLoop( Actions *pActions, Loop *pLoop )
+{
+    int result;
+    int rc;
+    VarSet *pSet;
+    Variable *pVariable;
+    Statement *pStatement;
+    size_t i;
+
+    if ( ( pLoop == NULL ) ||
+         ( pLoop->pSet == NULL ) ||
+         ( pLoop->pVariable == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    pSet = pLoop->pSet;
+    pVariable = pLoop->pVariable;
+
+    result = FetchVarSet( pActions->hVarServer, pSet );
+
+    for ( i = 0; i < pSet->count; i++ )
+    {
+        if ( pSet->pObjects[i].type == pVariable->obj.type )
+        {
+            pVariable->obj.val = pSet->pObjects[i].val;
+        }
+        else
+        {
+            (void)ConvertValue( &pSet->pObjects[i], &pVariable->obj );
+        }
+
+        for ( pStatement = pLoop->pBody;
+              pStatement != NULL;
+              pStatement = pStatement->pNext )
+        {
+            rc = RunStatement( pActions, pStatement );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunStatement                                                              */
+/*!
+    Run a statement
+
+    The RunStatement function runs a statement of an action.  Scripts
+    are run by the watchdog component in a process group of their own,
+    so a script which exceeds the action's budget can be killed along
+    with everything it started.  All other statements are evaluated by
+    the expression library.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pStatement
+        pointer to the statement to run
+
+@retval EOK the statement was run
+@retval other error from running the statement
+
+==============================================================================*/
+static int RunStatement( Actions *pActions, Statement *pStatement )
+{
+    int result;
+
+    if ( ( pStatement->pVariable == NULL ) &&
+         ( pStatement->script != NULL ) )
+    {
+        result = RunScript( pStatement->script );
+    }
+    else
+    {
+        result = ProcessStatement( pActions->hVarServer, pStatement );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunAssignment                                                             */
+/*!
+    Run an assignment through the write queue
+
+    The RunAssignment function evaluates the expression of a queued
+    assignment into its hidden local variable, and queues the write of
+    the value to the assigned system variable.  Queued writes are only
+    waited for if the expression reads a variable which has one, so
+    consecutive assignments do not wait for each other's writes.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    pAssignment
+        pointer to the queued assignment to run
+
+@retval EOK the write was queued
+@retval EINVAL the assigned value could not be converted
+@retval other error from evaluating the expression or queueing the write
+
+==============================================================================*/
+static int RunAssignment( Actions *pActions, QueuedAssignment *pAssignment )
+{
+    int result;
+    VarRef *pRef;
+    VarObject *pValue;
+    VarObject obj;
+
+    for ( pRef = pAssignment->pReads; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( WritePending( pRef->hVar ) == true )
+        {
+            /* the expression must see the queued write */
+            (void)FlushWrites();
+            break;
+        }
+    }
+
+    result = RunStatement( pActions, pAssignment->pEvaluate );
+    if ( result == EOK )
+    {
+        pValue = &pAssignment->pLocal->obj;
+
+        memset( &obj, 0, sizeof( obj ) );
+        obj.type = pAssignment->type;
+
+        if ( pValue->type == obj.type )
+        {
+            obj.val = pValue->val;
+        }
+        else if ( pValue->type == VARTYPE_INT64 )
+        {
+            /* narrow the integer without a round trip through a double */
+            switch ( obj.type )
+            {
+                case VARTYPE_UINT16:
+                    obj.val.ui = (uint16_t)pValue->val.ll;
+                    break;
+
+                case VARTYPE_INT16:
+                    obj.val.i = (int16_t)pValue->val.ll;
+                    break;
+
+                case VARTYPE_UINT32:
+                    obj.val.ul = (uint32_t)pValue->val.ll;
+                    break;
+
+                case VARTYPE_INT32:
+                    obj.val.l = (int32_t)pValue->val.ll;
+                    break;
+
+                default:
+                    (void)ConvertValue( pValue, &obj );
+                    break;
+            }
+        }
+        else if ( ConvertValue( pValue, &obj ) == false )
+        {
+            result = EINVAL;
+        }
+
+        if ( result == EOK )
+        {
+            result = WriteVar( pActions->hVarServer,
+                               pAssignment->hTarget,
+                               &obj );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ToDouble                                                                  */
+/*!
+    Convert a numeric variable value to a double
+
+@param[in]
+    pObj
+        pointer to the variable value
+
+@param[out]
+    pValue
+        pointer to a location to store the converted value
+
+@retval true the value was converted
+@retval false the value is not numeric
+
+==============================================================================*/
+static bool ToDouble( VarObject *pObj, double *pValue )
+{
+    bool result = true;
+
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            *pValue = pObj->val.ui;
+            break;
+
+        case VARTYPE_INT16:
+            *pValue = pObj->val.i;
+            break;
+
+        case VARTYPE_UINT32:
+            *pValue = pObj->val.ul;
+            break;
+
+        case VARTYPE_INT32:
+            *pValue = pObj->val.l;
+            break;
+
+        case VARTYPE_UINT64:
+            *pValue = (double)pObj->val.ull;
+            break;
+
+        case VARTYPE_INT64:
+            *pValue = (double)pObj->val.ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            *pValue = pObj->val.f;
+            break;
+
+        default:
+            result = false;
+            break;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NowMs                                                                     */
+/*!
+    Get the current monotonic time
+
+@return the current CLOCK_MONOTONIC time in milliseconds
+
+==============================================================================*/
+static uint64_t NowMs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return ( (uint64_t)now.tv_sec * 1000 ) + ( now.tv_nsec / 1000000 );
+}
+
+/*============================================================================*/
+/*  BindTrigger                                                               */
+/*!
+    Bind an action's trigger references to the triggering variable
+
+    The BindTrigger function points all of the action's references
+    to its triggering variable at the variable which triggered
+    the current run of the action.
+
+@param[in]
+    pAction
+        pointer to the action about to run
+
+@param[in]
+    hVar
+        handle of the variable which triggered the action
+
+@return none
+
+==============================================================================*/
+static void BindTrigger( Action *pAction, VAR_HANDLE hVar )
+{
+    Trigger *pTrigger;
+    Signal *pSignal;
+
+    if ( pAction->pTriggers != NULL )
+    {
+        pSignal = FindSignal( pAction, hVar );
+        if ( ( pSignal != NULL ) && ( pSignal->pVariable != NULL ) )
+        {
+            for ( pTrigger = pAction->pTriggers;
+                  pTrigger != NULL;
+                  pTrigger = pTrigger->pNext )
+            {
+                pTrigger->pVariable->hVar = hVar;
+                pTrigger->pVariable->obj.type = pSignal->pVariable->obj.type;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  RestoreStatics                                                            */
+/*!
+    Restore the values of an action's static variables
+
+    The RestoreStatics function loads the values kept from the previous
+    execution of the action into its static local variables.
+
+@param[in]
+    pAction
+        pointer to the action about to run
+
+@return none
+
+==============================================================================*/
+static void RestoreStatics( Action *pAction )
+{
+    StaticVar *pStatic;
+
+    for ( pStatic = pAction->pStatics;
+          pStatic != NULL;
+          pStatic = pStatic->pNext )
+    {
+        pStatic->pVariable->obj.val = pStatic->value.val;
+    }
+}
+
+/*============================================================================*/
+/*  SaveStatics                                                               */
+/*!
+    Keep the values of an action's static variables
+
+    The SaveStatics function stores the values of the action's static
+    local variables for its next execution, and marks the variables
+    which have changed for checkpointing.
+
+@param[in]
+    pAction
+        pointer to the action which has run
+
+@return none
+
+==============================================================================*/
+static void SaveStatics( Action *pAction )
+{
+    StaticVar *pStatic;
+    VarObject *pObj;
+
+    for ( pStatic = pAction->pStatics;
+          pStatic != NULL;
+          pStatic = pStatic->pNext )
+    {
+        pObj = &pStatic->pVariable->obj;
+        if ( SameValue( pObj, &pStatic->value ) == false )
+        {
+            pStatic->value.type = pObj->type;
+            pStatic->value.val = pObj->val;
+            pStatic->dirty = true;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  StartCheckpoints                                                          */
+/*!
+    Start the static variable checkpoint timer
+
+    The StartCheckpoints function starts the periodic checkpoint timer if
+    any static variable has a checkpoint variable.  Termination requests
+    are then received by the engine thread, so the changes made since
+    the last periodic checkpoint are written before stopping.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the checkpoint timer was started, or is not needed
+@retval ENOENT the checkpoint timer could not be created
+
+==============================================================================*/
+static int StartCheckpoints( Actions *pActions )
+{
+    Action *pAction;
+    StaticVar *pStatic;
+    bool persist = false;
+    int result = EOK;
+
+    for ( pAction = pActions->pActionList;
+          ( pAction != NULL ) && ( persist == false );
+          pAction = pAction->pNext )
+    {
+        for ( pStatic = pAction->pStatics;
+              ( pStatic != NULL ) && ( persist == false );
+              pStatic = pStatic->pNext )
+        {
+            persist = ( pStatic->hCheckpoint != VAR_INVALID );
+        }
+    }
+
+    if ( persist == true )
+    {
+        catchStop = true;
+
+        if ( pActions->checkpointPeriod > 0 )
+        {
+            pActions->checkpointTimer =
+                CreateTick( pActions->checkpointPeriod, TIMESCALE_eSECONDS );
+
+            result = ( pActions->checkpointTimer > 0 ) ? EOK : ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LoadCheckpoints                                                           */
+/*!
+    Restore the static variables from their checkpoints
+
+    The LoadCheckpoints function initializes each static variable
+    which has a checkpoint variable with the checkpointed value.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@return none
+
+==============================================================================*/
+static void LoadCheckpoints( Actions *pActions )
+{
+    Action *pAction;
+    StaticVar *pStatic;
+    VarObject obj;
+
+    for ( pAction = pActions->pActionList;
+          pAction != NULL;
+          pAction = pAction->pNext )
+    {
+        for ( pStatic = pAction->pStatics;
+              pStatic != NULL;
+              pStatic = pStatic->pNext )
+        {
+            if ( pStatic->hCheckpoint == VAR_INVALID )
+            {
+                continue;
+            }
+
+            memset( &obj, 0, sizeof( VarObject ) );
+            if ( ( VAR_Get( pActions->hVarServer,
+                            pStatic->hCheckpoint,
+                            &obj ) == EOK ) &&
+                 ( ConvertValue( &obj, &pStatic->value ) == true ) )
+            {
+                pStatic->dirty = false;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  Checkpoint                                                                */
+/*!
+    Checkpoint the static variables
+
+    The Checkpoint function writes the value of each static variable
+    which has changed since the last checkpoint to its checkpoint variable.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@return none
+
+==============================================================================*/
+static void Checkpoint( Actions *pActions )
+{
+    Action *pAction;
+    StaticVar *pStatic;
+    VarObject obj;
+
+    for ( pAction = pActions->pActionList;
+          pAction != NULL;
+          pAction = pAction->pNext )
+    {
+        for ( pStatic = pAction->pStatics;
+              pStatic != NULL;
+              pStatic = pStatic->pNext )
+        {
+            if ( ( pStatic->hCheckpoint == VAR_INVALID ) ||
+                 ( pStatic->dirty == false ) )
+            {
+                continue;
+            }
+
+            obj = pStatic->value;
+            if ( WriteVar( pActions->hVarServer,
+                           pStatic->hCheckpoint,
+                           &obj ) == EOK )
+            {
+                pStatic->dirty = false;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  WarmStart                                                                 */
+/*!
+    Restore the engine state of a previous instance
+
+    The WarmStart function restores the engine state snapshot saved by a
+    previous instance running the same script, and starts the periodic
+    snapshot timer.  Termination requests are then received by the
+    engine thread, so a final snapshot can be saved before stopping.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval true the engine state was restored
+@retval false the engine must start cold
+
+==============================================================================*/
+static bool WarmStart( Actions *pActions )
+{
+    int rc;
+
+    if ( pActions->snapshotPath == NULL )
+    {
+        return false;
+    }
+
+    catchStop = true;
+
+    if ( pActions->checkpointPeriod > 0 )
+    {
+        pActions->snapshotTimer = CreateTick( pActions->checkpointPeriod,
+                                              TIMESCALE_eSECONDS );
+    }
+
+    rc = LoadSnapshot( pActions );
+    if ( ( rc != EOK ) && ( rc != ENOENT ) )
+    {
+        LogMessage( LOGLEVEL_eWARNING,
+                    "cannot restore snapshot %s: %s",
+                    pActions->snapshotPath,
+                    strerror( rc ) );
+    }
+
+    return ( rc == EOK );
+}
+
+/*============================================================================*/
+/*  WritesQueued                                                              */
+/*!
+    Check if an action uses variables with queued writes
+
+    The WritesQueued function checks if any of the system variables
+    read or written by an action still have queued writes.
+
+@param[in]
+    pAction
+        pointer to the action
+
+@retval true the action uses variables which may have queued writes
+@retval false none of the action's variables have queued writes
+
+==============================================================================*/
+static bool WritesQueued( Action *pAction )
+{
+    VarRef *pRef;
+
+    for ( pRef = pAction->pReads; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( WritePending( pRef->hVar ) == true )
+        {
+            return true;
+        }
+    }
+
+    for ( pRef = pAction->pWrites; pRef != NULL; pRef = pRef->pNext )
+    {
+        if ( WritePending( pRef->hVar ) == true )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*============================================================================*/
+/*  TakeSnapshot                                                              */
+/*!
+    Start the shared read snapshot of a dispatch unit
+
+    The TakeSnapshot function prepares the actions of a shared dispatch
+    unit at a priority level to run on one read snapshot.  The queued
+    writes are waited for once if any of the actions uses a variable
+    which has one, and the variable sets are fetched once for the
+    unit, by the first action which reduces them.  The snapshot ends
+    when an action outside of the unit runs, or when the unit is done.
+
+@param[in]
+    pUnit
+        pointer to the dispatch unit about to run (may be NULL)
+
+@param[in]
+    priority
+        priority level of the actions about to run
+
+@return none
+
+==============================================================================*/
+static void TakeSnapshot( DispatchUnit *pUnit, int priority )
+{
+    bool queued = false;
+    size_t i;
+
+    pSnapshot = NULL;
+
+    if ( ( pUnit != NULL ) && ( pUnit->shared == true ) )
+    {
+        for ( i = 0; ( queued == false ) && ( i < pUnit->count ); i++ )
+        {
+            if ( pUnit->ppActions[i]->priority == priority )
+            {
+                queued = WritesQueued( pUnit->ppActions[i] );
+            }
+        }
+
+        if ( queued == true )
+        {
+            /* one flush for all of the unit's actions */
+            (void)FlushWrites();
+        }
+
+        fetchGeneration++;
+        pSnapshot = pUnit;
+    }
+}
+
+/*============================================================================*/
+/*  InSnapshot                                                                */
+/*!
+    Check if an action runs on the shared read snapshot
+
+    The InSnapshot function checks if an action about to run belongs
+    to the dispatch unit of the current read snapshot.  Any other
+    action may write the unit's variables, so it ends the snapshot.
+
+@param[in]
+    pAction
+        pointer to the action about to run
+
+@retval true the action uses the shared read snapshot
+@retval false the action reads its own variables
+
+==============================================================================*/
+static bool InSnapshot( Action *pAction )
+{
+    bool result = false;
+    size_t i;
+
+    for ( i = 0; ( pSnapshot != NULL ) && ( i < pSnapshot->count ); i++ )
+    {
+        if ( pSnapshot->ppActions[i] == pAction )
+        {
+            result = true;
+            break;
+        }
+    }
+
+    if ( result == false )
+    {
+        pSnapshot = NULL;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StopActions                                                               */
+/*!
+    Stop the actions engine
+
+    The StopActions function checkpoints the static variables and saves
+    the final engine state snapshot when the engine has been asked to
+    terminate.  The checkpoint is written whether or not snapshots are
+    enabled, so a static variable changed since the last periodic
+    checkpoint is not lost.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@return none
+
+==============================================================================*/
+static void StopActions( Actions *pActions )
+{
+    int rc;
+
+    Checkpoint( pActions );
+
+    rc = ( pActions->snapshotPath != NULL ) ? SaveSnapshot( pActions ) : EOK;
+    if ( rc != EOK )
+    {
+        LogMessage( LOGLEVEL_eERROR,
+                    "cannot save snapshot %s: %s",
+                    pActions->snapshotPath,
+                    strerror( rc ) );
+    }
+}
+
+/*============================================================================*/
+/*  ConvertValue                                                              */
+/*!
+    Convert a numeric value to the type of another value
+
+@param[in]
+    pFrom
+        pointer to the value to convert
+
+@param[in,out]
+    pTo
+        pointer to the value to update.  Its type is unchanged.
+
+@retval true the value was converted
+@retval false the value could not be converted
+
+==============================================================================*/
+static bool ConvertValue( VarObject *pFrom, VarObject *pTo )
+{
+    double value;
+
+    if ( ToDouble( pFrom, &value ) == false )
+    {
+        return false;
+    }
+
+    switch ( pTo->type )
+    {
+        case VARTYPE_UINT16:    pTo->val.ui = (uint16_t)value; break;
+        case VARTYPE_INT16:     pTo->val.i = (int16_t)value; break;
+        case VARTYPE_UINT32:    pTo->val.ul = (uint32_t)value; break;
+        case VARTYPE_INT32:     pTo->val.l = (int32_t)value; break;
+        case VARTYPE_UINT64:    pTo->val.ull = (uint64_t)value; break;
+        case VARTYPE_INT64:     pTo->val.ll = (int64_t)value; break;
+        case VARTYPE_FLOAT:     pTo->val.f = (float)value; break;
+        default:                return false;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  RunDelay                                                                  */
+/*!
+    Run an after or cancel statement
+
+    The RunDelay function (re)starts the one-shot timer of an after
+    block, or stops the one-shot timers of all the action's after
+    blocks for a cancel statement.
+
+@param[in]
+    pAction
+        pointer to the action containing the statement
+
+@param[in]
+    pDelay
+        pointer to the delay to run
+
+@retval EOK the timers were started or stopped
+@retval EINVAL invalid arguments
+@retval other error from the timer
+
+==============================================================================*/
+static int RunDelay( Action *pAction, Delay *pDelay )
+{
+    int result = EINVAL;
+    int rc;
+    Delay *pCancel;
+
+    if ( ( pAction != NULL ) && ( pDelay != NULL ) )
+    {
+        if ( pDelay->pTarget != NULL )
+        {
+            result = StartOneShot( pDelay->pTarget->timerID, pDelay->ms );
+        }
+        else
+        {
+            result = EOK;
+            for ( pCancel = pAction->pDelays;
+                  pCancel != NULL;
+                  pCancel = pCancel->pNext )
+            {
+                if ( pCancel->pTarget != NULL )
+                {
+                    rc = CancelOneShot( pCancel->pTarget->timerID );
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ActiveUnit                                                                */
+/*!
+    Find the enabled dispatch unit of a signal
+
+    The ActiveUnit function finds the dispatch unit of a change
+    notification, unless its trigger has been disabled through the
+    control interface.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    signum
+        signal number
+
+@param[in]
+    id
+        signal identifier
+
+@retval pointer to the dispatch unit of the signal
+@retval NULL no enabled actions are triggered by the signal
+
+==============================================================================*/
+static DispatchUnit *ActiveUnit( Actions *pActions, int signum, int id )
+{
+    DispatchUnit *pUnit = FindDispatchUnit( pActions, signum, id );
+
+    return ( ( pUnit != NULL ) && ( pUnit->disabled == false ) ) ? pUnit
+                                                                 : NULL;
+}
+
 #endif
 
 /*! @}
@@ -0,0 +1,506 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup guard guard
+ * @brief Action guard expressions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file guard.c
+
+    Action Guards
+
+    The guard component evaluates the when clauses of actions, such as
+
+    on change /sys/test/a when /sys/uptime/enable > 0 { ... }
+
+    before the actions are run.  A guard is a numeric expression of
+    comparisons and logical operators over constants and system
+    variables.  The values of the system variables are cached, and
+    updated when their change notifications are received, so a guard
+    is evaluated without any VarServer requests.
+
+    - build guard expressions
+    - cache the values of the guard inputs
+    - evaluate guard expressions
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "guard.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static double GuardValue( Guard *pGuard );
+static bool ObjectToDouble( VarObject *pObj, double *pValue );
+static int ReadGuardInput( VARSERVER_HANDLE hVarServer, GuardInput *pInput );
+
+/*==============================================================================
+       File Scoped Variables
+==============================================================================*/
+
+/*! list of the system variables used by guards */
+static GuardInput *pGuardInputs = NULL;
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewGuard                                                                  */
+/*!
+    Create a guard operation
+
+    The NewGuard function creates a guard expression node which applies
+    an operation to one or two operands
+
+@param[in]
+    op
+        the guard operation
+
+@param[in]
+    pLeft
+        pointer to the left (or only) operand
+
+@param[in]
+    pRight
+        pointer to the right operand, or NULL for a unary operation
+
+@retval pointer to the guard expression node
+@retval NULL if an error occurred
+
+==============================================================================*/
+Guard *NewGuard( GuardOp op, Guard *pLeft, Guard *pRight )
+{
+    Guard *pGuard = NULL;
+
+    if ( ( pLeft != NULL ) &&
+         ( ( pRight != NULL ) || ( op == GUARD_eNOT ) ) )
+    {
+        pGuard = (Guard *)calloc( 1, sizeof( Guard ) );
+        if ( pGuard != NULL )
+        {
+            pGuard->op = op;
+            pGuard->pLeft = pLeft;
+            pGuard->pRight = pRight;
+        }
+    }
+
+    return pGuard;
+}
+
+/*============================================================================*/
+/*  NewGuardConstant                                                          */
+/*!
+    Create a guard constant
+
+    The NewGuardConstant function creates a guard expression node
+    for a numeric constant
+
+@param[in]
+    pObj
+        pointer to the value of the constant
+
+@retval pointer to the guard expression node
+@retval NULL if an error occurred
+
+==============================================================================*/
+Guard *NewGuardConstant( VarObject *pObj )
+{
+    Guard *pGuard = NULL;
+    double value;
+
+    if ( ( pObj != NULL ) && ( ObjectToDouble( pObj, &value ) == true ) )
+    {
+        pGuard = (Guard *)calloc( 1, sizeof( Guard ) );
+        if ( pGuard != NULL )
+        {
+            pGuard->op = GUARD_eCONSTANT;
+            pGuard->value = value;
+        }
+    }
+
+    return pGuard;
+}
+
+/*============================================================================*/
+/*  NewGuardInput                                                             */
+/*!
+    Create a guard system variable reference
+
+    The NewGuardInput function creates a guard expression node which
+    refers to the cached value of a system variable.  Each system
+    variable is cached once, regardless of how many guards use it.
+
+@param[in]
+    hVar
+        handle of the system variable
+
+@param[in]
+    type
+        type of the system variable
+
+@retval pointer to the guard expression node
+@retval NULL if an error occurred
+
+==============================================================================*/
+Guard *NewGuardInput( VAR_HANDLE hVar, int type )
+{
+    Guard *pGuard = NULL;
+    GuardInput *pInput;
+
+    if ( ( hVar == VAR_INVALID ) ||
+         ( type == VARTYPE_STR ) ||
+         ( type == VARTYPE_BLOB ) )
+    {
+        return NULL;
+    }
+
+    for ( pInput = pGuardInputs; pInput != NULL; pInput = pInput->pNext )
+    {
+        if ( pInput->hVar == hVar )
+        {
+            break;
+        }
+    }
+
+    if ( pInput == NULL )
+    {
+        pInput = (GuardInput *)calloc( 1, sizeof( GuardInput ) );
+        if ( pInput == NULL )
+        {
+            return NULL;
+        }
+
+        pInput->hVar = hVar;
+        pInput->type = type;
+        pInput->pNext = pGuardInputs;
+        pGuardInputs = pInput;
+    }
+
+    pGuard = (Guard *)calloc( 1, sizeof( Guard ) );
+    if ( pGuard != NULL )
+    {
+        pGuard->op = GUARD_eINPUT;
+        pGuard->pInput = pInput;
+    }
+
+    return pGuard;
+}
+
+/*============================================================================*/
+/*  EvalGuard                                                                 */
+/*!
+    Evaluate a guard
+
+    The EvalGuard function evaluates a guard expression using the
+    cached values of its system variables
+
+@param[in]
+    pGuard
+        pointer to the guard expression
+
+@retval true the guard is satisfied, or there is no guard
+@retval false the guard is not satisfied
+
+==============================================================================*/
+bool EvalGuard( Guard *pGuard )
+{
+    return ( pGuard == NULL ) || ( GuardValue( pGuard ) != 0.0 );
+}
+
+/*============================================================================*/
+/*  UpdateGuardInput                                                          */
+/*!
+    Update a cached guard input
+
+    The UpdateGuardInput function reads the value of a system variable
+    into the guard input cache, if the variable is used by a guard.
+    It is called when a change notification for the variable is
+    received.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    hVar
+        handle of the system variable which changed
+
+@retval EOK the cached value was updated
+@retval ENOENT the variable is not used by a guard
+@retval other error from the variable server
+
+==============================================================================*/
+int UpdateGuardInput( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar )
+{
+    GuardInput *pInput;
+
+    for ( pInput = pGuardInputs; pInput != NULL; pInput = pInput->pNext )
+    {
+        if ( pInput->hVar == hVar )
+        {
+            return ReadGuardInput( hVarServer, pInput );
+        }
+    }
+
+    return ENOENT;
+}
+
+/*============================================================================*/
+/*  RefreshGuardInputs                                                        */
+/*!
+    Refresh all the cached guard inputs
+
+    The RefreshGuardInputs function reads the values of all the system
+    variables used by guards.  It is called on start-up, and when
+    change notifications may have been lost.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+==============================================================================*/
+void RefreshGuardInputs( VARSERVER_HANDLE hVarServer )
+{
+    GuardInput *pInput;
+
+    for ( pInput = pGuardInputs; pInput != NULL; pInput = pInput->pNext )
+    {
+        (void)ReadGuardInput( hVarServer, pInput );
+    }
+}
+
+/*============================================================================*/
+/*  GuardValue                                                                */
+/*!
+    Calculate the value of a guard expression
+
+    The GuardValue function recursively calculates the value of a
+    guard expression node.  Comparisons and logical operations have
+    the value 1.0 when true and 0.0 when false.  Logical operations
+    are short-circuited.
+
+@param[in]
+    pGuard
+        pointer to the guard expression node
+
+@retval the value of the guard expression node
+
+==============================================================================*/
+static double GuardValue( Guard *pGuard )
+{
+    double left;
+    double right;
+    bool result;
+
+    switch ( pGuard->op )
+    {
+        case GUARD_eCONSTANT:
+            return pGuard->value;
+
+        case GUARD_eINPUT:
+            return pGuard->pInput->value;
+
+        case GUARD_eNOT:
+            return ( GuardValue( pGuard->pLeft ) == 0.0 ) ? 1.0 : 0.0;
+
+        case GUARD_eAND:
+            result = ( GuardValue( pGuard->pLeft ) != 0.0 ) &&
+                     ( GuardValue( pGuard->pRight ) != 0.0 );
+            return result ? 1.0 : 0.0;
+
+        case GUARD_eOR:
+            result = ( GuardValue( pGuard->pLeft ) != 0.0 ) ||
+                     ( GuardValue( pGuard->pRight ) != 0.0 );
+            return result ? 1.0 : 0.0;
+
+        default:
+            break;
+    }
+
+    left = GuardValue( pGuard->pLeft );
+    right = GuardValue( pGuard->pRight );
+
+    switch ( pGuard->op )
+    {
+        case GUARD_eEQUALS:
+            result = ( left == right );
+            break;
+
+        case GUARD_eNOTEQUALS:
+            result = ( left != right );
+            break;
+
+        case GUARD_eLT:
+            result = ( left < right );
+            break;
+
+        case GUARD_eGT:
+            result = ( left > right );
+            break;
+
+        case GUARD_eLTE:
+            result = ( left <= right );
+            break;
+
+        case GUARD_eGTE:
+            result = ( left >= right );
+            break;
+
+        default:
+            result = false;
+            break;
+    }
+
+    return result ? 1.0 : 0.0;
+}
+
+/*============================================================================*/
+/*  ReadGuardInput                                                            */
+/*!
+    Read a guard input
+
+    The ReadGuardInput function reads the value of a guard input's
+    system variable into its cache
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pInput
+        pointer to the guard input
+
+@retval EOK the cached value was updated
+@retval ENOTSUP the variable is not numeric
+@retval other error from the variable server
+
+==============================================================================*/
+static int ReadGuardInput( VARSERVER_HANDLE hVarServer, GuardInput *pInput )
+{
+    VarObject obj;
+    int result;
+
+    memset( &obj, 0, sizeof( VarObject ) );
+    obj.type = pInput->type;
+
+    result = VAR_Get( hVarServer, pInput->hVar, &obj );
+    if ( result == EOK )
+    {
+        if ( ObjectToDouble( &obj, &pInput->value ) == false )
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ObjectToDouble                                                            */
+/*!
+    Convert a numeric variable value to a double
+
+    The ObjectToDouble function converts a numeric VarObject to a double
+
+@param[in]
+    pObj
+        pointer to the variable value
+
+@param[out]
+    pValue
+        pointer to the location to store the converted value
+
+@retval true the value was converted
+@retval false the value is not numeric
+
+==============================================================================*/
+static bool ObjectToDouble( VarObject *pObj, double *pValue )
+{
+    bool result = true;
+
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            *pValue = pObj->val.ui;
+            break;
+
+        case VARTYPE_INT16:
+            *pValue = pObj->val.i;
+            break;
+
+        case VARTYPE_UINT32:
+            *pValue = pObj->val.ul;
+            break;
+
+        case VARTYPE_INT32:
+            *pValue = pObj->val.l;
+            break;
+
+        case VARTYPE_UINT64:
+            *pValue = (double)pObj->val.ull;
+            break;
+
+        case VARTYPE_INT64:
+            *pValue = (double)pObj->val.ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            *pValue = pObj->val.f;
+            break;
+
+        default:
+            result = false;
+            break;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of guard group */
@@ -0,0 +1,420 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup include include
+ * @brief Action script include files
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file include.c
+
+    Action Script Include Files
+
+    The include component locates the files referenced by include
+    directives, and keeps track of the files which have been included
+    so each file is parsed only once, no matter how many scripts or
+    modules include it.
+
+    Script files are memory mapped, so the lexical analyzer scans them
+    in place instead of reading them through a stdio buffer.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "include.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! included file */
+typedef struct _includedFile
+{
+    /*! canonical path of the included file */
+    char *path;
+
+    /*! pointer to the next included file */
+    struct _includedFile *pNext;
+} IncludedFile;
+
+/*! 64-bit FNV-1a offset basis */
+#define FNV_OFFSET_BASIS ( 14695981039346656037ULL )
+
+/*! 64-bit FNV-1a prime */
+#define FNV_PRIME ( 1099511628211ULL )
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! list of files which have been included */
+static IncludedFile *pIncluded = NULL;
+
+/*! FNV-1a hash of the content of every script file mapped so far */
+static uint64_t scriptHash = FNV_OFFSET_BASIS;
+
+/*! true if some of the script was read without being hashed */
+static bool unhashed = false;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static char *ResolveIn( char *dir, size_t len, char *name );
+static void HashScript( char *base, size_t length );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ResolveInclude                                                            */
+/*!
+    Locate an include file
+
+    The ResolveInclude function gets the canonical path of an include file.
+    Relative file names are searched for in the directory of the including
+    file, and then in the INCLUDE_DIR directory.
+
+@param[in]
+    name
+        the name of the include file
+
+@param[in]
+    includer
+        the path of the including file, or NULL to resolve the name
+        relative to the current directory
+
+@retval the canonical path of the include file, which must be freed
+        by the caller
+@retval NULL if the file was not found
+
+==============================================================================*/
+char *ResolveInclude( char *name, char *includer )
+{
+    char *path = NULL;
+    char *slash;
+
+    if ( name == NULL )
+    {
+        return NULL;
+    }
+
+    if ( ( name[0] == '/' ) || ( includer == NULL ) )
+    {
+        path = realpath( name, NULL );
+    }
+    else
+    {
+        slash = strrchr( includer, '/' );
+        if ( slash != NULL )
+        {
+            path = ResolveIn( includer, (size_t)( slash - includer ), name );
+        }
+        else
+        {
+            path = realpath( name, NULL );
+        }
+
+        if ( path == NULL )
+        {
+            path = ResolveIn( INCLUDE_DIR, strlen( INCLUDE_DIR ), name );
+        }
+    }
+
+    return path;
+}
+
+/*============================================================================*/
+/*  MarkIncluded                                                              */
+/*!
+    Record an included file
+
+    The MarkIncluded function records that a file has been included.
+    The include guard list takes ownership of the path if the file has
+    not already been included.
+
+@param[in]
+    path
+        the canonical path of the included file
+
+@retval true the file has not been included before
+@retval false the file has already been included
+
+==============================================================================*/
+bool MarkIncluded( char *path )
+{
+    IncludedFile *pFile;
+
+    if ( path == NULL )
+    {
+        return false;
+    }
+
+    for ( pFile = pIncluded; pFile != NULL; pFile = pFile->pNext )
+    {
+        if ( strcmp( pFile->path, path ) == 0 )
+        {
+            return false;
+        }
+    }
+
+    pFile = (IncludedFile *)calloc( 1, sizeof( IncludedFile ) );
+    if ( pFile != NULL )
+    {
+        pFile->path = path;
+        pFile->pNext = pIncluded;
+        pIncluded = pFile;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  MapScript                                                                 */
+/*!
+    Map an action script into memory
+
+    The MapScript function maps an action script file into private,
+    writable memory, followed by the two NUL characters which the
+    lexical analyzer requires at the end of a buffer which it scans
+    in place.  The file is mapped over a zero filled anonymous mapping
+    one page longer than needed, so the NUL characters exist even when
+    the file ends at a page boundary.
+
+@param[in]
+    path
+        path of the action script
+
+@param[out]
+    pLength
+        pointer to the location to store the length of the script
+
+@retval pointer to the mapped script
+@retval NULL the script could not be mapped
+
+==============================================================================*/
+char *MapScript( char *path, size_t *pLength )
+{
+    struct stat st;
+    char *base = NULL;
+    size_t size;
+    void *p;
+    int fd;
+
+    if ( ( path == NULL ) || ( pLength == NULL ) )
+    {
+        return NULL;
+    }
+
+    fd = open( path, O_RDONLY | O_CLOEXEC );
+    if ( fd == -1 )
+    {
+        return NULL;
+    }
+
+    if ( ( fstat( fd, &st ) == 0 ) && ( S_ISREG( st.st_mode ) ) )
+    {
+        size = (size_t)st.st_size;
+
+        p = mmap( NULL,
+                  size + 2,
+                  PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS,
+                  -1,
+                  0 );
+        if ( p != MAP_FAILED )
+        {
+            base = (char *)p;
+            if ( ( size > 0 ) &&
+                 ( mmap( base,
+                         size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED,
+                         fd,
+                         0 ) == MAP_FAILED ) )
+            {
+                munmap( base, size + 2 );
+                base = NULL;
+            }
+            else
+            {
+                *pLength = size;
+                HashScript( base, size );
+            }
+        }
+    }
+
+    close( fd );
+
+    return base;
+}
+
+/*============================================================================*/
+/*  UnmapScript                                                               */
+/*!
+    Unmap an action script
+
+    The UnmapScript function releases a script mapped by MapScript.
+
+@param[in]
+    base
+        pointer to the mapped script
+
+@param[in]
+    length
+        length of the script returned by MapScript
+
+@return none
+
+==============================================================================*/
+void UnmapScript( char *base, size_t length )
+{
+    if ( base != NULL )
+    {
+        munmap( base, length + 2 );
+    }
+}
+
+/*============================================================================*/
+/*  ScriptHash                                                                */
+/*!
+    Get the hash of the action script
+
+    The ScriptHash function gets a hash of the content of the action
+    script and every file it included, in the order they were read.
+    It identifies the script a snapshot of the engine state was
+    taken from.
+
+@retval the hash of the action script
+@retval 0 the script was not completely hashed
+
+==============================================================================*/
+uint64_t ScriptHash( void )
+{
+    return ( ( unhashed == false ) && ( scriptHash != 0 ) ) ? scriptHash : 0;
+}
+
+/*============================================================================*/
+/*  DiscardScriptHash                                                         */
+/*!
+    Discard the hash of the action script
+
+    The DiscardScriptHash function records that part of the action
+    script was read without being mapped by MapScript, so its hash
+    cannot be relied on.
+
+@return none
+
+==============================================================================*/
+void DiscardScriptHash( void )
+{
+    unhashed = true;
+}
+
+/*============================================================================*/
+/*  HashScript                                                                */
+/*!
+    Add a script file to the script hash
+
+    The HashScript function adds the content of a mapped script file
+    to the FNV-1a hash of the action script.
+
+@param[in]
+    base
+        pointer to the mapped script file
+
+@param[in]
+    length
+        length of the script file
+
+@return none
+
+==============================================================================*/
+static void HashScript( char *base, size_t length )
+{
+    size_t i;
+
+    for ( i = 0; i < length; i++ )
+    {
+        scriptHash ^= (unsigned char)base[i];
+        scriptHash *= FNV_PRIME;
+    }
+}
+
+/*============================================================================*/
+/*  ResolveIn                                                                 */
+/*!
+    Locate a file in a directory
+
+@param[in]
+    dir
+        the directory to search
+
+@param[in]
+    len
+        the length of the directory name
+
+@param[in]
+    name
+        the relative name of the file
+
+@retval the canonical path of the file, which must be freed by the caller
+@retval NULL if the file was not found
+
+==============================================================================*/
+static char *ResolveIn( char *dir, size_t len, char *name )
+{
+    char candidate[PATH_MAX];
+    int n;
+
+    n = snprintf( candidate, sizeof( candidate ), "%.*s/%s",
+                  (int)len, dir, name );
+    if ( ( n < 0 ) || ( (size_t)n >= sizeof( candidate ) ) )
+    {
+        return NULL;
+    }
+
+    return realpath( candidate, NULL );
+}
+
+/*! @}
+ * end of include group */
@@ -0,0 +1,254 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup intern intern
+ * @brief Interned strings
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file intern.c
+
+    Interned Strings
+
+    The intern component keeps a single copy of each distinct string
+    which the parser stores for the lifetime of the program, such as
+    the text of embedded scripts.  Generated action scripts often
+    repeat the same text many times, and interning it saves both the
+    memory and the allocations of the duplicates.
+
+    Interned strings are shared, and must never be modified or freed.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "intern.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! interned string */
+typedef struct _internedString
+{
+    /*! hash of the string */
+    uint32_t hash;
+
+    /*! length of the string */
+    size_t len;
+
+    /*! pointer to the next string in the same bucket */
+    struct _internedString *pNext;
+
+    /*! NUL terminated string text */
+    char text[];
+} InternedString;
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! hash table of interned strings */
+static InternedString **ppTable = NULL;
+
+/*! number of buckets in the hash table (a power of two) */
+static size_t numBuckets = 0;
+
+/*! number of interned strings */
+static size_t numStrings = 0;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static uint32_t Hash( const char *text, size_t len );
+static void Grow( void );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Intern                                                                    */
+/*!
+    Intern a string
+
+    The Intern function gets the shared copy of a string, creating it
+    if the string has not been interned before.
+
+@param[in]
+    text
+        pointer to the string text, which need not be NUL terminated
+
+@param[in]
+    len
+        length of the string text
+
+@retval pointer to the NUL terminated shared copy of the string
+@retval NULL invalid arguments or memory allocation failed
+
+==============================================================================*/
+char *Intern( const char *text, size_t len )
+{
+    InternedString *pString;
+    uint32_t hash;
+    size_t bucket;
+
+    if ( text == NULL )
+    {
+        return NULL;
+    }
+
+    if ( numStrings >= numBuckets )
+    {
+        Grow();
+        if ( ppTable == NULL )
+        {
+            return NULL;
+        }
+    }
+
+    hash = Hash( text, len );
+    bucket = hash & ( numBuckets - 1 );
+
+    for ( pString = ppTable[bucket];
+          pString != NULL;
+          pString = pString->pNext )
+    {
+        if ( ( pString->hash == hash ) &&
+             ( pString->len == len ) &&
+             ( memcmp( pString->text, text, len ) == 0 ) )
+        {
+            return pString->text;
+        }
+    }
+
+    pString = (InternedString *)malloc( sizeof( InternedString ) + len + 1 );
+    if ( pString == NULL )
+    {
+        return NULL;
+    }
+
+    pString->hash = hash;
+    pString->len = len;
+    memcpy( pString->text, text, len );
+    pString->text[len] = '\0';
+
+    pString->pNext = ppTable[bucket];
+    ppTable[bucket] = pString;
+    numStrings++;
+
+    return pString->text;
+}
+
+/*============================================================================*/
+/*  Hash                                                                      */
+/*!
+    Hash a string
+
+    The Hash function calculates the 32-bit FNV-1a hash of a string.
+
+@param[in]
+    text
+        pointer to the string text
+
+@param[in]
+    len
+        length of the string text
+
+@retval hash of the string
+
+==============================================================================*/
+static uint32_t Hash( const char *text, size_t len )
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Grow the string table
+
+    The Grow function doubles the number of buckets in the string table,
+    so the average bucket holds at most one string.  The table is left
+    unchanged if memory allocation fails.
+
+@return none
+
+==============================================================================*/
+static void Grow( void )
+{
+    InternedString **ppNew;
+    InternedString *pString;
+    InternedString *pNext;
+    size_t count;
+    size_t bucket;
+    size_t i;
+
+    count = ( numBuckets == 0 ) ? MIN_INTERN_BUCKETS : numBuckets * 2;
+
+    ppNew = (InternedString **)calloc( count, sizeof( InternedString * ) );
+    if ( ppNew == NULL )
+    {
+        return;
+    }
+
+    for ( i = 0; i < numBuckets; i++ )
+    {
+        for ( pString = ppTable[i]; pString != NULL; pString = pNext )
+        {
+            pNext = pString->pNext;
+            bucket = pString->hash & ( count - 1 );
+            pString->pNext = ppNew[bucket];
+            ppNew[bucket] = pString;
+        }
+    }
+
+    free( ppTable );
+    ppTable = ppNew;
+    numBuckets = count;
+}
+
+/*! @}
+ * end of intern group */
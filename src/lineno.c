@@ -42,6 +42,12 @@ SOFTWARE.
 /*! track the line number being parsed */
 static int lineno = 0;
 
+/*! total number of lines parsed, including included files */
+static int linecount = 0;
+
+/*! track the included file being parsed */
+static char *filename = NULL;
+
 /*==============================================================================
        Function definitions
 ==============================================================================*/
@@ -77,6 +83,80 @@ int getlineno( void )
 void incrementLineNumber( void )
 {
     lineno++;
+    linecount++;
+}
+
+/*============================================================================*/
+/*  getlinecount                                                              */
+/*!
+    Get the number of lines parsed
+
+    The getlinecount function returns the total number of lines parsed,
+    including the lines of included files and template expansions.
+
+@return the number of lines parsed
+
+==============================================================================*/
+int getlinecount( void )
+{
+    return linecount;
+}
+
+/*============================================================================*/
+/*  setlineno                                                                 */
+/*!
+    Set the current line number
+
+    The setlineno function sets the current line number being parsed.
+    It is used to restore the line number after parsing expanded text.
+
+@param[in]
+    n
+        the new line number
+
+@return none
+
+==============================================================================*/
+void setlineno( int n )
+{
+    lineno = n;
+}
+
+/*============================================================================*/
+/*  getfilename                                                               */
+/*!
+    Get File Name
+
+    The getfilename function returns the name of the included file
+    being parsed.
+
+@retval the name of the included file being parsed
+@retval NULL if the top level action script is being parsed
+
+==============================================================================*/
+char *getfilename( void )
+{
+    return filename;
+}
+
+/*============================================================================*/
+/*  setfilename                                                               */
+/*!
+    Set the current file name
+
+    The setfilename function sets the name of the included file
+    being parsed.
+
+@param[in]
+    name
+        the name of the included file, or NULL for the top level script
+
+@return none
+
+==============================================================================*/
+void setfilename( char *name )
+{
+    filename = name;
 }
 
 /*! @}
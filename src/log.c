@@ -0,0 +1,789 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup log log
+ * @brief Asynchronous logging
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file log.c
+
+    Asynchronous Logging
+
+    The log component records diagnostics from the actions engine
+    without blocking it.  Log records are claimed from a fixed size
+    lock-free ring buffer, which supports any number of writer threads,
+    and are formatted and written to syslog, the standard output or
+    error streams, or a file, by a background thread.
+
+    Frequent engine events are logged as structured records (a code and
+    up to three numeric arguments), so the engine thread does not format
+    any text.  A record which does not fit in the ring buffer is dropped,
+    and the number of dropped records is reported by the log thread.
+
+    The log thread sleeps on a semaphore while the ring buffer is empty.
+    The writer which publishes the first record into an empty ring
+    buffer posts the semaphore, so an idle engine causes no wakeups,
+    and a busy one posts it once per batch of records.
+
+    - parse log levels
+    - start and stop the log thread
+    - write log records
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "log.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! number of records in the log ring buffer (a power of two) */
+#define LOG_RING_SIZE ( 1024 )
+
+/*! maximum length of the text of a log record */
+#define LOG_TEXT_LEN ( 160 )
+
+/*! log record */
+typedef struct _logSlot
+{
+    /*! ring sequence number which says who owns the slot */
+    size_t sequence;
+
+    /*! log level */
+    LogLevel level;
+
+    /*! record code */
+    LogCode code;
+
+    /*! time the record was written (CLOCK_REALTIME) */
+    struct timespec time;
+
+    /*! numeric arguments of a structured record */
+    int64_t args[3];
+
+    /*! text of a LOGCODE_eTEXT record */
+    char text[LOG_TEXT_LEN];
+} LogSlot;
+
+/*! log output destinations */
+typedef enum
+{
+    LOGTARGET_eSYSLOG = 0,
+    LOGTARGET_eSTDOUT,
+    LOGTARGET_eSTDERR,
+    LOGTARGET_eFILE
+} LogTarget;
+
+/*! log record ring buffer */
+static LogSlot ring[LOG_RING_SIZE];
+
+/*! position of the next record to write */
+static size_t head = 0;
+
+/*! position of the next record to drain */
+static size_t tail = 0;
+
+/*! number of published records which have not been drained yet */
+static size_t published = 0;
+
+/*! wakes the log thread when the ring buffer becomes non-empty */
+static sem_t wakeup;
+
+/*! number of records dropped because the ring buffer was full */
+static uint64_t dropped = 0;
+
+/*! default log level */
+static LogLevel logLevel = LOGLEVEL_eWARNING;
+
+/*! log output destination */
+static LogTarget logTarget = LOGTARGET_eSTDERR;
+
+/*! log output file */
+static FILE *logFile = NULL;
+
+/*! log thread */
+static pthread_t logThread;
+
+/*! flag indicating the log thread is running */
+static bool running = false;
+
+/*! log level names, indexed by LogLevel */
+static const char *levelNames[] =
+{
+    "default",
+    "none",
+    "error",
+    "warning",
+    "info",
+    "debug"
+};
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static LogSlot *ClaimSlot( LogLevel level, LogCode code );
+static void PublishSlot( LogSlot *pSlot );
+static void *LogThread( void *arg );
+static size_t DrainLog( void );
+static void WriteRecord( LogSlot *pSlot );
+static void WriteText( LogLevel level, struct timespec *pTime, char *text );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseLogLevel                                                             */
+/*!
+    Parse a log level name
+
+    The ParseLogLevel function converts a log level name (none, error,
+    warning, info or debug) to a log level
+
+@param[in]
+    name
+        pointer to the log level name
+
+@param[out]
+    pLevel
+        pointer to the location to store the log level
+
+@retval EOK the log level was parsed
+@retval EINVAL invalid log level name
+
+==============================================================================*/
+int ParseLogLevel( const char *name, LogLevel *pLevel )
+{
+    size_t i;
+
+    if ( ( name == NULL ) || ( pLevel == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    for ( i = LOGLEVEL_eNONE; i <= LOGLEVEL_eDEBUG; i++ )
+    {
+        if ( strcmp( name, levelNames[i] ) == 0 )
+        {
+            *pLevel = (LogLevel)i;
+            return EOK;
+        }
+    }
+
+    return EINVAL;
+}
+
+/*============================================================================*/
+/*  StartLog                                                                  */
+/*!
+    Start the log thread
+
+    The StartLog function sets the default log level and the log output
+    destination, and starts the thread which drains the log ring buffer.
+    The destination is "syslog", "stdout", "stderr", or the name of a
+    file to append to.  If no destination is specified, records are
+    written to the standard error stream if it is a terminal, and to
+    syslog otherwise.
+
+@param[in]
+    level
+        default log level
+
+@param[in]
+    target
+        pointer to the log destination, or NULL for the default
+
+@retval EOK the log thread was started
+@retval EINVAL invalid arguments
+@retval other error from opening the log file or creating the thread
+
+==============================================================================*/
+int StartLog( LogLevel level, const char *target )
+{
+    size_t i;
+    int rc;
+    sigset_t mask;
+    sigset_t old;
+
+    if ( ( level == LOGLEVEL_eDEFAULT ) || ( level > LOGLEVEL_eDEBUG ) )
+    {
+        return EINVAL;
+    }
+
+    logLevel = level;
+
+    for ( i = 0; i < LOG_RING_SIZE; i++ )
+    {
+        ring[i].sequence = i;
+    }
+
+    if ( target == NULL )
+    {
+        logTarget = isatty( STDERR_FILENO ) ? LOGTARGET_eSTDERR
+                                            : LOGTARGET_eSYSLOG;
+    }
+    else if ( strcmp( target, "syslog" ) == 0 )
+    {
+        logTarget = LOGTARGET_eSYSLOG;
+    }
+    else if ( strcmp( target, "stdout" ) == 0 )
+    {
+        logTarget = LOGTARGET_eSTDOUT;
+    }
+    else if ( strcmp( target, "stderr" ) == 0 )
+    {
+        logTarget = LOGTARGET_eSTDERR;
+    }
+    else
+    {
+        logFile = fopen( target, "a" );
+        if ( logFile == NULL )
+        {
+            return errno;
+        }
+
+        logTarget = LOGTARGET_eFILE;
+    }
+
+    if ( sem_init( &wakeup, 0, 0 ) != 0 )
+    {
+        return errno;
+    }
+
+    __atomic_store_n( &published, 0, __ATOMIC_RELAXED );
+
+    /* the log thread must not receive the notification signals, which
+       are process directed, and are collected by the engine thread */
+    sigfillset( &mask );
+    pthread_sigmask( SIG_SETMASK, &mask, &old );
+
+    __atomic_store_n( &running, true, __ATOMIC_RELEASE );
+    rc = pthread_create( &logThread, NULL, LogThread, NULL );
+    pthread_sigmask( SIG_SETMASK, &old, NULL );
+    if ( rc != 0 )
+    {
+        __atomic_store_n( &running, false, __ATOMIC_RELEASE );
+        sem_destroy( &wakeup );
+        return rc;
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  StopLog                                                                   */
+/*!
+    Stop the log thread
+
+    The StopLog function stops the log thread after it has written
+    all of the records in the ring buffer.
+
+==============================================================================*/
+void StopLog( void )
+{
+    if ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == true )
+    {
+        __atomic_store_n( &running, false, __ATOMIC_RELEASE );
+        sem_post( &wakeup );
+        pthread_join( logThread, NULL );
+    }
+
+    (void)DrainLog();
+
+    if ( logFile != NULL )
+    {
+        fclose( logFile );
+        logFile = NULL;
+    }
+}
+
+/*============================================================================*/
+/*  LogEnabled                                                                */
+/*!
+    Check if a log level is enabled
+
+    The LogEnabled function checks if records of the specified level
+    are logged, using the override level (such as an action's log level)
+    if there is one, and the default log level otherwise.  Callers check
+    the level before building a record, so disabled records cost only
+    this comparison.
+
+@param[in]
+    level
+        level of the record to log
+
+@param[in]
+    override
+        log level which overrides the default, or LOGLEVEL_eDEFAULT
+
+@retval true records of the specified level are logged
+@retval false records of the specified level are discarded
+
+==============================================================================*/
+bool LogEnabled( LogLevel level, LogLevel override )
+{
+    LogLevel limit = ( override != LOGLEVEL_eDEFAULT ) ? override : logLevel;
+
+    return ( level > LOGLEVEL_eNONE ) && ( level <= limit );
+}
+
+/*============================================================================*/
+/*  LogRecord                                                                 */
+/*!
+    Log a structured record
+
+    The LogRecord function writes a record with a code and numeric
+    arguments to the log ring buffer.  The record is formatted by
+    the log thread.  The caller checks the log level with LogEnabled.
+
+@param[in]
+    level
+        log level of the record
+
+@param[in]
+    code
+        record code
+
+@param[in]
+    arg1
+        first argument of the record
+
+@param[in]
+    arg2
+        second argument of the record
+
+@param[in]
+    arg3
+        third argument of the record
+
+==============================================================================*/
+void LogRecord( LogLevel level,
+                LogCode code,
+                int64_t arg1,
+                int64_t arg2,
+                int64_t arg3 )
+{
+    LogSlot *pSlot;
+
+    pSlot = ClaimSlot( level, code );
+    if ( pSlot != NULL )
+    {
+        pSlot->args[0] = arg1;
+        pSlot->args[1] = arg2;
+        pSlot->args[2] = arg3;
+        PublishSlot( pSlot );
+    }
+}
+
+/*============================================================================*/
+/*  LogMessage                                                                */
+/*!
+    Log a text message
+
+    The LogMessage function formats a message directly into a record
+    of the log ring buffer, if its level is enabled.  Messages longer
+    than LOG_TEXT_LEN are truncated.  If the log thread is not running,
+    the message is written immediately.
+
+@param[in]
+    level
+        log level of the message
+
+@param[in]
+    format
+        printf style format of the message
+
+@param[in]
+    ...
+        message arguments
+
+==============================================================================*/
+void LogMessage( LogLevel level, const char *format, ... )
+{
+    LogSlot *pSlot;
+    va_list args;
+    struct timespec now;
+    char text[LOG_TEXT_LEN];
+
+    if ( ( format == NULL ) ||
+         ( LogEnabled( level, LOGLEVEL_eDEFAULT ) == false ) )
+    {
+        return;
+    }
+
+    va_start( args, format );
+
+    if ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == false )
+    {
+        vsnprintf( text, sizeof( text ), format, args );
+        clock_gettime( CLOCK_REALTIME, &now );
+        WriteText( level, &now, text );
+    }
+    else
+    {
+        pSlot = ClaimSlot( level, LOGCODE_eTEXT );
+        if ( pSlot != NULL )
+        {
+            vsnprintf( pSlot->text, sizeof( pSlot->text ), format, args );
+            PublishSlot( pSlot );
+        }
+    }
+
+    va_end( args );
+}
+
+/*============================================================================*/
+/*  ClaimSlot                                                                 */
+/*!
+    Claim a record in the log ring buffer
+
+    The ClaimSlot function reserves the next free record of the ring
+    buffer for the calling thread.  Each record has a sequence number
+    which equals its ring position when it is free, so writers race
+    only on the compare-and-swap of the head position.
+
+@param[in]
+    level
+        log level of the record
+
+@param[in]
+    code
+        record code
+
+@retval pointer to the claimed record
+@retval NULL the ring buffer is full and the record was dropped
+
+==============================================================================*/
+static LogSlot *ClaimSlot( LogLevel level, LogCode code )
+{
+    LogSlot *pSlot;
+    size_t pos;
+    size_t sequence;
+    intptr_t diff;
+
+    pos = __atomic_load_n( &head, __ATOMIC_RELAXED );
+    for ( ;; )
+    {
+        pSlot = &ring[pos & ( LOG_RING_SIZE - 1 )];
+        sequence = __atomic_load_n( &pSlot->sequence, __ATOMIC_ACQUIRE );
+        diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if ( diff == 0 )
+        {
+            if ( __atomic_compare_exchange_n( &head,
+                                              &pos,
+                                              pos + 1,
+                                              true,
+                                              __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            /* the log thread has not caught up, so drop the record */
+            __atomic_add_fetch( &dropped, 1, __ATOMIC_RELAXED );
+            return NULL;
+        }
+        else
+        {
+            pos = __atomic_load_n( &head, __ATOMIC_RELAXED );
+        }
+    }
+
+    pSlot->level = level;
+    pSlot->code = code;
+    clock_gettime( CLOCK_REALTIME, &pSlot->time );
+
+    return pSlot;
+}
+
+/*============================================================================*/
+/*  PublishSlot                                                               */
+/*!
+    Publish a claimed log record to the log thread
+
+    The PublishSlot function hands a completed record to the log thread,
+    and wakes the log thread if the record is the first one published
+    since the ring buffer was last drained.
+
+@param[in]
+    pSlot
+        pointer to the completed record
+
+==============================================================================*/
+static void PublishSlot( LogSlot *pSlot )
+{
+    size_t sequence;
+
+    sequence = __atomic_load_n( &pSlot->sequence, __ATOMIC_RELAXED );
+    __atomic_store_n( &pSlot->sequence, sequence + 1, __ATOMIC_RELEASE );
+
+    if ( ( __atomic_fetch_add( &published, 1, __ATOMIC_ACQ_REL ) == 0 ) &&
+         ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == true ) )
+    {
+        /* the ring buffer was empty, so the log thread is asleep */
+        sem_post( &wakeup );
+    }
+}
+
+/*============================================================================*/
+/*  LogThread                                                                 */
+/*!
+    Log thread
+
+    The LogThread function waits until records are published, and
+    drains the log ring buffer until it is empty, until the log is
+    stopped.
+
+@param[in]
+    arg
+        thread argument (unused)
+
+@retval NULL
+
+==============================================================================*/
+static void *LogThread( void *arg )
+{
+    size_t count;
+
+    (void)arg;
+
+    while ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == true )
+    {
+        if ( sem_wait( &wakeup ) != 0 )
+        {
+            continue;
+        }
+
+        do
+        {
+            count = DrainLog();
+            if ( count == 0 )
+            {
+                /* a record ahead of the published ones is still being
+                   written, so give its writer a chance to finish */
+                sched_yield();
+            }
+        } while ( ( __atomic_sub_fetch( &published,
+                                        count,
+                                        __ATOMIC_ACQ_REL ) != 0 ) &&
+                  ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == true ) );
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  DrainLog                                                                  */
+/*!
+    Write the published records of the log ring buffer
+
+    The DrainLog function writes the published records in ring order,
+    stopping at the first record which is still being written, and
+    reports any records which were dropped.
+
+@retval number of records written
+
+==============================================================================*/
+static size_t DrainLog( void )
+{
+    LogSlot *pSlot;
+    size_t count = 0;
+    uint64_t lost;
+    struct timespec now;
+    char text[LOG_TEXT_LEN];
+
+    for ( ;; )
+    {
+        pSlot = &ring[tail & ( LOG_RING_SIZE - 1 )];
+        if ( __atomic_load_n( &pSlot->sequence, __ATOMIC_ACQUIRE ) !=
+             tail + 1 )
+        {
+            break;
+        }
+
+        WriteRecord( pSlot );
+
+        /* hand the slot back to the writers for the next lap */
+        __atomic_store_n( &pSlot->sequence,
+                          tail + LOG_RING_SIZE,
+                          __ATOMIC_RELEASE );
+        tail++;
+        count++;
+    }
+
+    lost = __atomic_exchange_n( &dropped, 0, __ATOMIC_RELAXED );
+    if ( lost > 0 )
+    {
+        snprintf( text,
+                  sizeof( text ),
+                  "%llu log records dropped",
+                  (unsigned long long)lost );
+        clock_gettime( CLOCK_REALTIME, &now );
+        WriteText( LOGLEVEL_eWARNING, &now, text );
+    }
+
+    if ( ( count > 0 ) && ( logFile != NULL ) )
+    {
+        fflush( logFile );
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  WriteRecord                                                               */
+/*!
+    Format and write a log record
+
+@param[in]
+    pSlot
+        pointer to the record to write
+
+==============================================================================*/
+static void WriteRecord( LogSlot *pSlot )
+{
+    char text[LOG_TEXT_LEN];
+    int64_t *args = pSlot->args;
+
+    switch ( pSlot->code )
+    {
+        case LOGCODE_eSIGNAL:
+            snprintf( text, sizeof( text ),
+                      "received signal %d id = %d",
+                      (int)args[0], (int)args[1] );
+            break;
+
+        case LOGCODE_eHANDLED:
+            snprintf( text, sizeof( text ),
+                      "signal %d %d: %s",
+                      (int)args[0], (int)args[1], strerror( (int)args[2] ) );
+            break;
+
+        case LOGCODE_eACTION:
+            snprintf( text, sizeof( text ),
+                      "action at line %d ran in %lld us: %s",
+                      (int)args[0],
+                      (long long)args[1],
+                      strerror( (int)args[2] ) );
+            break;
+
+        case LOGCODE_eREORDER:
+            snprintf( text, sizeof( text ),
+                      "reordered condition at line %d",
+                      (int)args[0] );
+            break;
+
+        default:
+            memcpy( text, pSlot->text, sizeof( text ) );
+            text[sizeof( text ) - 1] = '\0';
+            break;
+    }
+
+    WriteText( pSlot->level, &pSlot->time, text );
+}
+
+/*============================================================================*/
+/*  WriteText                                                                 */
+/*!
+    Write a formatted log message to the log destination
+
+@param[in]
+    level
+        log level of the message
+
+@param[in]
+    pTime
+        pointer to the time the message was logged
+
+@param[in]
+    text
+        pointer to the message text
+
+==============================================================================*/
+static void WriteText( LogLevel level, struct timespec *pTime, char *text )
+{
+    FILE *fp;
+    struct tm tm;
+    char stamp[32];
+    int priority;
+
+    if ( logTarget == LOGTARGET_eSYSLOG )
+    {
+        priority = ( level == LOGLEVEL_eERROR )   ? LOG_ERR
+                 : ( level == LOGLEVEL_eWARNING ) ? LOG_WARNING
+                 : ( level == LOGLEVEL_eINFO )    ? LOG_INFO
+                 : LOG_DEBUG;
+
+        syslog( priority, "actions: %s\n", text );
+        return;
+    }
+
+    fp = ( logTarget == LOGTARGET_eFILE )   ? logFile
+       : ( logTarget == LOGTARGET_eSTDOUT ) ? stdout
+       : stderr;
+
+    localtime_r( &pTime->tv_sec, &tm );
+    strftime( stamp, sizeof( stamp ), "%Y-%m-%d %H:%M:%S", &tm );
+
+    fprintf( fp,
+             "%s.%03ld %s: %s\n",
+             stamp,
+             pTime->tv_nsec / 1000000L,
+             levelNames[level],
+             text );
+}
+
+/*! @}
+ * end of log group */
@@ -0,0 +1,391 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup realtime realtime
+ * @brief Real-time execution options
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file realtime.c
+
+    Real-time Execution
+
+    The realtime component configures the actions process for
+    deterministic response times.
+
+    - parse the real-time scheduling policy and priority
+    - parse the CPU affinity list
+    - lock the process memory and pre-fault the stack and heap
+    - apply the scheduling policy and CPU affinity
+
+    The configuration is applied after the actions script is parsed,
+    so the parsed action program is resident before memory is locked.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include "realtime.h"
+#include "log.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int LockMemory( void );
+static void PrefaultStack( void );
+static void PrefaultHeap( void );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ParseSchedPolicy                                                          */
+/*!
+    Parse a scheduling policy
+
+    The ParseSchedPolicy function parses a scheduling policy
+    specification of the form fifo:<priority> or rr:<priority>
+
+@param[in]
+    spec
+        pointer to the scheduling policy specification
+
+@param[in,out]
+    pConfig
+        pointer to the real-time configuration to update
+
+@retval EOK the scheduling policy was parsed
+@retval EINVAL invalid scheduling policy
+
+==============================================================================*/
+int ParseSchedPolicy( const char *spec, RealtimeConfig *pConfig )
+{
+    int policy;
+    int priority;
+    char *pEnd;
+    const char *p;
+
+    if ( ( spec == NULL ) || ( pConfig == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    if ( strncmp( spec, "fifo:", 5 ) == 0 )
+    {
+        policy = SCHED_FIFO;
+        p = &spec[5];
+    }
+    else if ( strncmp( spec, "rr:", 3 ) == 0 )
+    {
+        policy = SCHED_RR;
+        p = &spec[3];
+    }
+    else
+    {
+        return EINVAL;
+    }
+
+    priority = strtol( p, &pEnd, 10 );
+    if ( ( pEnd == p ) ||
+         ( *pEnd != '\0' ) ||
+         ( priority < sched_get_priority_min( policy ) ) ||
+         ( priority > sched_get_priority_max( policy ) ) )
+    {
+        return EINVAL;
+    }
+
+    pConfig->policy = policy;
+    pConfig->priority = priority;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ParseCpuList                                                              */
+/*!
+    Parse a CPU affinity list
+
+    The ParseCpuList function parses a comma separated list of CPU
+    numbers and ranges, such as 0,2-3, into a CPU affinity mask
+
+@param[in]
+    spec
+        pointer to the CPU list
+
+@param[in,out]
+    pConfig
+        pointer to the real-time configuration to update
+
+@retval EOK the CPU list was parsed
+@retval EINVAL invalid CPU list
+
+==============================================================================*/
+int ParseCpuList( const char *spec, RealtimeConfig *pConfig )
+{
+    uint64_t cpus = 0;
+    const char *p = spec;
+    char *pEnd;
+    long first;
+    long last;
+
+    if ( ( spec == NULL ) || ( pConfig == NULL ) )
+    {
+        return EINVAL;
+    }
+
+    do
+    {
+        first = strtol( p, &pEnd, 10 );
+        if ( pEnd == p )
+        {
+            return EINVAL;
+        }
+
+        last = first;
+        p = pEnd;
+        if ( *p == '-' )
+        {
+            p++;
+            last = strtol( p, &pEnd, 10 );
+            if ( pEnd == p )
+            {
+                return EINVAL;
+            }
+
+            p = pEnd;
+        }
+
+        if ( ( first < 0 ) ||
+             ( last < first ) ||
+             ( last >= MAX_AFFINITY_CPUS ) )
+        {
+            return EINVAL;
+        }
+
+        while ( first <= last )
+        {
+            cpus |= (uint64_t)1 << first++;
+        }
+
+    } while ( *p++ == ',' );
+
+    if ( *--p != '\0' )
+    {
+        return EINVAL;
+    }
+
+    pConfig->cpus = cpus;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ApplyRealtime                                                             */
+/*!
+    Apply the real-time configuration
+
+    The ApplyRealtime function locks and pre-faults the process memory,
+    sets the CPU affinity, and sets the scheduling policy of the actions
+    process.  Threads created afterwards inherit the CPU affinity and
+    scheduling policy.
+
+@param[in]
+    pConfig
+        pointer to the real-time configuration
+
+@retval EOK the configuration was applied
+@retval EINVAL invalid arguments
+@retval other error from the operating system
+
+==============================================================================*/
+int ApplyRealtime( RealtimeConfig *pConfig )
+{
+    int result = EINVAL;
+    struct sched_param param;
+    cpu_set_t set;
+    int cpu;
+    int rc;
+
+    if ( pConfig != NULL )
+    {
+        result = EOK;
+
+        if ( pConfig->lock == true )
+        {
+            rc = LockMemory();
+            if ( rc != EOK )
+            {
+                result = rc;
+                LogMessage( LOGLEVEL_eWARNING,
+                            "mlockall failed: %s",
+                            strerror( rc ) );
+            }
+        }
+
+        if ( pConfig->cpus != 0 )
+        {
+            CPU_ZERO( &set );
+            for ( cpu = 0; cpu < MAX_AFFINITY_CPUS; cpu++ )
+            {
+                if ( pConfig->cpus & ( (uint64_t)1 << cpu ) )
+                {
+                    CPU_SET( cpu, &set );
+                }
+            }
+
+            if ( sched_setaffinity( 0, sizeof( set ), &set ) != 0 )
+            {
+                result = errno;
+                LogMessage( LOGLEVEL_eWARNING,
+                            "sched_setaffinity failed: %s",
+                            strerror( result ) );
+            }
+        }
+
+        if ( pConfig->policy != SCHED_OTHER )
+        {
+            memset( &param, 0, sizeof( param ) );
+            param.sched_priority = pConfig->priority;
+            if ( sched_setscheduler( 0, pConfig->policy, &param ) != 0 )
+            {
+                result = errno;
+                LogMessage( LOGLEVEL_eWARNING,
+                            "sched_setscheduler failed: %s",
+                            strerror( result ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LockMemory                                                                */
+/*!
+    Lock the process memory
+
+    The LockMemory function locks the current and future pages of the
+    process into memory, stops the heap from being trimmed or allocated
+    with mmap, and pre-faults the stack and heap, so that action
+    execution does not incur page faults.
+
+@retval EOK the memory was locked
+@retval other error from mlockall
+
+==============================================================================*/
+static int LockMemory( void )
+{
+    if ( mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 )
+    {
+        return errno;
+    }
+
+    /* keep freed memory in the (locked) heap */
+    (void)mallopt( M_TRIM_THRESHOLD, -1 );
+    (void)mallopt( M_MMAP_MAX, 0 );
+
+    PrefaultStack();
+    PrefaultHeap();
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  PrefaultStack                                                             */
+/*!
+    Pre-fault the stack
+
+    The PrefaultStack function touches PREFAULT_STACK_SIZE bytes of
+    the stack so the stack pages are resident before actions run.
+
+==============================================================================*/
+static void PrefaultStack( void )
+{
+    volatile unsigned char stack[PREFAULT_STACK_SIZE];
+    size_t pagesize = (size_t)sysconf( _SC_PAGESIZE );
+    size_t i;
+
+    for ( i = 0; i < sizeof( stack ); i += pagesize )
+    {
+        stack[i] = 0;
+    }
+}
+
+/*============================================================================*/
+/*  PrefaultHeap                                                              */
+/*!
+    Pre-fault the heap
+
+    The PrefaultHeap function grows the heap by PREFAULT_HEAP_SIZE
+    bytes and touches it.  Since the heap is not trimmed, the pages
+    stay resident for later allocations after they are freed.
+
+==============================================================================*/
+static void PrefaultHeap( void )
+{
+    unsigned char *heap;
+    size_t pagesize = (size_t)sysconf( _SC_PAGESIZE );
+    size_t i;
+
+    heap = malloc( PREFAULT_HEAP_SIZE );
+    if ( heap != NULL )
+    {
+        for ( i = 0; i < PREFAULT_HEAP_SIZE; i += pagesize )
+        {
+            heap[i] = 0;
+        }
+
+        free( heap );
+    }
+}
+
+/*! @}
+ * end of realtime group */
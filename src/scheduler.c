@@ -0,0 +1,363 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup scheduler scheduler
+ * @brief Event scheduling functions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file scheduler.c
+
+    Priority Event Scheduler
+
+    The scheduler component queues pending events and selects the
+    next event to dispatch.
+
+    - one event queue per priority level
+    - highest priority events are dispatched first
+    - earliest deadline first within a priority level
+    - starvation protection for lower priority events
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include "scheduler.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! queue of events at a single priority level */
+typedef struct _eventQueue
+{
+    /*! queued events in arrival order */
+    Event events[MAX_QUEUED_EVENTS];
+
+    /*! number of queued events */
+    size_t count;
+
+    /*! number of times this queue was passed over while not empty */
+    size_t skipped;
+} EventQueue;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static bool IsEarlier( Event *pEvent1, Event *pEvent2 );
+static int SelectQueue( void );
+
+/*==============================================================================
+       File Scoped Variables
+==============================================================================*/
+
+/*! event queues, indexed by priority */
+static EventQueue queues[NUM_PRIORITIES];
+
+/*! total number of queued events */
+static size_t pending = 0;
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ScheduleEvent                                                             */
+/*!
+    Queue an event for dispatch
+
+    The ScheduleEvent function adds an event to the queue for its
+    priority level.
+
+@param[in]
+    pEvent
+        pointer to the event to queue
+
+@retval EOK the event was queued
+@retval ENOSPC the queue for the event's priority is full
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int ScheduleEvent( Event *pEvent )
+{
+    int result = EINVAL;
+    EventQueue *pQueue;
+
+    if ( ( pEvent != NULL ) &&
+         ( pEvent->priority >= MIN_PRIORITY ) &&
+         ( pEvent->priority <= MAX_PRIORITY ) )
+    {
+        pQueue = &queues[pEvent->priority - MIN_PRIORITY];
+        if ( pQueue->count < MAX_QUEUED_EVENTS )
+        {
+            pQueue->events[pQueue->count++] = *pEvent;
+            pending++;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOSPC;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NextEvent                                                                 */
+/*!
+    Get the next event to dispatch
+
+    The NextEvent function removes the next event to be dispatched
+    from the event queues.  The highest priority queue is served first,
+    unless a lower priority queue has been passed over too many times.
+    Within a queue, the event with the earliest deadline is selected,
+    and events without deadlines are served in arrival order.
+
+@param[out]
+    pEvent
+        pointer to a location to store the next event
+
+@retval EOK an event was returned
+@retval ENOENT no events are pending
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int NextEvent( Event *pEvent )
+{
+    int result = EINVAL;
+    EventQueue *pQueue;
+    size_t selected = 0;
+    size_t i;
+    int level;
+
+    if ( pEvent != NULL )
+    {
+        level = SelectQueue();
+        if ( level >= 0 )
+        {
+            pQueue = &queues[level];
+
+            /* earliest deadline first */
+            for ( i = 1; i < pQueue->count; i++ )
+            {
+                if ( IsEarlier( &pQueue->events[i],
+                                &pQueue->events[selected] ) == true )
+                {
+                    selected = i;
+                }
+            }
+
+            *pEvent = pQueue->events[selected];
+
+            pQueue->count--;
+            memmove( &pQueue->events[selected],
+                     &pQueue->events[selected + 1],
+                     ( pQueue->count - selected ) * sizeof( Event ) );
+
+            pending--;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PendingEvents                                                             */
+/*!
+    Get the number of queued events
+
+@return the total number of events waiting to be dispatched
+
+==============================================================================*/
+size_t PendingEvents( void )
+{
+    return pending;
+}
+
+/*============================================================================*/
+/*  DiscardEvents                                                             */
+/*!
+    Discard queued events
+
+    The DiscardEvents function removes all of the queued events which
+    were generated by the specified signal.
+
+@param[in]
+    signum
+        the signal whose events are to be discarded
+
+@return the number of events which were discarded
+
+==============================================================================*/
+size_t DiscardEvents( int signum )
+{
+    size_t discarded = 0;
+    size_t i;
+    size_t j;
+    int level;
+    EventQueue *pQueue;
+
+    for ( level = 0; level < NUM_PRIORITIES; level++ )
+    {
+        pQueue = &queues[level];
+
+        for ( i = 0, j = 0; i < pQueue->count; i++ )
+        {
+            if ( pQueue->events[i].signum == signum )
+            {
+                discarded++;
+            }
+            else
+            {
+                pQueue->events[j++] = pQueue->events[i];
+            }
+        }
+
+        pQueue->count = j;
+    }
+
+    pending -= discarded;
+
+    return discarded;
+}
+
+/*============================================================================*/
+/*  SelectQueue                                                               */
+/*!
+    Select the event queue to serve
+
+    The SelectQueue function selects the highest priority non-empty queue,
+    unless a lower priority queue has reached the starvation limit,
+    in which case the highest priority starved queue is selected.
+    All other non-empty queues are marked as passed over.
+
+@retval index of the selected queue
+@retval -1 all queues are empty
+
+==============================================================================*/
+static int SelectQueue( void )
+{
+    int level = -1;
+    int starved = -1;
+    int i;
+
+    for ( i = NUM_PRIORITIES - 1; i >= 0; i-- )
+    {
+        if ( queues[i].count > 0 )
+        {
+            if ( level < 0 )
+            {
+                level = i;
+            }
+            else if ( ( starved < 0 ) &&
+                      ( queues[i].skipped >= STARVATION_LIMIT ) )
+            {
+                starved = i;
+            }
+        }
+    }
+
+    if ( starved >= 0 )
+    {
+        level = starved;
+    }
+
+    for ( i = 0; i < NUM_PRIORITIES; i++ )
+    {
+        if ( i == level )
+        {
+            queues[i].skipped = 0;
+        }
+        else if ( queues[i].count > 0 )
+        {
+            queues[i].skipped++;
+        }
+    }
+
+    return level;
+}
+
+/*============================================================================*/
+/*  IsEarlier                                                                 */
+/*!
+    Compare the deadlines of two events
+
+@param[in]
+    pEvent1
+        pointer to the first event
+
+@param[in]
+    pEvent2
+        pointer to the second event
+
+@retval true the first event has an earlier deadline than the second
+@retval false the first event does not have an earlier deadline
+
+==============================================================================*/
+static bool IsEarlier( Event *pEvent1, Event *pEvent2 )
+{
+    if ( pEvent1->hasDeadline == false )
+    {
+        return false;
+    }
+
+    if ( pEvent2->hasDeadline == false )
+    {
+        return true;
+    }
+
+    if ( pEvent1->deadline.tv_sec != pEvent2->deadline.tv_sec )
+    {
+        return pEvent1->deadline.tv_sec < pEvent2->deadline.tv_sec;
+    }
+
+    return pEvent1->deadline.tv_nsec < pEvent2->deadline.tv_nsec;
+}
+
+/*! @}
+ * end of scheduler group */
@@ -0,0 +1,888 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup snapshot snapshot
+ * @brief Engine state snapshots
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file snapshot.c
+
+    Engine State Snapshots
+
+    The snapshot component saves the state an actions engine has built up
+    while running to a file, so a restarted engine can carry on where the
+    previous instance stopped instead of starting cold.
+
+    - the phase of each every timer
+    - the value of each numeric static local variable
+    - the samples in each streaming aggregate window
+    - the last seen value of each numeric watched variable
+
+    A snapshot is only restored by an engine running the same action
+    script, identified by a hash of the script and its included files,
+    since the records are keyed by the position of each action and item
+    in the script.  The file is written alongside its final path and
+    renamed over it, so a crash while saving leaves the previous
+    snapshot intact.
+
+    Cached calc results are not saved.  They are only valid while their
+    input variables are unchanged, and the variables may have changed
+    while no engine was running.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include "snapshot.h"
+#include "include.h"
+#include "timer.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! snapshot record types */
+typedef enum
+{
+    /*! next firing time of an every timer */
+    SNAPSHOT_eTIMER = 1,
+
+    /*! value of a static local variable */
+    SNAPSHOT_eSTATIC = 2,
+
+    /*! samples of a streaming aggregate */
+    SNAPSHOT_eAGGREGATE = 3,
+
+    /*! last seen value of a watched variable */
+    SNAPSHOT_eWATCH = 4
+
+} SnapshotKind;
+
+/*! snapshot file header */
+typedef struct _snapshotHeader
+{
+    /*! SNAPSHOT_MAGIC */
+    uint32_t magic;
+
+    /*! SNAPSHOT_VERSION */
+    uint32_t version;
+
+    /*! hash of the action script the snapshot was taken from */
+    uint64_t hash;
+
+    /*! wall clock time the snapshot was taken, in milliseconds */
+    uint64_t saved;
+} SnapshotHeader;
+
+/*! snapshot record header, followed by its values */
+typedef struct _snapshotRecord
+{
+    /*! type of record (SnapshotKind) */
+    uint32_t kind;
+
+    /*! position of the action (or watched variable) in the script */
+    uint32_t action;
+
+    /*! position of the item within the action */
+    uint32_t item;
+
+    /*! number of values following the record header */
+    uint32_t count;
+} SnapshotRecord;
+
+/*! saved variable value */
+typedef struct _snapshotValue
+{
+    /*! VarServer type of the value */
+    uint32_t type;
+
+    /*! reserved */
+    uint32_t reserved;
+
+    /*! raw numeric value */
+    uint64_t raw;
+} SnapshotValue;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int SaveAction( FILE *fp, Action *pAction, uint32_t ordinal );
+static int SaveAggregate( FILE *fp,
+                          Aggregate *pAggregate,
+                          uint32_t ordinal,
+                          uint32_t item );
+static int WriteRecord( FILE *fp,
+                        SnapshotKind kind,
+                        uint32_t action,
+                        uint32_t item,
+                        const void *pValues,
+                        size_t size,
+                        uint32_t count );
+static int ReadRecords( FILE *fp,
+                        Actions *pActions,
+                        uint64_t downtime,
+                        bool apply );
+static void LoadValue( Action *pAction,
+                       SnapshotRecord *pRecord,
+                       SnapshotValue *pValue );
+static void LoadAggregate( Aggregate *pAggregate,
+                           Sample *pSamples,
+                           uint32_t count,
+                           uint64_t downtime );
+static bool IsNumeric( VarType type );
+static uint64_t ClockMs( clockid_t clock );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SaveSnapshot                                                              */
+/*!
+    Save a snapshot of the engine state
+
+    The SaveSnapshot function writes the state of the timers, static
+    variables, aggregates and watched variables to the snapshot file.
+    The file is replaced atomically once it has been completely written.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the snapshot was saved
+@retval ENOTSUP the action script hash is not known
+@retval EINVAL invalid arguments
+@retval other error from writing the snapshot file
+
+==============================================================================*/
+int SaveSnapshot( Actions *pActions )
+{
+    SnapshotHeader header;
+    SnapshotValue value;
+    Action *pAction;
+    Watch *pWatch;
+    uint32_t ordinal;
+    char path[PATH_MAX];
+    FILE *fp = NULL;
+    int result = EOK;
+
+    if ( ( pActions == NULL ) || ( pActions->snapshotPath == NULL ) )
+    {
+        result = EINVAL;
+    }
+    else
+    {
+        memset( &header, 0, sizeof( SnapshotHeader ) );
+        header.magic = SNAPSHOT_MAGIC;
+        header.version = SNAPSHOT_VERSION;
+        header.hash = ScriptHash();
+        header.saved = ClockMs( CLOCK_REALTIME );
+
+        if ( header.hash == 0 )
+        {
+            /* the snapshot could never be restored */
+            result = ENOTSUP;
+        }
+        else if ( snprintf( path,
+                            sizeof( path ),
+                            "%s.tmp",
+                            pActions->snapshotPath ) >= (int)sizeof( path ) )
+        {
+            result = ENAMETOOLONG;
+        }
+        else
+        {
+            fp = fopen( path, "wb" );
+            if ( fp == NULL )
+            {
+                result = errno;
+            }
+        }
+    }
+
+    if ( fp != NULL )
+    {
+        if ( fwrite( &header, sizeof( SnapshotHeader ), 1, fp ) != 1 )
+        {
+            result = EIO;
+        }
+
+        for ( pAction = pActions->pActionList, ordinal = 0;
+              ( pAction != NULL ) && ( result == EOK );
+              pAction = pAction->pNext, ordinal++ )
+        {
+            result = SaveAction( fp, pAction, ordinal );
+        }
+
+        for ( pWatch = pActions->pWatchList, ordinal = 0;
+              ( pWatch != NULL ) && ( result == EOK );
+              pWatch = pWatch->pNext, ordinal++ )
+        {
+            if ( ( pWatch->seen == true ) &&
+                 ( IsNumeric( pWatch->last.type ) == true ) )
+            {
+                memset( &value, 0, sizeof( SnapshotValue ) );
+                value.type = pWatch->last.type;
+                memcpy( &value.raw, &pWatch->last.val, sizeof( value.raw ) );
+                result = WriteRecord( fp,
+                                      SNAPSHOT_eWATCH,
+                                      ordinal,
+                                      0,
+                                      &value,
+                                      sizeof( SnapshotValue ),
+                                      1 );
+            }
+        }
+
+        if ( fclose( fp ) != 0 )
+        {
+            result = ( result == EOK ) ? errno : result;
+        }
+
+        if ( result == EOK )
+        {
+            if ( rename( path, pActions->snapshotPath ) != 0 )
+            {
+                result = errno;
+            }
+        }
+
+        if ( result != EOK )
+        {
+            (void)remove( path );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LoadSnapshot                                                              */
+/*!
+    Restore the engine state from a snapshot
+
+    The LoadSnapshot function restores the state saved by SaveSnapshot.
+    It must be called after the script has been parsed and before the
+    timers are started.  Aggregate samples age by the time the engine
+    was not running, and samples which have left their window while
+    the engine was stopped are discarded.
+
+    The whole file is checked before any record is applied, so an
+    invalid or truncated snapshot leaves the engine state untouched.
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@retval EOK the engine state was restored
+@retval ENOENT there is no snapshot
+@retval ESTALE the snapshot was taken from a different action script
+@retval EINVAL invalid arguments or invalid snapshot file
+@retval other error from reading the snapshot file
+
+==============================================================================*/
+int LoadSnapshot( Actions *pActions )
+{
+    SnapshotHeader header;
+    uint64_t hash;
+    uint64_t now;
+    uint64_t downtime;
+    long records;
+    FILE *fp = NULL;
+    int result = EOK;
+
+    if ( ( pActions == NULL ) || ( pActions->snapshotPath == NULL ) )
+    {
+        result = EINVAL;
+    }
+    else
+    {
+        fp = fopen( pActions->snapshotPath, "rb" );
+        if ( fp == NULL )
+        {
+            result = errno;
+        }
+    }
+
+    if ( fp != NULL )
+    {
+        hash = ScriptHash();
+
+        if ( ( fread( &header, sizeof( SnapshotHeader ), 1, fp ) != 1 ) ||
+             ( header.magic != SNAPSHOT_MAGIC ) ||
+             ( header.version != SNAPSHOT_VERSION ) )
+        {
+            result = EINVAL;
+        }
+        else if ( ( hash == 0 ) || ( header.hash != hash ) )
+        {
+            result = ESTALE;
+        }
+        else
+        {
+            now = ClockMs( CLOCK_REALTIME );
+            downtime = ( now > header.saved ) ? now - header.saved : 0;
+            records = ftell( fp );
+
+            /* check every record before applying any of them */
+            result = ReadRecords( fp, pActions, downtime, false );
+            if ( result == EOK )
+            {
+                result = ( fseek( fp, records, SEEK_SET ) == 0 )
+                            ? ReadRecords( fp, pActions, downtime, true )
+                            : errno;
+            }
+        }
+
+        fclose( fp );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SaveAction                                                                */
+/*!
+    Save the state of an action
+
+    The SaveAction function writes the records for the timer, static
+    variables and aggregates of an action.
+
+@param[in]
+    fp
+        snapshot file
+
+@param[in]
+    pAction
+        pointer to the action
+
+@param[in]
+    ordinal
+        position of the action in the script
+
+@retval EOK the action state was written
+@retval EIO the snapshot file could not be written
+
+==============================================================================*/
+static int SaveAction( FILE *fp, Action *pAction, uint32_t ordinal )
+{
+    StaticVar *pStatic;
+    Aggregate *pAggregate;
+    SnapshotValue value;
+    uint64_t next;
+    uint32_t item;
+    int result = EOK;
+
+    if ( ( pAction->signal == TIMER_NOTIFICATION ) &&
+         ( pAction->timerID != 0 ) )
+    {
+        /* only every timers have a phase to resume */
+        next = GetTickNext( pAction->timerID );
+        if ( next != 0 )
+        {
+            result = WriteRecord( fp,
+                                  SNAPSHOT_eTIMER,
+                                  ordinal,
+                                  0,
+                                  &next,
+                                  sizeof( next ),
+                                  1 );
+        }
+    }
+
+    for ( pStatic = pAction->pStatics, item = 0;
+          ( pStatic != NULL ) && ( result == EOK );
+          pStatic = pStatic->pNext, item++ )
+    {
+        if ( IsNumeric( pStatic->value.type ) == true )
+        {
+            memset( &value, 0, sizeof( SnapshotValue ) );
+            value.type = pStatic->value.type;
+            memcpy( &value.raw, &pStatic->value.val, sizeof( value.raw ) );
+            result = WriteRecord( fp,
+                                  SNAPSHOT_eSTATIC,
+                                  ordinal,
+                                  item,
+                                  &value,
+                                  sizeof( SnapshotValue ),
+                                  1 );
+        }
+    }
+
+    for ( pAggregate = pAction->pAggregates, item = 0;
+          ( pAggregate != NULL ) && ( result == EOK );
+          pAggregate = pAggregate->pNext, item++ )
+    {
+        result = SaveAggregate( fp, pAggregate, ordinal, item );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SaveAggregate                                                             */
+/*!
+    Save the samples of a streaming aggregate
+
+    The SaveAggregate function writes the samples in an aggregate window,
+    oldest first, with the sample times stored as ages so they do not
+    depend on the monotonic clock of this boot.  An exponentially
+    weighted moving average is saved as a single sample.
+
+@param[in]
+    fp
+        snapshot file
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@param[in]
+    ordinal
+        position of the action in the script
+
+@param[in]
+    item
+        position of the aggregate in the action
+
+@retval EOK the aggregate was written
+@retval EIO the snapshot file could not be written
+
+==============================================================================*/
+static int SaveAggregate( FILE *fp,
+                          Aggregate *pAggregate,
+                          uint32_t ordinal,
+                          uint32_t item )
+{
+    static Sample samples[MAX_AGGREGATE_SAMPLES];
+    Sample *pSample;
+    uint64_t now;
+    uint64_t seq;
+    uint32_t count = 0;
+
+    if ( pAggregate->type == AGGREGATE_eEWMA )
+    {
+        if ( pAggregate->next != 0 )
+        {
+            samples[0].value = pAggregate->ewma;
+            samples[0].t = 0;
+            count = 1;
+        }
+    }
+    else
+    {
+        now = ClockMs( CLOCK_MONOTONIC );
+
+        for ( seq = pAggregate->first; seq < pAggregate->next; seq++ )
+        {
+            pSample = &pAggregate->pSamples[seq % MAX_AGGREGATE_SAMPLES];
+            samples[count].value = pSample->value;
+            samples[count].t = ( now > pSample->t ) ? now - pSample->t : 0;
+            count++;
+        }
+    }
+
+    return ( count > 0 ) ? WriteRecord( fp,
+                                        SNAPSHOT_eAGGREGATE,
+                                        ordinal,
+                                        item,
+                                        samples,
+                                        sizeof( Sample ),
+                                        count )
+                         : EOK;
+}
+
+/*============================================================================*/
+/*  WriteRecord                                                               */
+/*!
+    Write a snapshot record
+
+@param[in]
+    fp
+        snapshot file
+
+@param[in]
+    kind
+        type of record
+
+@param[in]
+    action
+        position of the action (or watched variable) in the script
+
+@param[in]
+    item
+        position of the item within the action
+
+@param[in]
+    pValues
+        pointer to the record values
+
+@param[in]
+    size
+        size of each record value
+
+@param[in]
+    count
+        number of record values
+
+@retval EOK the record was written
+@retval EIO the snapshot file could not be written
+
+==============================================================================*/
+static int WriteRecord( FILE *fp,
+                        SnapshotKind kind,
+                        uint32_t action,
+                        uint32_t item,
+                        const void *pValues,
+                        size_t size,
+                        uint32_t count )
+{
+    SnapshotRecord record;
+
+    record.kind = kind;
+    record.action = action;
+    record.item = item;
+    record.count = count;
+
+    return ( ( fwrite( &record, sizeof( SnapshotRecord ), 1, fp ) == 1 ) &&
+             ( fwrite( pValues, size, count, fp ) == count ) ) ? EOK : EIO;
+}
+
+/*============================================================================*/
+/*  ReadRecords                                                               */
+/*!
+    Read the snapshot records
+
+    The ReadRecords function reads each record in the snapshot file and
+    finds the action or watched variable it was saved from.  The records
+    of the actions are in script order, so the actions are found by
+    walking the action list once.  The records are only applied to the
+    engine state when requested, so the file can be checked first.
+
+@param[in]
+    fp
+        snapshot file, positioned after the header
+
+@param[in]
+    pActions
+        pointer to the actions object
+
+@param[in]
+    downtime
+        time since the snapshot was taken, in milliseconds
+
+@param[in]
+    apply
+        true to apply the records, false to only check them
+
+@retval EOK the records are valid (and were applied)
+@retval EINVAL the snapshot file is invalid
+
+==============================================================================*/
+static int ReadRecords( FILE *fp,
+                        Actions *pActions,
+                        uint64_t downtime,
+                        bool apply )
+{
+    static Sample samples[MAX_AGGREGATE_SAMPLES];
+    SnapshotRecord record;
+    SnapshotValue value;
+    Action *pAction = pActions->pActionList;
+    Aggregate *pAggregate;
+    Watch *pWatch = pActions->pWatchList;
+    uint32_t ordinal = 0;
+    uint32_t watch = 0;
+    uint64_t next;
+    uint32_t i;
+    size_t n;
+    int result = EOK;
+
+    while ( result == EOK )
+    {
+        n = fread( &record, 1, sizeof( SnapshotRecord ), fp );
+        if ( n != sizeof( SnapshotRecord ) )
+        {
+            /* a partial record means the file was truncated */
+            result = ( ( n == 0 ) && ( ferror( fp ) == 0 ) ) ? EOK : EINVAL;
+            break;
+        }
+
+        if ( record.kind == SNAPSHOT_eWATCH )
+        {
+            while ( ( pWatch != NULL ) && ( watch < record.action ) )
+            {
+                pWatch = pWatch->pNext;
+                watch++;
+            }
+
+            if ( ( pWatch == NULL ) ||
+                 ( watch != record.action ) ||
+                 ( record.count != 1 ) ||
+                 ( fread( &value, sizeof( value ), 1, fp ) != 1 ) )
+            {
+                result = EINVAL;
+            }
+            else if ( ( apply == true ) &&
+                      ( IsNumeric( value.type ) == true ) )
+            {
+                pWatch->last.type = value.type;
+                memcpy( &pWatch->last.val, &value.raw, sizeof( value.raw ) );
+                pWatch->seen = true;
+            }
+
+            continue;
+        }
+
+        while ( ( pAction != NULL ) && ( ordinal < record.action ) )
+        {
+            pAction = pAction->pNext;
+            ordinal++;
+        }
+
+        if ( ( pAction == NULL ) || ( ordinal != record.action ) )
+        {
+            result = EINVAL;
+            continue;
+        }
+
+        switch ( record.kind )
+        {
+            case SNAPSHOT_eTIMER:
+                if ( ( record.count != 1 ) ||
+                     ( fread( &next, sizeof( next ), 1, fp ) != 1 ) )
+                {
+                    result = EINVAL;
+                }
+                else if ( apply == true )
+                {
+                    (void)SetTickResume( pAction->timerID, next );
+                }
+                break;
+
+            case SNAPSHOT_eSTATIC:
+                if ( ( record.count != 1 ) ||
+                     ( fread( &value, sizeof( value ), 1, fp ) != 1 ) )
+                {
+                    result = EINVAL;
+                }
+                else if ( apply == true )
+                {
+                    LoadValue( pAction, &record, &value );
+                }
+                break;
+
+            case SNAPSHOT_eAGGREGATE:
+                for ( pAggregate = pAction->pAggregates, i = 0;
+                      ( pAggregate != NULL ) && ( i < record.item );
+                      pAggregate = pAggregate->pNext, i++ );
+
+                if ( ( pAggregate == NULL ) ||
+                     ( record.count > MAX_AGGREGATE_SAMPLES ) ||
+                     ( fread( samples,
+                              sizeof( Sample ),
+                              record.count,
+                              fp ) != record.count ) )
+                {
+                    result = EINVAL;
+                }
+                else if ( apply == true )
+                {
+                    LoadAggregate( pAggregate,
+                                   samples,
+                                   record.count,
+                                   downtime );
+                }
+                break;
+
+            default:
+                result = EINVAL;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LoadValue                                                                 */
+/*!
+    Restore the value of a static variable
+
+    The LoadValue function restores a static variable of an action,
+    provided it still has the type it was saved with.  Restored values
+    are marked for checkpointing, since they may be newer than the
+    checkpointed values.
+
+@param[in]
+    pAction
+        pointer to the action
+
+@param[in]
+    pRecord
+        pointer to the static variable record
+
+@param[in]
+    pValue
+        pointer to the saved value
+
+@return none
+
+==============================================================================*/
+static void LoadValue( Action *pAction,
+                       SnapshotRecord *pRecord,
+                       SnapshotValue *pValue )
+{
+    StaticVar *pStatic;
+    uint32_t i;
+
+    for ( pStatic = pAction->pStatics, i = 0;
+          ( pStatic != NULL ) && ( i < pRecord->item );
+          pStatic = pStatic->pNext, i++ );
+
+    if ( ( pStatic != NULL ) &&
+         ( pStatic->value.type == (VarType)pValue->type ) )
+    {
+        memcpy( &pStatic->value.val, &pValue->raw, sizeof( pValue->raw ) );
+        pStatic->dirty = true;
+    }
+}
+
+/*============================================================================*/
+/*  LoadAggregate                                                             */
+/*!
+    Restore the samples of a streaming aggregate
+
+    The LoadAggregate function adds the saved samples of an aggregate
+    which are still inside the window, allowing for the time the engine
+    was stopped.
+
+@param[in]
+    pAggregate
+        pointer to the aggregate
+
+@param[in]
+    pSamples
+        pointer to the saved samples, oldest first
+
+@param[in]
+    count
+        number of saved samples
+
+@param[in]
+    downtime
+        time since the snapshot was taken, in milliseconds
+
+@return none
+
+==============================================================================*/
+static void LoadAggregate( Aggregate *pAggregate,
+                           Sample *pSamples,
+                           uint32_t count,
+                           uint64_t downtime )
+{
+    uint64_t now = ClockMs( CLOCK_MONOTONIC );
+    uint64_t age;
+    uint32_t i;
+
+    for ( i = 0; i < count; i++ )
+    {
+        if ( pAggregate->type == AGGREGATE_eEWMA )
+        {
+            /* the average does not age */
+            pAggregate->ewma = pSamples[i].value;
+            pAggregate->next = 1;
+            continue;
+        }
+
+        age = pSamples[i].t + downtime;
+        if ( ( age < pAggregate->window ) && ( age <= now ) )
+        {
+            AddSample( pAggregate, pSamples[i].value, now - age );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  IsNumeric                                                                 */
+/*!
+    Check if a variable type is numeric
+
+@param[in]
+    type
+        VarServer variable type
+
+@retval true the type is numeric
+@retval false the type is not numeric
+
+==============================================================================*/
+static bool IsNumeric( VarType type )
+{
+    return ( type != VARTYPE_INVALID ) &&
+           ( type != VARTYPE_STR ) &&
+           ( type != VARTYPE_BLOB );
+}
+
+/*============================================================================*/
+/*  ClockMs                                                                   */
+/*!
+    Get the time of a clock in milliseconds
+
+@param[in]
+    clock
+        the clock to read
+
+@return the time of the clock in milliseconds
+
+==============================================================================*/
+static uint64_t ClockMs( clockid_t clock )
+{
+    struct timespec now;
+
+    clock_gettime( clock, &now );
+
+    return ( (uint64_t)now.tv_sec * 1000 ) + ( now.tv_nsec / 1000000 );
+}
+
+/*! @}
+ * end of snapshot group */
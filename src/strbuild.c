@@ -0,0 +1,859 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup strbuild strbuild
+ * @brief Pre-sized string builders for string concatenations
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file strbuild.c
+
+    String Builders
+
+    The string builder component replaces assignments of string
+    concatenations to string system variables, such as
+
+    /sys/test/c = "The counter is at " + (string "%d")/sys/test/b + ".";
+
+    with a list of literal and formatted field segments which are
+    appended into a single output buffer.  The output buffer is sized
+    when the script is loaded and reused on every execution, and the
+    format specifiers are validated and compiled when the script
+    is loaded, so no memory is allocated when the assignment runs.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include "strbuild.h"
+#include "writer.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int FormatField( Segment *pSegment,
+                        VarObject *pObj,
+                        char *buffer,
+                        size_t size,
+                        size_t *pLen );
+static bool IsNumeric( int type );
+static bool ToInteger( VarObject *pObj, int64_t *pValue, int *pBits );
+static bool ToReal( VarObject *pObj, double *pValue );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewLiteralSegment                                                         */
+/*!
+    Create a literal text segment
+
+@param[in]
+    text
+        pointer to the literal text
+
+@retval pointer to the new segment
+@retval NULL if memory allocation failed
+
+==============================================================================*/
+Segment *NewLiteralSegment( char *text )
+{
+    Segment *pSegment = NULL;
+
+    if ( text != NULL )
+    {
+        pSegment = (Segment *)calloc( 1, sizeof( Segment ) );
+        if ( pSegment != NULL )
+        {
+            pSegment->type = SEGMENT_eLITERAL;
+            pSegment->text = strdup( text );
+            pSegment->len = strlen( text );
+            pSegment->maxlen = pSegment->len;
+            if ( pSegment->text == NULL )
+            {
+                free( pSegment );
+                pSegment = NULL;
+            }
+        }
+    }
+
+    return pSegment;
+}
+
+/*============================================================================*/
+/*  NewFieldSegment                                                           */
+/*!
+    Create a formatted variable segment
+
+    The NewFieldSegment function creates a segment which formats the
+    value of a variable.  The format is compiled, and checked against
+    the type of the variable: string variables need a string conversion,
+    integer variables an integer or character conversion, and float
+    variables a floating point conversion.
+
+@param[in]
+    pVariable
+        pointer to the variable to format
+
+@param[in]
+    format
+        pointer to the printf style format, or NULL for a string variable
+
+@retval pointer to the new segment
+@retval NULL if the format cannot be built for the variable
+
+==============================================================================*/
+Segment *NewFieldSegment( Variable *pVariable, char *format )
+{
+    Segment *pSegment;
+    char *compiled = NULL;
+    char conversion = 's';
+    bool isString;
+    size_t width = 0;
+    char *p;
+
+    if ( pVariable == NULL )
+    {
+        return NULL;
+    }
+
+    isString = ( pVariable->obj.type == VARTYPE_STR );
+
+    if ( format == NULL )
+    {
+        if ( isString == false )
+        {
+            return NULL;
+        }
+
+        compiled = strdup( "%s" );
+    }
+    else if ( CompileFormat( format,
+                             pVariable->obj.type,
+                             &compiled,
+                             &conversion ) != EOK )
+    {
+        return NULL;
+    }
+
+    if ( ( compiled == NULL ) ||
+         ( isString != ( conversion == 's' ) ) ||
+         ( ( isString == false ) &&
+           ( IsNumeric( pVariable->obj.type ) == false ) ) ||
+         ( ( pVariable->obj.type == VARTYPE_FLOAT ) !=
+           ( strchr( "eEfFgG", conversion ) != NULL ) ) )
+    {
+        free( compiled );
+        return NULL;
+    }
+
+    pSegment = (Segment *)calloc( 1, sizeof( Segment ) );
+    if ( pSegment == NULL )
+    {
+        free( compiled );
+        return NULL;
+    }
+
+    /* allow for the field width and precision */
+    for ( p = compiled; *p != '\0'; p++ )
+    {
+        if ( isdigit( (unsigned char)*p ) )
+        {
+            width += strtoul( p, &p, 10 );
+            p--;
+        }
+    }
+
+    pSegment->type = SEGMENT_eFIELD;
+    pSegment->text = compiled;
+    pSegment->conversion = conversion;
+    pSegment->pVariable = pVariable;
+    pSegment->maxlen = strlen( compiled ) + width +
+                       ( isString ? MAX_STRING_FIELD_LEN
+                                  : MAX_NUMERIC_FIELD_LEN );
+
+    if ( ( isString == true ) && ( pVariable->hVar != VAR_INVALID ) )
+    {
+        pSegment->pBuffer = calloc( 1, MAX_STRING_FIELD_LEN );
+        if ( pSegment->pBuffer == NULL )
+        {
+            FreeSegments( pSegment );
+            pSegment = NULL;
+        }
+    }
+
+    return pSegment;
+}
+
+/*============================================================================*/
+/*  MergeSegments                                                             */
+/*!
+    Concatenate two segment lists
+
+    The MergeSegments function appends one segment list to another,
+    combining adjacent literal segments into a single segment.
+
+@param[in]
+    pLeft
+        pointer to the first segment list
+
+@param[in]
+    pRight
+        pointer to the segment list to append
+
+@retval pointer to the concatenated segment list
+
+==============================================================================*/
+Segment *MergeSegments( Segment *pLeft, Segment *pRight )
+{
+    Segment *pLast = pLeft;
+    Segment *pNext;
+    char *text;
+
+    if ( pLeft == NULL )
+    {
+        return pRight;
+    }
+
+    while ( pLast->pNext != NULL )
+    {
+        pLast = pLast->pNext;
+    }
+
+    if ( ( pRight != NULL ) &&
+         ( pLast->type == SEGMENT_eLITERAL ) &&
+         ( pRight->type == SEGMENT_eLITERAL ) )
+    {
+        text = realloc( pLast->text, pLast->len + pRight->len + 1 );
+        if ( text != NULL )
+        {
+            memcpy( &text[pLast->len], pRight->text, pRight->len + 1 );
+            pLast->text = text;
+            pLast->len += pRight->len;
+            pLast->maxlen = pLast->len;
+
+            pNext = pRight->pNext;
+            pRight->pNext = NULL;
+            FreeSegments( pRight );
+            pRight = pNext;
+        }
+    }
+
+    pLast->pNext = pRight;
+
+    return pLeft;
+}
+
+/*============================================================================*/
+/*  FreeSegments                                                              */
+/*!
+    Free a segment list
+
+@param[in]
+    pSegment
+        pointer to the first segment to free
+
+@return none
+
+==============================================================================*/
+void FreeSegments( Segment *pSegment )
+{
+    Segment *pNext;
+
+    while ( pSegment != NULL )
+    {
+        pNext = pSegment->pNext;
+        free( pSegment->text );
+        free( pSegment->pBuffer );
+        free( pSegment );
+        pSegment = pNext;
+    }
+}
+
+/*============================================================================*/
+/*  CompileFormat                                                             */
+/*!
+    Validate and compile a format specifier
+
+    The CompileFormat function checks that a printf style format
+    contains exactly one conversion without a length modifier, so the
+    string builder can format the value exactly as printf formats the
+    variable's native value.  The "ll" length modifier is added to
+    integer conversions of 64-bit variables.  Other formats are left to
+    the expression library.
+
+@param[in]
+    format
+        pointer to the format to compile
+
+@param[in]
+    type
+        VarServer type of the variable to format
+
+@param[out]
+    ppCompiled
+        pointer to a location to store the compiled format, which
+        must be freed by the caller.  May be NULL to only validate
+        the format.
+
+@param[out]
+    pConversion
+        pointer to a location to store the conversion character
+
+@retval EOK the format is valid
+@retval EINVAL the format cannot be used by a string builder
+@retval ENOMEM memory allocation failed
+
+==============================================================================*/
+int CompileFormat( char *format,
+                   int type,
+                   char **ppCompiled,
+                   char *pConversion )
+{
+    char *compiled;
+    char *p;
+    char *q;
+    char conversion = '\0';
+    int count = 0;
+    bool wide;
+
+    if ( format == NULL )
+    {
+        return EINVAL;
+    }
+
+    wide = ( type == VARTYPE_INT64 ) || ( type == VARTYPE_UINT64 );
+
+    /* allow for the "ll" length modifier */
+    compiled = calloc( 1, strlen( format ) + 3 );
+    if ( compiled == NULL )
+    {
+        return ENOMEM;
+    }
+
+    p = format;
+    q = compiled;
+    while ( *p != '\0' )
+    {
+        if ( *p != '%' )
+        {
+            *q++ = *p++;
+            continue;
+        }
+
+        *q++ = *p++;
+        if ( *p == '%' )
+        {
+            *q++ = *p++;
+            continue;
+        }
+
+        /* flags, field width and precision */
+        while ( ( *p != '\0' ) && ( strchr( "-+ #0", *p ) != NULL ) )
+        {
+            *q++ = *p++;
+        }
+
+        while ( isdigit( (unsigned char)*p ) )
+        {
+            *q++ = *p++;
+        }
+
+        if ( *p == '.' )
+        {
+            *q++ = *p++;
+            while ( isdigit( (unsigned char)*p ) )
+            {
+                *q++ = *p++;
+            }
+        }
+
+        if ( ( *p == '\0' ) || ( strchr( "diouxXeEfFgGcs", *p ) == NULL ) )
+        {
+            /* length modifiers change how the value is printed */
+            free( compiled );
+            return EINVAL;
+        }
+
+        conversion = *p++;
+        if ( ( wide == true ) && ( strchr( "diouxX", conversion ) != NULL ) )
+        {
+            *q++ = 'l';
+            *q++ = 'l';
+        }
+
+        *q++ = conversion;
+        count++;
+    }
+
+    if ( count != 1 )
+    {
+        free( compiled );
+        return EINVAL;
+    }
+
+    if ( pConversion != NULL )
+    {
+        *pConversion = conversion;
+    }
+
+    if ( ppCompiled != NULL )
+    {
+        *ppCompiled = compiled;
+    }
+    else
+    {
+        free( compiled );
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  NewStringBuilder                                                          */
+/*!
+    Create a string builder
+
+    The NewStringBuilder function creates a string builder which
+    assigns the concatenation of the specified segments to a string
+    system variable.  The output buffer is sized for the longest
+    possible result.
+
+@param[in]
+    hTarget
+        handle of the string system variable to assign
+
+@param[in]
+    pSegments
+        pointer to the segments to concatenate.  The string builder
+        takes ownership of the segments.
+
+@retval pointer to the new string builder
+@retval NULL if memory allocation failed
+
+==============================================================================*/
+StringBuilder *NewStringBuilder( VAR_HANDLE hTarget, Segment *pSegments )
+{
+    StringBuilder *pBuilder;
+    Segment *pSegment;
+    size_t size = 1;
+
+    pBuilder = (StringBuilder *)calloc( 1, sizeof( StringBuilder ) );
+    if ( pBuilder != NULL )
+    {
+        pBuilder->hTarget = hTarget;
+        pBuilder->pSegments = pSegments;
+
+        for ( pSegment = pSegments;
+              pSegment != NULL;
+              pSegment = pSegment->pNext )
+        {
+            size += pSegment->maxlen;
+        }
+
+        pBuilder->buffer = calloc( 1, size );
+        pBuilder->size = size;
+        if ( pBuilder->buffer == NULL )
+        {
+            pBuilder->pSegments = NULL;
+            FreeStringBuilder( pBuilder );
+            pBuilder = NULL;
+        }
+    }
+
+    if ( pBuilder == NULL )
+    {
+        FreeSegments( pSegments );
+    }
+
+    return pBuilder;
+}
+
+/*============================================================================*/
+/*  FreeStringBuilder                                                         */
+/*!
+    Free a string builder
+
+@param[in]
+    pBuilder
+        pointer to the string builder to free
+
+@return none
+
+==============================================================================*/
+void FreeStringBuilder( StringBuilder *pBuilder )
+{
+    if ( pBuilder != NULL )
+    {
+        FreeSegments( pBuilder->pSegments );
+        free( pBuilder->buffer );
+        free( pBuilder );
+    }
+}
+
+/*============================================================================*/
+/*  RunStringBuilder                                                          */
+/*!
+    Run a string builder
+
+    The RunStringBuilder function appends all of the segments of a string
+    builder into its output buffer, and assigns the result to its
+    string system variable.  If a string field cannot be read, for
+    example because its value is longer than MAX_STRING_FIELD_LEN, or
+    the result does not fit in the output buffer, for example because
+    a local string variable is longer than MAX_STRING_FIELD_LEN,
+    nothing is assigned, and the caller evaluates the original
+    assignment instead.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pBuilder
+        pointer to the string builder to run
+
+@retval EOK the string was assigned
+@retval EINVAL invalid arguments
+@retval ENOENT a field could not be read, or the result would have
+               been truncated, so nothing was assigned
+@retval EIO the string could not be assigned
+
+==============================================================================*/
+int RunStringBuilder( VARSERVER_HANDLE hVarServer, StringBuilder *pBuilder )
+{
+    Segment *pSegment;
+    Variable *pVariable;
+    VarObject obj;
+    size_t len = 0;
+    int result = ( pBuilder != NULL ) ? EOK : EINVAL;
+
+    for ( pSegment = ( pBuilder != NULL ) ? pBuilder->pSegments : NULL;
+          ( pSegment != NULL ) && ( result == EOK );
+          pSegment = pSegment->pNext )
+    {
+        if ( pSegment->type == SEGMENT_eLITERAL )
+        {
+            if ( pSegment->len >= pBuilder->size - len )
+            {
+                /* do not assign a truncated string */
+                result = ENOENT;
+            }
+            else
+            {
+                memcpy( &pBuilder->buffer[len],
+                        pSegment->text,
+                        pSegment->len );
+                len += pSegment->len;
+            }
+
+            continue;
+        }
+
+        pVariable = pSegment->pVariable;
+        if ( pVariable->hVar != VAR_INVALID )
+        {
+            /* read the system variable */
+            memset( &obj, 0, sizeof( VarObject ) );
+            obj.type = pVariable->obj.type;
+            if ( obj.type == VARTYPE_STR )
+            {
+                obj.val.str = pSegment->pBuffer;
+                obj.len = MAX_STRING_FIELD_LEN;
+            }
+
+            if ( VAR_Get( hVarServer, pVariable->hVar, &obj ) != EOK )
+            {
+                /* do not assign a string with a missing field */
+                result = ENOENT;
+                continue;
+            }
+        }
+        else
+        {
+            /* local variable, which may be longer than the field */
+            obj = pVariable->obj;
+        }
+
+        result = FormatField( pSegment,
+                              &obj,
+                              &pBuilder->buffer[len],
+                              pBuilder->size - len,
+                              &len );
+    }
+
+    if ( result == EOK )
+    {
+        pBuilder->buffer[len] = '\0';
+
+        memset( &obj, 0, sizeof( VarObject ) );
+        obj.type = VARTYPE_STR;
+        obj.val.str = pBuilder->buffer;
+        obj.len = len + 1;
+
+        if ( WriteVar( hVarServer, pBuilder->hTarget, &obj ) != EOK )
+        {
+            result = EIO;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FormatField                                                               */
+/*!
+    Format a variable value into the output buffer
+
+@param[in]
+    pSegment
+        pointer to the field segment
+
+@param[in]
+    pObj
+        pointer to the variable value
+
+@param[in]
+    buffer
+        pointer to the output location
+
+@param[in]
+    size
+        space remaining in the output buffer
+
+@param[in,out]
+    pLen
+        pointer to the length of the output, which is advanced by the
+        number of characters written
+
+@retval EOK the field was written
+@retval ENOENT the field does not fit in the output buffer
+
+==============================================================================*/
+static int FormatField( Segment *pSegment,
+                        VarObject *pObj,
+                        char *buffer,
+                        size_t size,
+                        size_t *pLen )
+{
+    double d = 0.0;
+    int n = 0;
+    int result = EOK;
+
+    /* pass the value as printf receives the variable's native type */
+    switch ( pSegment->conversion )
+    {
+        case 's':
+            if ( ( pObj->type == VARTYPE_STR ) && ( pObj->val.str != NULL ) )
+            {
+                n = snprintf( buffer, size, pSegment->text, pObj->val.str );
+            }
+            break;
+
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+            (void)ToReal( pObj, &d );
+            n = snprintf( buffer, size, pSegment->text, d );
+            break;
+
+        default:
+            switch ( pObj->type )
+            {
+                case VARTYPE_UINT16:
+                    n = snprintf( buffer, size, pSegment->text, pObj->val.ui );
+                    break;
+
+                case VARTYPE_INT16:
+                    n = snprintf( buffer, size, pSegment->text, pObj->val.i );
+                    break;
+
+                case VARTYPE_UINT32:
+                    n = snprintf( buffer, size, pSegment->text, pObj->val.ul );
+                    break;
+
+                case VARTYPE_INT32:
+                    n = snprintf( buffer, size, pSegment->text, pObj->val.l );
+                    break;
+
+                case VARTYPE_UINT64:
+                    n = snprintf( buffer,
+                                  size,
+                                  pSegment->text,
+                                  (unsigned long long)pObj->val.ull );
+                    break;
+
+                case VARTYPE_INT64:
+                    n = snprintf( buffer,
+                                  size,
+                                  pSegment->text,
+                                  (long long)pObj->val.ll );
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+    }
+
+    if ( (size_t)n >= size )
+    {
+        /* the output was truncated */
+        result = ENOENT;
+    }
+    else if ( n > 0 )
+    {
+        *pLen += (size_t)n;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  IsNumeric                                                                 */
+/*!
+    Check if a variable type is numeric
+
+@param[in]
+    type
+        the VarServer type to check
+
+@retval true the type is numeric
+@retval false the type is not numeric
+
+==============================================================================*/
+static bool IsNumeric( int type )
+{
+    return ( type == VARTYPE_UINT16 ) ||
+           ( type == VARTYPE_INT16 ) ||
+           ( type == VARTYPE_UINT32 ) ||
+           ( type == VARTYPE_INT32 ) ||
+           ( type == VARTYPE_UINT64 ) ||
+           ( type == VARTYPE_INT64 ) ||
+           ( type == VARTYPE_FLOAT );
+}
+
+/*============================================================================*/
+/*  ToInteger                                                                 */
+/*!
+    Get the integer value of a numeric variable
+
+@param[in]
+    pObj
+        pointer to the variable value
+
+@param[out]
+    pValue
+        pointer to a location to store the integer value
+
+@param[out]
+    pBits
+        pointer to a location to store the width of the variable type
+
+@retval true the value was converted
+@retval false the value is not numeric
+
+==============================================================================*/
+static bool ToInteger( VarObject *pObj, int64_t *pValue, int *pBits )
+{
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:    *pValue = pObj->val.ui; *pBits = 16; break;
+        case VARTYPE_INT16:     *pValue = pObj->val.i; *pBits = 16; break;
+        case VARTYPE_UINT32:    *pValue = pObj->val.ul; *pBits = 32; break;
+        case VARTYPE_INT32:     *pValue = pObj->val.l; *pBits = 32; break;
+        case VARTYPE_UINT64:    *pValue = (int64_t)pObj->val.ull; break;
+        case VARTYPE_INT64:     *pValue = pObj->val.ll; break;
+        case VARTYPE_FLOAT:     *pValue = (int64_t)pObj->val.f; break;
+        default:                return false;
+    }
+
+    return true;
+}
+
+/*============================================================================*/
+/*  ToReal                                                                    */
+/*!
+    Get the floating point value of a numeric variable
+
+@param[in]
+    pObj
+        pointer to the variable value
+
+@param[out]
+    pValue
+        pointer to a location to store the floating point value
+
+@retval true the value was converted
+@retval false the value is not numeric
+
+==============================================================================*/
+static bool ToReal( VarObject *pObj, double *pValue )
+{
+    int64_t ll;
+    int bits;
+
+    if ( pObj->type == VARTYPE_FLOAT )
+    {
+        *pValue = pObj->val.f;
+        return true;
+    }
+
+    if ( ToInteger( pObj, &ll, &bits ) == true )
+    {
+        *pValue = (double)ll;
+        return true;
+    }
+
+    return false;
+}
+
+/*! @}
+ * end of strbuild group */
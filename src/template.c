@@ -0,0 +1,633 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup template template
+ * @brief Parameterized action templates
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file template.c
+
+    Action Templates
+
+    The template component stores parameterized action templates
+    and expands template instances into action script text.
+
+    Templates are expanded by the lexical analyzer before parsing,
+    so each instance is compiled into fully specialized actions with
+    the template parameters replaced by the instance arguments.
+
+    Parameters are replaced wherever they appear as a complete
+    identifier or number.  Text inside strings and scripts is
+    not substituted.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include "template.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! text buffer */
+typedef struct _textBuffer
+{
+    /*! pointer to the text */
+    char *text;
+
+    /*! length of the text */
+    size_t len;
+
+    /*! size of the buffer */
+    size_t size;
+} TextBuffer;
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! list of defined templates */
+static Template *pTemplates = NULL;
+
+/*! template currently being defined */
+static Template *pDefinition = NULL;
+
+/*! template currently being instantiated */
+static Template *pInstance = NULL;
+
+/*! arguments of the template currently being instantiated */
+static char *args[MAX_TEMPLATE_PARAMS];
+
+/*! number of arguments of the template currently being instantiated */
+static int nargs = 0;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static int Append( TextBuffer *pBuffer, const char *text, size_t len );
+static bool IsWordChar( char c );
+static size_t SkipQuoted( const char *text );
+static char *FindArgument( char *word, size_t len );
+static void FreeArguments( void );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewTemplate                                                               */
+/*!
+    Start a new template definition
+
+    The NewTemplate function starts the definition of a new template.
+    The template parameters and body are added by AddTemplateParam and
+    AppendTemplateBody, and the definition is completed by EndTemplate.
+
+@param[in]
+    name
+        pointer to the template name
+
+@retval EOK the template definition was started
+@retval EEXIST a template with this name already exists
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int NewTemplate( char *name )
+{
+    int result = EINVAL;
+
+    if ( name != NULL )
+    {
+        if ( FindTemplate( name ) != NULL )
+        {
+            result = EEXIST;
+        }
+        else
+        {
+            pDefinition = (Template *)calloc( 1, sizeof( Template ) );
+            if ( pDefinition != NULL )
+            {
+                pDefinition->name = strdup( name );
+                result = ( pDefinition->name != NULL ) ? EOK : ENOMEM;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddTemplateParam                                                          */
+/*!
+    Add a parameter to the template being defined
+
+@param[in]
+    name
+        pointer to the parameter name
+
+@retval EOK the parameter was added
+@retval E2BIG the template has too many parameters
+@retval ENOMEM memory allocation failed
+@retval EINVAL no template is being defined
+
+==============================================================================*/
+int AddTemplateParam( char *name )
+{
+    int result = EINVAL;
+
+    if ( ( pDefinition != NULL ) && ( name != NULL ) )
+    {
+        if ( pDefinition->nparams >= MAX_TEMPLATE_PARAMS )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            pDefinition->params[pDefinition->nparams] = strdup( name );
+            if ( pDefinition->params[pDefinition->nparams] != NULL )
+            {
+                pDefinition->nparams++;
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AppendTemplateBody                                                        */
+/*!
+    Append text to the body of the template being defined
+
+@param[in]
+    text
+        pointer to the text to append
+
+@retval EOK the text was appended
+@retval ENOMEM memory allocation failed
+@retval EINVAL no template is being defined
+
+==============================================================================*/
+int AppendTemplateBody( char *text )
+{
+    int result = EINVAL;
+    TextBuffer buffer;
+
+    if ( ( pDefinition != NULL ) && ( text != NULL ) )
+    {
+        buffer.text = pDefinition->body;
+        buffer.len = pDefinition->len;
+        buffer.size = pDefinition->size;
+
+        result = Append( &buffer, text, strlen( text ) );
+
+        pDefinition->body = buffer.text;
+        pDefinition->len = buffer.len;
+        pDefinition->size = buffer.size;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EndTemplate                                                               */
+/*!
+    Complete the template definition
+
+    The EndTemplate function adds the template being defined to the
+    list of templates which can be instantiated.
+
+@retval EOK the template was defined
+@retval EINVAL no template is being defined
+
+==============================================================================*/
+int EndTemplate( void )
+{
+    int result = EINVAL;
+
+    if ( pDefinition != NULL )
+    {
+        if ( pDefinition->body == NULL )
+        {
+            pDefinition->body = strdup( "" );
+        }
+
+        pDefinition->pNext = pTemplates;
+        pTemplates = pDefinition;
+        pDefinition = NULL;
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindTemplate                                                              */
+/*!
+    Find a template by name
+
+@param[in]
+    name
+        pointer to the template name
+
+@retval pointer to the template
+@retval NULL if no template has this name
+
+==============================================================================*/
+Template *FindTemplate( char *name )
+{
+    Template *pTemplate = pTemplates;
+
+    if ( name != NULL )
+    {
+        while ( pTemplate != NULL )
+        {
+            if ( strcmp( pTemplate->name, name ) == 0 )
+            {
+                break;
+            }
+
+            pTemplate = pTemplate->pNext;
+        }
+    }
+    else
+    {
+        pTemplate = NULL;
+    }
+
+    return pTemplate;
+}
+
+/*============================================================================*/
+/*  BeginInstance                                                             */
+/*!
+    Start a template instance
+
+    The BeginInstance function starts the instantiation of a template.
+    The instance arguments are added by AddInstanceArg, and the
+    instance is expanded by EndInstance.
+
+@param[in]
+    pTemplate
+        pointer to the template to instantiate
+
+@retval EOK the instance was started
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int BeginInstance( Template *pTemplate )
+{
+    int result = EINVAL;
+
+    if ( pTemplate != NULL )
+    {
+        FreeArguments();
+        pInstance = pTemplate;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddInstanceArg                                                            */
+/*!
+    Add an argument to the template instance
+
+@param[in]
+    arg
+        pointer to the argument text
+
+@retval EOK the argument was added
+@retval E2BIG the instance has too many arguments
+@retval ENOMEM memory allocation failed
+@retval EINVAL no template is being instantiated
+
+==============================================================================*/
+int AddInstanceArg( char *arg )
+{
+    int result = EINVAL;
+
+    if ( ( pInstance != NULL ) && ( arg != NULL ) )
+    {
+        if ( nargs >= MAX_TEMPLATE_PARAMS )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            args[nargs] = strdup( arg );
+            if ( args[nargs] != NULL )
+            {
+                nargs++;
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EndInstance                                                               */
+/*!
+    Expand the template instance
+
+    The EndInstance function creates the text of the template instance
+    by replacing each template parameter in the template body with
+    the corresponding instance argument.
+
+@retval pointer to the expanded text, which must be freed by the caller
+@retval NULL if the number of arguments does not match the template
+        or memory allocation failed
+
+==============================================================================*/
+char *EndInstance( void )
+{
+    TextBuffer buffer;
+    char *body;
+    char *arg;
+    size_t len;
+    int rc = EOK;
+
+    memset( &buffer, 0, sizeof( TextBuffer ) );
+
+    if ( ( pInstance == NULL ) || ( nargs != pInstance->nparams ) )
+    {
+        FreeArguments();
+        pInstance = NULL;
+        return NULL;
+    }
+
+    body = pInstance->body;
+    while ( ( *body != '\0' ) && ( rc == EOK ) )
+    {
+        if ( IsWordChar( *body ) )
+        {
+            /* substitute complete words which match a parameter */
+            len = 0;
+            while ( IsWordChar( body[len] ) )
+            {
+                len++;
+            }
+
+            arg = FindArgument( body, len );
+            if ( arg != NULL )
+            {
+                rc = Append( &buffer, arg, strlen( arg ) );
+            }
+            else
+            {
+                rc = Append( &buffer, body, len );
+            }
+        }
+        else
+        {
+            /* copy strings, scripts and comments unchanged */
+            len = SkipQuoted( body );
+            rc = Append( &buffer, body, len );
+        }
+
+        body += len;
+    }
+
+    if ( ( rc == EOK ) && ( buffer.text == NULL ) )
+    {
+        rc = Append( &buffer, "", 0 );
+    }
+
+    if ( rc != EOK )
+    {
+        free( buffer.text );
+        buffer.text = NULL;
+    }
+
+    FreeArguments();
+    pInstance = NULL;
+
+    return buffer.text;
+}
+
+/*============================================================================*/
+/*  Append                                                                    */
+/*!
+    Append text to a text buffer
+
+@param[in,out]
+    pBuffer
+        pointer to the text buffer
+
+@param[in]
+    text
+        pointer to the text to append
+
+@param[in]
+    len
+        length of the text to append
+
+@retval EOK the text was appended
+@retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int Append( TextBuffer *pBuffer, const char *text, size_t len )
+{
+    size_t size;
+    char *p;
+
+    if ( pBuffer->len + len + 1 > pBuffer->size )
+    {
+        size = ( pBuffer->size == 0 ) ? 256 : pBuffer->size;
+        while ( pBuffer->len + len + 1 > size )
+        {
+            size *= 2;
+        }
+
+        p = realloc( pBuffer->text, size );
+        if ( p == NULL )
+        {
+            return ENOMEM;
+        }
+
+        pBuffer->text = p;
+        pBuffer->size = size;
+    }
+
+    memcpy( &pBuffer->text[pBuffer->len], text, len );
+    pBuffer->len += len;
+    pBuffer->text[pBuffer->len] = '\0';
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  IsWordChar                                                                */
+/*!
+    Check if a character is part of an identifier or number
+
+@param[in]
+    c
+        the character to check
+
+@retval true the character is part of an identifier or number
+@retval false the character is not part of an identifier or number
+
+==============================================================================*/
+static bool IsWordChar( char c )
+{
+    return ( isalnum( (unsigned char)c ) ) ||
+           ( c == '_' ) ||
+           ( c == '/' ) ||
+           ( c == '.' );
+}
+
+/*============================================================================*/
+/*  SkipQuoted                                                                */
+/*!
+    Get the length of a non-substituted section of template text
+
+    The SkipQuoted function gets the length of the string, script,
+    comment or single character at the start of the specified text.
+
+@param[in]
+    text
+        pointer to the template text
+
+@retval length of the section
+
+==============================================================================*/
+static size_t SkipQuoted( const char *text )
+{
+    const char *p = text;
+    const char *end;
+
+    if ( *p == '"' )
+    {
+        end = strchr( p + 1, '"' );
+        return ( end != NULL ) ? (size_t)( end - p ) + 1 : strlen( p );
+    }
+    else if ( strncmp( p, "```", 3 ) == 0 )
+    {
+        end = strstr( p + 3, "```" );
+        return ( end != NULL ) ? (size_t)( end - p ) + 3 : strlen( p );
+    }
+    else if ( *p == '#' )
+    {
+        end = strchr( p, '\n' );
+        return ( end != NULL ) ? (size_t)( end - p ) : strlen( p );
+    }
+
+    return 1;
+}
+
+/*============================================================================*/
+/*  FindArgument                                                              */
+/*!
+    Find the instance argument for a template parameter
+
+@param[in]
+    word
+        pointer to the word in the template body
+
+@param[in]
+    len
+        length of the word
+
+@retval pointer to the instance argument for the parameter
+@retval NULL if the word is not a template parameter
+
+==============================================================================*/
+static char *FindArgument( char *word, size_t len )
+{
+    int i;
+
+    for ( i = 0; i < pInstance->nparams; i++ )
+    {
+        if ( ( strlen( pInstance->params[i] ) == len ) &&
+             ( strncmp( pInstance->params[i], word, len ) == 0 ) )
+        {
+            return args[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  FreeArguments                                                             */
+/*!
+    Free the arguments of the template instance
+
+@return none
+
+==============================================================================*/
+static void FreeArguments( void )
+{
+    int i;
+
+    for ( i = 0; i < nargs; i++ )
+    {
+        free( args[i] );
+        args[i] = NULL;
+    }
+
+    nargs = 0;
+}
+
+/*! @}
+ * end of template group */
@@ -37,6 +37,11 @@ SOFTWARE.
     The timer component provides functions for manipulating timers.
 
     - create repeating tick timer
+    - stagger the initial phases of the tick timers
+    - create, start and cancel one-shot timers
+    - create wall clock aligned and calendar (cron) schedules
+    - calculate per-instance schedule jitter
+    - convert time spans to milliseconds
 
 */
 /*============================================================================*/
@@ -56,18 +61,63 @@ SOFTWARE.
 #include <signal.h>
 #include <time.h>
 #include "timer.h"
+#include "cron.h"
 
 /*==============================================================================
        Function declarations
 ==============================================================================*/
 
+static int CreateSchedule( uint64_t period, CronSpec *pCron, uint64_t offset );
+static int ArmTick( int timerID, uint64_t first );
+static uint64_t ResumeDelay( int timerID );
+static void StaggerTicks( void );
+static uint64_t gcd( uint64_t a, uint64_t b );
+static int ArmSchedule( int timerID );
+
 /*==============================================================================
        Definitions
 ==============================================================================*/
 
+#ifndef EOK
+#define EOK 0
+#endif
+
 /*! Maximum number of timers allowed */
 #define MAX_TIMERS ( 255 )
 
+/*! minimum spacing of staggered tick timers in milliseconds */
+#define MIN_STAGGER_SLOT ( 10 )
+
+/*! repeating tick timer */
+typedef struct _tick
+{
+    /*! repeat interval in milliseconds */
+    uint64_t interval;
+
+    /*! phase of the tick within its interval in milliseconds */
+    uint64_t phase;
+
+    /*! true if the phase was set explicitly */
+    bool fixed;
+
+    /*! wall clock time of the next firing in milliseconds, when resuming
+        the timer of a previous instance, otherwise 0 */
+    uint64_t resume;
+} Tick;
+
+/*! wall clock schedule */
+typedef struct _schedule
+{
+    /*! alignment period in milliseconds, or 0 for a calendar schedule */
+    uint64_t period;
+
+    /*! calendar schedule */
+    CronSpec cron;
+
+    /*! per-instance offset of the firing times in milliseconds */
+    uint64_t offset;
+} Schedule;
+
 /*==============================================================================
        File Scoped Variables
 ==============================================================================*/
@@ -78,6 +128,15 @@ static timer_t timers[MAX_TIMERS] = {0};
 /*! id of the next timer to create */
 static int id = 0;
 
+/*! wall clock schedules of the scheduled timers */
+static Schedule *schedules[MAX_TIMERS] = {0};
+
+/*! tick timers */
+static Tick ticks[MAX_TIMERS] = {0};
+
+/*! true once the tick timers have been started */
+static bool started = false;
+
 /*==============================================================================
        Function definitions
 ==============================================================================*/
@@ -88,7 +147,8 @@ static int id = 0;
     Create a tick timer
 
     The CreateTick creates a timer which will fire repeatedly
-    at a specified interval
+    at a specified interval.  Timers created before StartTimers is
+    called are armed by StartTimers.
 
 @param[in]
     num
@@ -106,10 +166,7 @@ static int id = 0;
 int CreateTick( int num, Timescale ts )
 {
     struct sigevent te;
-    struct itimerspec its;
-    time_t secs = 0;
-    long msecs = 0;
-    timer_t *timerID;
+    uint64_t interval;
     int result = -1;
 
     /* get the next timerid */
@@ -118,53 +175,345 @@ int CreateTick( int num, Timescale ts )
         /* get the next timer identifier */
         id++;
 
-        switch ( ts )
+        interval = TimespanToMs( num, ts );
+        if ( interval != 0 )
         {
-            case TIMESCALE_eMILLISECONDS:
-                secs = num / 1000;
-                msecs = num % 1000;
-                break;
+            /* Set and enable alarm */
+            memset( &te, 0, sizeof( te ) );
+            te.sigev_notify = SIGEV_SIGNAL;
+            te.sigev_signo = TIMER_NOTIFICATION;
+            te.sigev_value.sival_int = id;
+            timer_create(CLOCK_REALTIME, &te, &timers[id]);
 
-            case TIMESCALE_eSECONDS:
-                secs = num;
-                break;
+            ticks[id].interval = interval;
 
-            case TIMESCALE_eMINUTES:
-                secs = num * 60;
-                break;
+            /* the timer is armed by StartTimers, unless the timers have
+               already been started */
+            if ( started == true )
+            {
+                (void)ArmTick( id, interval );
+            }
 
-            case TIMESCALE_eHOURS:
-                secs = num * 3600;
-                break;
+            result = id;
+        }
+    }
 
-            case TIMESCALE_eDAYS:
-                secs = num * 86400;
-                break;
+    return result;
+}
 
-            case TIMESCALE_eWEEKS:
-                secs = num * 86400 * 7;
-                break;
+/*============================================================================*/
+/*  SetTickOffset                                                             */
+/*!
+    Set the phase of a tick timer
 
-            default:
-                break;
-        }
+    The SetTickOffset function sets the offset of a tick timer's firing
+    times within its interval, and excludes the timer from automatic
+    phase staggering.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateTick
+
+@param[in]
+    offset
+        offset of the firing times in milliseconds, which must be
+        less than the timer's interval
+
+@retval EOK the offset was set
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int SetTickOffset( int timerID, uint64_t offset )
+{
+    if ( ( timerID <= 0 ) ||
+         ( timerID > id ) ||
+         ( ticks[timerID].interval == 0 ) ||
+         ( offset >= ticks[timerID].interval ) )
+    {
+        return EINVAL;
+    }
+
+    ticks[timerID].phase = offset;
+    ticks[timerID].fixed = true;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  SetTickPeriod                                                             */
+/*!
+    Change the interval of a tick timer
+
+    The SetTickPeriod function changes the repeat interval of a tick
+    timer.  If the timers have been started, the timer is re-armed
+    immediately, keeping its phase if it still fits within the new
+    interval.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateTick
 
-        if ( ( secs != 0 ) || ( msecs != 0 ) )
+@param[in]
+    interval
+        new repeat interval in milliseconds
+
+@retval EOK the interval was changed
+@retval EINVAL invalid arguments
+@retval other error from timer_settime
+
+==============================================================================*/
+int SetTickPeriod( int timerID, uint64_t interval )
+{
+    if ( ( timerID <= 0 ) ||
+         ( timerID > id ) ||
+         ( ticks[timerID].interval == 0 ) ||
+         ( interval == 0 ) )
+    {
+        return EINVAL;
+    }
+
+    ticks[timerID].interval = interval;
+    if ( ticks[timerID].phase >= interval )
+    {
+        ticks[timerID].phase = 0;
+    }
+
+    return ( started == true ) ? ArmTick( timerID,
+                                          interval + ticks[timerID].phase )
+                               : EOK;
+}
+
+/*============================================================================*/
+/*  GetTickPeriod                                                             */
+/*!
+    Get the interval of a tick timer
+
+    The GetTickPeriod function gets the repeat interval of a tick timer.
+
+@param[in]
+    timerID
+        id of the timer
+
+@retval the repeat interval of the timer in milliseconds
+@retval 0 the timer is not a tick timer
+
+==============================================================================*/
+uint64_t GetTickPeriod( int timerID )
+{
+    return ( ( timerID > 0 ) && ( timerID <= id ) ) ? ticks[timerID].interval
+                                                    : 0;
+}
+
+/*============================================================================*/
+/*  GetTickNext                                                               */
+/*!
+    Get the next firing time of a tick timer
+
+    The GetTickNext function gets the wall clock time at which a
+    running tick timer will next fire, so its phase can be resumed
+    by a later instance with SetTickResume.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateTick
+
+@retval the next firing time in milliseconds since the epoch
+@retval 0 the timer is not a running tick timer
+
+==============================================================================*/
+uint64_t GetTickNext( int timerID )
+{
+    struct itimerspec its;
+    struct timespec now;
+
+    if ( ( timerID <= 0 ) ||
+         ( timerID > id ) ||
+         ( ticks[timerID].interval == 0 ) ||
+         ( timer_gettime( timers[timerID], &its ) != 0 ) ||
+         ( ( its.it_value.tv_sec == 0 ) && ( its.it_value.tv_nsec == 0 ) ) )
+    {
+        return 0;
+    }
+
+    clock_gettime( CLOCK_REALTIME, &now );
+
+    return ( now.tv_sec + its.it_value.tv_sec ) * 1000ULL +
+           ( now.tv_nsec + its.it_value.tv_nsec ) / 1000000L;
+}
+
+/*============================================================================*/
+/*  SetTickResume                                                             */
+/*!
+    Resume the phase of a tick timer
+
+    The SetTickResume function arranges for a tick timer to keep the
+    phase it had in a previous instance, given the time at which it
+    would next have fired.  It must be called before StartTimers.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateTick
+
+@param[in]
+    next
+        next firing time in the previous instance, in milliseconds
+        since the epoch
+
+@retval EOK the timer will be resumed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int SetTickResume( int timerID, uint64_t next )
+{
+    if ( ( timerID <= 0 ) ||
+         ( timerID > id ) ||
+         ( ticks[timerID].interval == 0 ) ||
+         ( next == 0 ) ||
+         ( started == true ) )
+    {
+        return EINVAL;
+    }
+
+    ticks[timerID].resume = next;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  StartTimers                                                               */
+/*!
+    Start the tick timers
+
+    The StartTimers function arms all the tick timers.  When staggering
+    is enabled, the tick timers without an explicit offset are given
+    different initial phases, so timers with compatible intervals do
+    not fire together.  Timers resumed from a previous instance keep
+    the phase they had in that instance.
+
+@param[in]
+    stagger
+        true to stagger the initial phases of the tick timers
+
+@retval EOK the timers were started
+@retval other error from timer_settime
+
+==============================================================================*/
+int StartTimers( bool stagger )
+{
+    int result = EOK;
+    int rc;
+    int i;
+
+    if ( stagger == true )
+    {
+        StaggerTicks();
+    }
+
+    for ( i = 1; i <= id; i++ )
+    {
+        if ( ticks[i].interval != 0 )
         {
-            timerID = &timers[id];
+            rc = ArmTick( i, ( ticks[i].resume != 0 )
+                                ? ResumeDelay( i )
+                                : ticks[i].interval + ticks[i].phase );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+    }
 
-            /* Set and enable alarm */
-            te.sigev_notify = SIGEV_SIGNAL;
-            te.sigev_signo = TIMER_NOTIFICATION;
-            te.sigev_value.sival_int = id;
-            timer_create(CLOCK_REALTIME, &te, timerID);
+    started = true;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TimespanToMs                                                              */
+/*!
+    Convert a time span to milliseconds
+
+    The TimespanToMs function converts a time span specified in
+    units of a time scale into milliseconds
+
+@param[in]
+    num
+        the time span in units of timescale
+
+@param[in]
+    ts
+        time scale of the time span
+
+@retval the time span in milliseconds
+@retval 0 if the time scale is invalid
+
+==============================================================================*/
+uint64_t TimespanToMs( int num, Timescale ts )
+{
+    uint64_t ms = 0;
+
+    switch ( ts )
+    {
+        case TIMESCALE_eMILLISECONDS:
+            ms = (uint64_t)num;
+            break;
+
+        case TIMESCALE_eSECONDS:
+            ms = (uint64_t)num * 1000;
+            break;
+
+        case TIMESCALE_eMINUTES:
+            ms = (uint64_t)num * 60 * 1000;
+            break;
+
+        case TIMESCALE_eHOURS:
+            ms = (uint64_t)num * 3600 * 1000;
+            break;
+
+        case TIMESCALE_eDAYS:
+            ms = (uint64_t)num * 86400 * 1000;
+            break;
+
+        case TIMESCALE_eWEEKS:
+            ms = (uint64_t)num * 86400 * 7 * 1000;
+            break;
+
+        default:
+            break;
+    }
+
+    return ms;
+}
 
-            its.it_interval.tv_sec = secs;
-            its.it_interval.tv_nsec = msecs * 1000000L;
-            its.it_value.tv_sec = secs;
-            its.it_value.tv_nsec = msecs * 1000000L;
-            timer_settime(*timerID, 0, &its, NULL);
+/*============================================================================*/
+/*  CreateOneShot                                                             */
+/*!
+    Create a one-shot timer
+
+    The CreateOneShot function creates a timer which fires once each
+    time it is started by StartOneShot.  The timer is created stopped,
+    so it does not generate any wakeups until it is started.
+
+@retval id of the timer that was created
+@retval -1 if no timer could be created
+
+==============================================================================*/
+int CreateOneShot( void )
+{
+    struct sigevent te;
+    int result = -1;
 
+    /* get the next timerid */
+    if ( (id + 1) < MAX_TIMERS )
+    {
+        memset( &te, 0, sizeof( te ) );
+        te.sigev_notify = SIGEV_SIGNAL;
+        te.sigev_signo = TIMER_NOTIFICATION;
+        te.sigev_value.sival_int = id + 1;
+
+        if ( timer_create( CLOCK_MONOTONIC, &te, &timers[id + 1] ) == 0 )
+        {
+            id++;
             result = id;
         }
     }
@@ -172,3 +521,539 @@ int CreateTick( int num, Timescale ts )
     return result;
 }
 
+/*============================================================================*/
+/*  StartOneShot                                                              */
+/*!
+    Start a one-shot timer
+
+    The StartOneShot function starts a one-shot timer.  If the timer is
+    already running, it is restarted with the new delay.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateOneShot
+
+@param[in]
+    ms
+        delay until the timer fires, in milliseconds
+
+@retval EOK the timer was started
+@retval EINVAL invalid arguments
+@retval other error from timer_settime
+
+==============================================================================*/
+int StartOneShot( int timerID, uint64_t ms )
+{
+    struct itimerspec its;
+
+    if ( ( timerID <= 0 ) || ( timerID > id ) || ( ms == 0 ) )
+    {
+        return EINVAL;
+    }
+
+    memset( &its, 0, sizeof( its ) );
+    its.it_value.tv_sec = ms / 1000;
+    its.it_value.tv_nsec = ( ms % 1000 ) * 1000000L;
+
+    return ( timer_settime( timers[timerID], 0, &its, NULL ) == 0 ) ? EOK
+                                                                    : errno;
+}
+
+/*============================================================================*/
+/*  CancelOneShot                                                             */
+/*!
+    Cancel a one-shot timer
+
+    The CancelOneShot function stops a one-shot timer if it is running.
+
+@param[in]
+    timerID
+        id of the timer returned by CreateOneShot
+
+@retval EOK the timer was stopped
+@retval EINVAL invalid arguments
+@retval other error from timer_settime
+
+==============================================================================*/
+int CancelOneShot( int timerID )
+{
+    struct itimerspec its;
+
+    if ( ( timerID <= 0 ) || ( timerID > id ) )
+    {
+        return EINVAL;
+    }
+
+    memset( &its, 0, sizeof( its ) );
+
+    return ( timer_settime( timers[timerID], 0, &its, NULL ) == 0 ) ? EOK
+                                                                    : errno;
+}
+
+/*============================================================================*/
+/*  CreateAligned                                                             */
+/*!
+    Create a wall clock aligned timer
+
+    The CreateAligned function creates a timer which fires at the
+    multiples of its interval in local time, so an hourly timer fires
+    on the hour and a daily timer fires at midnight, regardless of
+    when the process was started.  Weekly timers fire at midnight
+    on Monday.
+
+@param[in]
+    num
+        repeat interval of the timer in units of timescale
+
+@param[in]
+    ts
+        time scale of the repeat interval
+
+@param[in]
+    offset
+        offset of the firing times after the aligned times,
+        in milliseconds
+
+@retval id of the timer that was created
+@retval -1 if no timer could be created
+
+==============================================================================*/
+int CreateAligned( int num, Timescale ts, uint64_t offset )
+{
+    uint64_t period = TimespanToMs( num, ts );
+
+    return ( period != 0 ) ? CreateSchedule( period, NULL, offset ) : -1;
+}
+
+/*============================================================================*/
+/*  CreateCron                                                                */
+/*!
+    Create a calendar timer
+
+    The CreateCron function creates a timer which fires at the local
+    times selected by a calendar schedule
+
+@param[in]
+    pCron
+        pointer to the calendar schedule
+
+@param[in]
+    offset
+        offset of the firing times after the scheduled times,
+        in milliseconds
+
+@retval id of the timer that was created
+@retval -1 if no timer could be created
+
+==============================================================================*/
+int CreateCron( CronSpec *pCron, uint64_t offset )
+{
+    return ( pCron != NULL ) ? CreateSchedule( 0, pCron, offset ) : -1;
+}
+
+/*============================================================================*/
+/*  RearmTimer                                                                */
+/*!
+    Re-arm a scheduled timer
+
+    The RearmTimer function arms a wall clock or calendar timer for
+    its next firing time.  It must be called each time the timer
+    fires.  Tick and one-shot timers are not affected.
+
+@param[in]
+    timerID
+        id of the timer which fired
+
+@retval EOK the timer was re-armed
+@retval ENOENT the timer is not a scheduled timer
+@retval other error from the timer
+
+==============================================================================*/
+int RearmTimer( int timerID )
+{
+    if ( ( timerID <= 0 ) ||
+         ( timerID > id ) ||
+         ( schedules[timerID] == NULL ) )
+    {
+        return ENOENT;
+    }
+
+    return ArmSchedule( timerID );
+}
+
+/*============================================================================*/
+/*  InstanceJitter                                                            */
+/*!
+    Calculate a per-instance schedule jitter
+
+    The InstanceJitter function calculates a stable offset in the range
+    [0, range) from a hash of the host name and the specified key.
+    Each device running the same script gets a different offset, but
+    a device keeps its offset across restarts, so scheduled batch work
+    is spread evenly over a window.
+
+@param[in]
+    key
+        key identifying the schedule within the host, such as the
+        script name and line number
+
+@param[in]
+    range
+        jitter range in milliseconds
+
+@retval the jitter offset in milliseconds
+
+==============================================================================*/
+uint64_t InstanceJitter( const char *key, uint64_t range )
+{
+    char hostname[256];
+    uint64_t hash = 14695981039346656037ULL;
+    const char *p;
+    int i;
+
+    if ( range == 0 )
+    {
+        return 0;
+    }
+
+    if ( gethostname( hostname, sizeof( hostname ) ) != 0 )
+    {
+        hostname[0] = '\0';
+    }
+
+    hostname[sizeof( hostname ) - 1] = '\0';
+
+    /* FNV-1a hash of the host name and key */
+    for ( i = 0; i < 2; i++ )
+    {
+        p = ( i == 0 ) ? hostname : key;
+        while ( ( p != NULL ) && ( *p != '\0' ) )
+        {
+            hash ^= (unsigned char)*p++;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    return hash % range;
+}
+
+/*============================================================================*/
+/*  CreateSchedule                                                            */
+/*!
+    Create a scheduled timer
+
+    The CreateSchedule function creates a real time clock timer and
+    arms it for the first firing time of its schedule.
+
+@param[in]
+    period
+        alignment period in milliseconds, or 0 for a calendar schedule
+
+@param[in]
+    pCron
+        pointer to the calendar schedule, or NULL for an aligned timer
+
+@param[in]
+    offset
+        offset of the firing times in milliseconds
+
+@retval id of the timer that was created
+@retval -1 if no timer could be created
+
+==============================================================================*/
+static int CreateSchedule( uint64_t period, CronSpec *pCron, uint64_t offset )
+{
+    struct sigevent te;
+    Schedule *pSchedule;
+    int timerID;
+
+    if ( (id + 1) >= MAX_TIMERS )
+    {
+        return -1;
+    }
+
+    pSchedule = (Schedule *)calloc( 1, sizeof( Schedule ) );
+    if ( pSchedule == NULL )
+    {
+        return -1;
+    }
+
+    pSchedule->period = period;
+    pSchedule->offset = offset;
+    if ( pCron != NULL )
+    {
+        pSchedule->cron = *pCron;
+    }
+
+    timerID = id + 1;
+
+    memset( &te, 0, sizeof( te ) );
+    te.sigev_notify = SIGEV_SIGNAL;
+    te.sigev_signo = TIMER_NOTIFICATION;
+    te.sigev_value.sival_int = timerID;
+
+    /* an absolute real time clock timer follows wall clock changes */
+    if ( timer_create( CLOCK_REALTIME, &te, &timers[timerID] ) != 0 )
+    {
+        free( pSchedule );
+        return -1;
+    }
+
+    /* the timer id is only used up once the timer has been armed */
+    schedules[timerID] = pSchedule;
+    if ( ArmSchedule( timerID ) != EOK )
+    {
+        schedules[timerID] = NULL;
+        timer_delete( timers[timerID] );
+        free( pSchedule );
+        return -1;
+    }
+
+    id = timerID;
+
+    return timerID;
+}
+
+/*============================================================================*/
+/*  ArmSchedule                                                               */
+/*!
+    Arm a scheduled timer
+
+    The ArmSchedule function arms a scheduled timer to fire once at
+    the next firing time of its schedule after the current time.
+
+@param[in]
+    timerID
+        id of the scheduled timer
+
+@retval EOK the timer was armed
+@retval ENOENT the schedule never fires
+@retval other error from timer_settime
+
+==============================================================================*/
+static int ArmSchedule( int timerID )
+{
+    Schedule *pSchedule = schedules[timerID];
+    struct itimerspec its;
+    struct timespec now;
+    struct tm tm;
+    uint64_t nowMs;
+    uint64_t base;
+    uint64_t next;
+    int64_t gmtoff;
+    time_t t;
+
+    clock_gettime( CLOCK_REALTIME, &now );
+    nowMs = (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000L;
+
+    /* the scheduled times are shifted later by the offset */
+    base = ( nowMs > pSchedule->offset ) ? nowMs - pSchedule->offset : 0;
+
+    if ( pSchedule->period != 0 )
+    {
+        /* align to the period in local time */
+        t = (time_t)( base / 1000 );
+        localtime_r( &t, &tm );
+        gmtoff = (int64_t)tm.tm_gmtoff * 1000;
+
+        if ( pSchedule->period % TimespanToMs( 1, TIMESCALE_eWEEKS ) == 0 )
+        {
+            /* 1 January 1970 was a Thursday, so weeks start on Monday */
+            gmtoff -= (int64_t)TimespanToMs( 4, TIMESCALE_eDAYS );
+        }
+
+        next = ( ( base + gmtoff ) / pSchedule->period + 1 ) *
+               pSchedule->period - gmtoff;
+    }
+    else
+    {
+        t = NextCron( &pSchedule->cron, (time_t)( base / 1000 ) );
+        if ( t == (time_t)-1 )
+        {
+            return ENOENT;
+        }
+
+        next = (uint64_t)t * 1000;
+    }
+
+    next += pSchedule->offset;
+
+    memset( &its, 0, sizeof( its ) );
+    its.it_value.tv_sec = next / 1000;
+    its.it_value.tv_nsec = ( next % 1000 ) * 1000000L;
+
+    return ( timer_settime( timers[timerID],
+                            TIMER_ABSTIME,
+                            &its,
+                            NULL ) == 0 ) ? EOK : errno;
+}
+
+/*============================================================================*/
+/*  ArmTick                                                                   */
+/*!
+    Arm a tick timer
+
+    The ArmTick function arms a tick timer to fire repeatedly at its
+    interval, starting after the specified delay.  The delay of a
+    newly started timer is one interval plus its phase.
+
+@param[in]
+    timerID
+        id of the tick timer
+
+@param[in]
+    first
+        delay of the first firing in milliseconds
+
+@retval EOK the timer was armed
+@retval other error from timer_settime
+
+==============================================================================*/
+static int ArmTick( int timerID, uint64_t first )
+{
+    struct itimerspec its;
+    uint64_t interval = ticks[timerID].interval;
+
+    its.it_interval.tv_sec = interval / 1000;
+    its.it_interval.tv_nsec = ( interval % 1000 ) * 1000000L;
+    its.it_value.tv_sec = first / 1000;
+    its.it_value.tv_nsec = ( first % 1000 ) * 1000000L;
+
+    return ( timer_settime( timers[timerID], 0, &its, NULL ) == 0 ) ? EOK
+                                                                    : errno;
+}
+
+/*============================================================================*/
+/*  ResumeDelay                                                               */
+/*!
+    Calculate the first firing delay of a resumed tick timer
+
+    The ResumeDelay function calculates the delay until a resumed tick
+    timer would next have fired in the previous instance.  Firings
+    which were missed while no instance was running are skipped,
+    rather than run late, but the timer keeps its phase.
+
+@param[in]
+    timerID
+        id of the tick timer
+
+@retval the delay of the first firing in milliseconds
+
+==============================================================================*/
+static uint64_t ResumeDelay( int timerID )
+{
+    struct timespec now;
+    uint64_t interval = ticks[timerID].interval;
+    uint64_t next = ticks[timerID].resume;
+    uint64_t ms;
+    uint64_t delay;
+
+    clock_gettime( CLOCK_REALTIME, &now );
+    ms = now.tv_sec * 1000ULL + now.tv_nsec / 1000000L;
+
+    delay = ( next > ms ) ? ( next - ms ) % interval
+                          : interval - ( ( ms - next ) % interval );
+
+    return ( delay == 0 ) ? interval : delay;
+}
+
+/*============================================================================*/
+/*  StaggerTicks                                                              */
+/*!
+    Stagger the phases of the tick timers
+
+    The StaggerTicks function groups the tick timers without an explicit
+    offset into clusters with compatible intervals, i.e. intervals whose
+    greatest common divisor leaves room for a slot of at least
+    MIN_STAGGER_SLOT milliseconds per timer.  The timers of a cluster
+    are given evenly spaced phases within the greatest common divisor
+    of their intervals.  Since every interval in the cluster is a
+    multiple of that divisor, the timers keep their relative phases
+    and never fire together.
+
+==============================================================================*/
+static void StaggerTicks( void )
+{
+    uint64_t window[MAX_TIMERS];
+    int count[MAX_TIMERS];
+    int cluster[MAX_TIMERS];
+    int slot[MAX_TIMERS];
+    int clusters = 0;
+    uint64_t g;
+    int i;
+    int c;
+
+    for ( i = 1; i <= id; i++ )
+    {
+        if ( ( ticks[i].interval == 0 ) || ( ticks[i].fixed == true ) )
+        {
+            continue;
+        }
+
+        /* find a cluster with a compatible interval */
+        for ( c = 0; c < clusters; c++ )
+        {
+            g = gcd( window[c], ticks[i].interval );
+            if ( g / ( count[c] + 1 ) >= MIN_STAGGER_SLOT )
+            {
+                window[c] = g;
+                break;
+            }
+        }
+
+        if ( c == clusters )
+        {
+            window[c] = ticks[i].interval;
+            count[c] = 0;
+            clusters++;
+        }
+
+        cluster[i] = c;
+        slot[i] = count[c]++;
+    }
+
+    for ( i = 1; i <= id; i++ )
+    {
+        if ( ( ticks[i].interval != 0 ) && ( ticks[i].fixed == false ) )
+        {
+            c = cluster[i];
+            ticks[i].phase = ( window[c] * slot[i] ) / count[c];
+        }
+    }
+}
+
+/*============================================================================*/
+/*  gcd                                                                       */
+/*!
+    Calculate the greatest common divisor
+
+    The gcd function calculates the greatest common divisor of two
+    unsigned integers
+
+@param[in]
+    a
+        first integer
+
+@param[in]
+    b
+        second integer
+
+@retval the greatest common divisor of a and b
+
+==============================================================================*/
+static uint64_t gcd( uint64_t a, uint64_t b )
+{
+    uint64_t t;
+
+    while ( b != 0 )
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+/*! @}
+ * end of timer group */
@@ -0,0 +1,385 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varset varset
+ * @brief Variable sets, loops and reductions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varset.c
+
+    Variable Sets
+
+    The varset component manages the named sets of system variables
+    declared by actions, such as
+
+    set temps in /sys/temp/a, /sys/temp/b, /sys/ambient;
+
+    The values of a set's variables are fetched together into contiguous
+    arrays, which the for each loops iterate over, and the sum, avg, min
+    and max reductions are calculated from.
+
+    - create variable sets
+    - fetch the values of variable sets
+    - reduce variable sets to a single value
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include "varset.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static bool ObjectToDouble( VarObject *pObj, double *pValue );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewVarSet                                                                 */
+/*!
+    Create a variable set
+
+    The NewVarSet function creates an empty named variable set
+
+@param[in]
+    name
+        pointer to the name of the set
+
+@retval pointer to the new variable set
+@retval NULL if an error occurred
+
+==============================================================================*/
+VarSet *NewVarSet( char *name )
+{
+    VarSet *pSet = NULL;
+
+    if ( name != NULL )
+    {
+        pSet = (VarSet *)calloc( 1, sizeof( VarSet ) );
+        if ( pSet != NULL )
+        {
+            pSet->name = strdup( name );
+            if ( pSet->name == NULL )
+            {
+                free( pSet );
+                pSet = NULL;
+            }
+        }
+    }
+
+    return pSet;
+}
+
+/*============================================================================*/
+/*  AddVarSetMember                                                           */
+/*!
+    Add a system variable to a variable set
+
+    The AddVarSetMember function appends a system variable to a variable
+    set, growing the set's handle and value arrays.  Variables which are
+    already in the set are not added again.
+
+@param[in]
+    pSet
+        pointer to the variable set
+
+@param[in]
+    hVar
+        handle of the system variable to add
+
+@retval EOK the variable was added
+@retval EALREADY the variable is already in the set
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int AddVarSetMember( VarSet *pSet, VAR_HANDLE hVar )
+{
+    VAR_HANDLE *pHandles;
+    VarObject *pObjects;
+    double *pValues;
+    size_t i;
+
+    if ( ( pSet == NULL ) || ( hVar == VAR_INVALID ) )
+    {
+        return EINVAL;
+    }
+
+    for ( i = 0; i < pSet->count; i++ )
+    {
+        if ( pSet->pHandles[i] == hVar )
+        {
+            return EALREADY;
+        }
+    }
+
+    pHandles = (VAR_HANDLE *)realloc( pSet->pHandles,
+                                      ( pSet->count + 1 ) *
+                                      sizeof( VAR_HANDLE ) );
+    if ( pHandles == NULL )
+    {
+        return ENOMEM;
+    }
+
+    pSet->pHandles = pHandles;
+
+    pObjects = (VarObject *)realloc( pSet->pObjects,
+                                     ( pSet->count + 1 ) *
+                                     sizeof( VarObject ) );
+    if ( pObjects == NULL )
+    {
+        return ENOMEM;
+    }
+
+    pSet->pObjects = pObjects;
+
+    pValues = (double *)realloc( pSet->pValues,
+                                 ( pSet->count + 1 ) * sizeof( double ) );
+    if ( pValues == NULL )
+    {
+        return ENOMEM;
+    }
+
+    pSet->pValues = pValues;
+
+    pSet->pHandles[pSet->count] = hVar;
+    memset( &pSet->pObjects[pSet->count], 0, sizeof( VarObject ) );
+    pSet->pValues[pSet->count] = 0.0;
+    pSet->count++;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  FetchVarSet                                                               */
+/*!
+    Fetch the values of a variable set
+
+    The FetchVarSet function reads the values of all the variables in
+    a set in a single pass, into the set's contiguous value arrays.
+    A variable which cannot be read keeps its previous value.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pSet
+        pointer to the variable set
+
+@retval EOK all the values were fetched
+@retval EINVAL invalid arguments
+@retval other error from the last variable which could not be read
+
+==============================================================================*/
+int FetchVarSet( VARSERVER_HANDLE hVarServer, VarSet *pSet )
+{
+    int result = EINVAL;
+    int rc;
+    VarObject obj;
+    size_t i;
+
+    if ( ( hVarServer != NULL ) && ( pSet != NULL ) )
+    {
+        result = EOK;
+
+        for ( i = 0; i < pSet->count; i++ )
+        {
+            rc = VAR_Get( hVarServer, pSet->pHandles[i], &obj );
+            if ( ( rc == EOK ) &&
+                 ( ObjectToDouble( &obj, &pSet->pValues[i] ) == true ) )
+            {
+                pSet->pObjects[i] = obj;
+            }
+            else
+            {
+                result = ( rc != EOK ) ? rc : ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReduceVarSet                                                              */
+/*!
+    Reduce the values of a variable set to a single value
+
+    The ReduceVarSet function calculates the sum, average, minimum or
+    maximum of the most recently fetched values of a variable set.
+    The reductions are simple loops over the contiguous value array
+    so the compiler can vectorize them.
+
+@param[in]
+    pSet
+        pointer to the variable set
+
+@param[in]
+    op
+        reduction operation
+
+@retval the reduced value
+@retval 0.0 if the set is empty
+
+==============================================================================*/
+double ReduceVarSet( VarSet *pSet, ReduceOp op )
+{
+    const double *pValues;
+    double result = 0.0;
+    size_t count;
+    size_t i;
+
+    if ( ( pSet == NULL ) || ( pSet->count == 0 ) )
+    {
+        return 0.0;
+    }
+
+    pValues = pSet->pValues;
+    count = pSet->count;
+
+    switch ( op )
+    {
+        case REDUCE_eSUM:
+        case REDUCE_eAVG:
+            for ( i = 0; i < count; i++ )
+            {
+                result += pValues[i];
+            }
+
+            if ( op == REDUCE_eAVG )
+            {
+                result /= (double)count;
+            }
+            break;
+
+        case REDUCE_eMIN:
+            result = pValues[0];
+            for ( i = 1; i < count; i++ )
+            {
+                result = ( pValues[i] < result ) ? pValues[i] : result;
+            }
+            break;
+
+        case REDUCE_eMAX:
+            result = pValues[0];
+            for ( i = 1; i < count; i++ )
+            {
+                result = ( pValues[i] > result ) ? pValues[i] : result;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ObjectToDouble                                                            */
+/*!
+    Convert a numeric value to a double
+
+@param[in]
+    pObj
+        pointer to the value to convert
+
+@param[out]
+    pValue
+        pointer to the location to store the converted value
+
+@retval true the value was converted
+@retval false the value is not numeric
+
+==============================================================================*/
+static bool ObjectToDouble( VarObject *pObj, double *pValue )
+{
+    bool result = true;
+
+    switch ( pObj->type )
+    {
+        case VARTYPE_UINT16:
+            *pValue = pObj->val.ui;
+            break;
+
+        case VARTYPE_INT16:
+            *pValue = pObj->val.i;
+            break;
+
+        case VARTYPE_UINT32:
+            *pValue = pObj->val.ul;
+            break;
+
+        case VARTYPE_INT32:
+            *pValue = pObj->val.l;
+            break;
+
+        case VARTYPE_UINT64:
+            *pValue = (double)pObj->val.ull;
+            break;
+
+        case VARTYPE_INT64:
+            *pValue = (double)pObj->val.ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            *pValue = pObj->val.f;
+            break;
+
+        default:
+            result = false;
+            break;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of varset group */
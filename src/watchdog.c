@@ -0,0 +1,327 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup watchdog watchdog
+ * @brief Action execution watchdog functions
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file watchdog.c
+
+    Action Execution Watchdog
+
+    The watchdog component limits the time spent executing an action.
+
+    - arm a one-shot watchdog timer when an action starts
+    - disarm the watchdog timer when the action completes
+    - run scripts in their own process groups
+    - kill the running script's process group when the watchdog expires
+
+    The watchdog expiry is handled on a separate thread, since the
+    actions engine thread is blocked waiting for the script to complete.
+    Each script runs in a process group of its own, so the watchdog kills
+    the shell and every process it started, and nothing else.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "watchdog.h"
+#include "log.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static void WatchdogExpiry( union sigval sv );
+static int KillScript( void );
+
+/*==============================================================================
+       File Scoped Variables
+==============================================================================*/
+
+/*! watchdog timer */
+static timer_t watchdog;
+
+/*! flag indicating the watchdog timer has been created */
+static bool created = false;
+
+/*! flag indicating the watchdog expired during the current action */
+static volatile sig_atomic_t expired = 0;
+
+/*! process group of the running script, or 0 if no script is running */
+static pid_t scriptGroup = 0;
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  StartWatchdog                                                             */
+/*!
+    Start the watchdog
+
+    The StartWatchdog function arms the watchdog timer to expire
+    after the specified execution budget.
+
+@param[in]
+    ms
+        the execution budget in milliseconds
+
+@retval EOK the watchdog was started
+@retval EINVAL invalid budget
+@retval other error from the timer functions
+
+==============================================================================*/
+int StartWatchdog( uint64_t ms )
+{
+    struct sigevent te;
+    struct itimerspec its;
+    int result = EINVAL;
+
+    if ( ms != 0 )
+    {
+        if ( created == false )
+        {
+            memset( &te, 0, sizeof( te ) );
+            te.sigev_notify = SIGEV_THREAD;
+            te.sigev_notify_function = WatchdogExpiry;
+            if ( timer_create( CLOCK_MONOTONIC, &te, &watchdog ) == 0 )
+            {
+                created = true;
+            }
+        }
+
+        if ( created == true )
+        {
+            expired = 0;
+
+            memset( &its, 0, sizeof( its ) );
+            its.it_value.tv_sec = ms / 1000;
+            its.it_value.tv_nsec = ( ms % 1000 ) * 1000000L;
+            result = ( timer_settime( watchdog, 0, &its, NULL ) == 0 )
+                     ? EOK
+                     : errno;
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StopWatchdog                                                              */
+/*!
+    Stop the watchdog
+
+    The StopWatchdog function disarms the watchdog timer
+
+@retval EOK the watchdog was stopped
+@retval other error from the timer functions
+
+==============================================================================*/
+int StopWatchdog( void )
+{
+    struct itimerspec its;
+    int result = EOK;
+
+    if ( created == true )
+    {
+        memset( &its, 0, sizeof( its ) );
+        if ( timer_settime( watchdog, 0, &its, NULL ) != 0 )
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WatchdogExpired                                                           */
+/*!
+    Check if the watchdog expired
+
+@retval true the watchdog expired since it was last started
+@retval false the watchdog has not expired
+
+==============================================================================*/
+bool WatchdogExpired( void )
+{
+    return ( expired != 0 );
+}
+
+/*============================================================================*/
+/*  RunScript                                                                 */
+/*!
+    Run a script
+
+    The RunScript function runs a script with the shell in a new process
+    group, and waits for the shell to exit.  The process group is
+    recorded while the script runs, so the watchdog can kill it.
+
+@param[in]
+    script
+        pointer to the script text
+
+@retval EOK the script was run
+@retval EINVAL invalid argument
+@retval other error from fork or waitpid
+
+==============================================================================*/
+int RunScript( const char *script )
+{
+    sigset_t mask;
+    pid_t pid;
+    int status;
+    int result = EINVAL;
+
+    if ( script != NULL )
+    {
+        pid = fork();
+        if ( pid == 0 )
+        {
+            /* the engine blocks the signals it waits for, so unblock
+               them for the script */
+            sigemptyset( &mask );
+            sigprocmask( SIG_SETMASK, &mask, NULL );
+            (void)setpgid( 0, 0 );
+            execl( "/bin/sh", "sh", "-c", script, (char *)NULL );
+            _exit( 127 );
+        }
+        else if ( pid > 0 )
+        {
+            /* set the group in both processes so it exists before
+               either one carries on */
+            (void)setpgid( pid, pid );
+            __atomic_store_n( &scriptGroup, pid, __ATOMIC_RELEASE );
+
+            if ( expired != 0 )
+            {
+                /* the budget expired before the group was recorded */
+                (void)KillScript();
+            }
+
+            result = EOK;
+            while ( waitpid( pid, &status, 0 ) < 0 )
+            {
+                if ( errno != EINTR )
+                {
+                    result = errno;
+                    break;
+                }
+            }
+
+            __atomic_store_n( &scriptGroup, 0, __ATOMIC_RELEASE );
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WatchdogExpiry                                                            */
+/*!
+    Handle watchdog expiry
+
+    The WatchdogExpiry function is invoked on a separate thread when
+    the watchdog timer expires.  It kills the script which is still
+    running, so the action can complete.
+
+@param[in]
+    sv
+        signal value (unused)
+
+==============================================================================*/
+static void WatchdogExpiry( union sigval sv )
+{
+    (void)sv;
+
+    expired = 1;
+
+    if ( KillScript() > 0 )
+    {
+        LogMessage( LOGLEVEL_eWARNING, "watchdog killed script" );
+    }
+}
+
+/*============================================================================*/
+/*  KillScript                                                                */
+/*!
+    Kill the running script
+
+    The KillScript function kills the process group of the running
+    script, which holds the shell and all of the processes it started.
+
+@return the number of process groups which were killed
+
+==============================================================================*/
+static int KillScript( void )
+{
+    pid_t group;
+    int count = 0;
+
+    group = __atomic_load_n( &scriptGroup, __ATOMIC_ACQUIRE );
+    if ( ( group > 0 ) && ( killpg( group, SIGKILL ) == 0 ) )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/*! @}
+ * end of watchdog group */
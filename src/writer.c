@@ -0,0 +1,577 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup writer writer
+ * @brief Asynchronous variable writes
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file writer.c
+
+    Asynchronous Variable Writes
+
+    The writer component lets the engine thread issue system variable
+    writes without waiting for the VarServer to acknowledge each one.
+    Writes are copied into a fixed size single producer, single consumer
+    ring buffer, and are performed in queue order by a writer thread
+    with its own VarServer connection, so the writes to each variable
+    are performed in the order they were issued, while the engine thread
+    carries on running actions.
+
+    The number of queued writes of each variable is tracked, so the
+    engine can wait for the writes of the variables an action uses
+    before running it, and FlushWrites provides a barrier which waits
+    for all queued writes, such as before answering a calc request.
+
+    - start and stop the writer thread
+    - queue variable writes
+    - wait for queued writes
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "writer.h"
+#include "log.h"
+
+/*==============================================================================
+       Definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! queued variable write */
+typedef struct _writeSlot
+{
+    /*! handle of the variable to write */
+    VAR_HANDLE hVar;
+
+    /*! value to write */
+    VarObject obj;
+
+    /*! storage for a string or blob value, reused by later writes */
+    char *buffer;
+
+    /*! size of the value storage */
+    size_t size;
+} WriteSlot;
+
+/*==============================================================================
+       File Scoped Variables
+==============================================================================*/
+
+/*! outbound write queue */
+static WriteSlot queue[WRITE_QUEUE_SIZE];
+
+/*! number of writes queued (written by the engine thread) */
+static size_t head = 0;
+
+/*! number of writes performed (written by the writer thread) */
+static size_t tail = 0;
+
+/*! number of queued writes of the variables in each bucket */
+static uint32_t pending[WRITE_PENDING_BUCKETS];
+
+/*! number of queued writes the engine thread is waiting for (0 = none) */
+static size_t waitFor = 0;
+
+/*! number of writes which failed since the last flush */
+static uint64_t failed = 0;
+
+/*! counts the queued writes for the writer thread */
+static sem_t queued;
+
+/*! signals the engine thread when the writes it waits for are done */
+static sem_t drained;
+
+/*! VarServer connection of the writer thread */
+static VARSERVER_HANDLE hWriter = NULL;
+
+/*! writer thread */
+static pthread_t writerThread;
+
+/*! flag indicating the writer thread is running */
+static bool running = false;
+
+/*! flag indicating writes are performed immediately */
+static bool direct = false;
+
+/*==============================================================================
+       Function declarations
+==============================================================================*/
+
+static void *WriterThread( void *arg );
+static void WaitWrites( size_t target );
+static bool CopyValue( WriteSlot *pSlot, VarObject *pObj );
+
+/*==============================================================================
+       Function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  StartWriter                                                               */
+/*!
+    Start the writer thread
+
+    The StartWriter function opens the writer thread's VarServer
+    connection and starts the writer thread.  Until it is started,
+    variable writes are performed immediately.
+
+@retval EOK the writer thread was started
+@retval ENOTCONN the VarServer connection could not be opened
+@retval other error from creating the thread
+
+==============================================================================*/
+int StartWriter( void )
+{
+    sigset_t mask;
+    sigset_t old;
+    int rc;
+
+    hWriter = VARSERVER_Open();
+    if ( hWriter == NULL )
+    {
+        return ENOTCONN;
+    }
+
+    sem_init( &queued, 0, 0 );
+    sem_init( &drained, 0, 0 );
+
+    /* the writer thread must not receive the notification signals,
+       which are process directed, and are collected by the engine thread */
+    sigfillset( &mask );
+    pthread_sigmask( SIG_SETMASK, &mask, &old );
+
+    running = true;
+    rc = pthread_create( &writerThread, NULL, WriterThread, NULL );
+    pthread_sigmask( SIG_SETMASK, &old, NULL );
+    if ( rc != 0 )
+    {
+        running = false;
+        sem_destroy( &queued );
+        sem_destroy( &drained );
+        (void)VARSERVER_Close( hWriter );
+        hWriter = NULL;
+        return rc;
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  StopWriter                                                                */
+/*!
+    Stop the writer thread
+
+    The StopWriter function stops the writer thread once it has performed
+    all of the queued writes, and releases the write queue.
+
+==============================================================================*/
+void StopWriter( void )
+{
+    size_t i;
+
+    if ( running == false )
+    {
+        return;
+    }
+
+    (void)FlushWrites();
+
+    /* wake the writer thread with an empty queue */
+    __atomic_store_n( &running, false, __ATOMIC_SEQ_CST );
+    sem_post( &queued );
+    pthread_join( writerThread, NULL );
+
+    sem_destroy( &queued );
+    sem_destroy( &drained );
+
+    (void)VARSERVER_Close( hWriter );
+    hWriter = NULL;
+
+    for ( i = 0; i < WRITE_QUEUE_SIZE; i++ )
+    {
+        free( queue[i].buffer );
+        queue[i].buffer = NULL;
+        queue[i].size = 0;
+    }
+}
+
+/*============================================================================*/
+/*  WriteVar                                                                  */
+/*!
+    Write a system variable
+
+    The WriteVar function queues a write of a system variable for the
+    writer thread, copying the value so the caller can reuse it
+    immediately.  If the queue is full, it waits for the oldest write
+    to complete.  Writes are performed immediately if the writer thread
+    is not running, or direct writes have been selected.
+
+@param[in]
+    hVarServer
+        VarServer handle used for immediate writes
+
+@param[in]
+    hVar
+        handle of the variable to write
+
+@param[in]
+    pObj
+        pointer to the value to write
+
+@retval EOK the write was queued or performed
+@retval EINVAL invalid arguments
+@retval other error from the immediate write
+
+==============================================================================*/
+int WriteVar( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar, VarObject *pObj )
+{
+    WriteSlot *pSlot;
+
+    if ( pObj == NULL )
+    {
+        return EINVAL;
+    }
+
+    if ( ( running == false ) || ( direct == true ) )
+    {
+        return VAR_Set( hVarServer, hVar, pObj );
+    }
+
+    if ( head - __atomic_load_n( &tail, __ATOMIC_ACQUIRE ) >=
+         WRITE_QUEUE_SIZE )
+    {
+        /* the queue is full, so wait for the oldest write */
+        WaitWrites( head - WRITE_QUEUE_SIZE + 1 );
+    }
+
+    pSlot = &queue[head & ( WRITE_QUEUE_SIZE - 1 )];
+    if ( CopyValue( pSlot, pObj ) == false )
+    {
+        /* write in order, without the queue */
+        WaitWrites( head );
+        return VAR_Set( hVarServer, hVar, pObj );
+    }
+
+    pSlot->hVar = hVar;
+
+    __atomic_add_fetch( &pending[hVar & ( WRITE_PENDING_BUCKETS - 1 )],
+                        1,
+                        __ATOMIC_RELAXED );
+
+    /* publish the write to the writer thread */
+    __atomic_store_n( &head, head + 1, __ATOMIC_RELEASE );
+    sem_post( &queued );
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  FlushWrites                                                               */
+/*!
+    Wait for the queued writes
+
+    The FlushWrites function waits until all of the queued writes have
+    been performed.
+
+@retval EOK all writes since the last flush succeeded
+@retval EIO some writes since the last flush failed
+
+==============================================================================*/
+int FlushWrites( void )
+{
+    if ( running == false )
+    {
+        return EOK;
+    }
+
+    WaitWrites( head );
+
+    return ( __atomic_exchange_n( &failed, 0, __ATOMIC_RELAXED ) == 0 )
+           ? EOK
+           : EIO;
+}
+
+/*============================================================================*/
+/*  WritePending                                                              */
+/*!
+    Check if a variable has queued writes
+
+    The WritePending function checks if any writes of a variable are
+    still queued.  Variables share counters, so it may report writes
+    of another variable.
+
+@param[in]
+    hVar
+        handle of the variable
+
+@retval true the variable may have queued writes
+@retval false the variable has no queued writes
+
+==============================================================================*/
+bool WritePending( VAR_HANDLE hVar )
+{
+    return ( running == true ) &&
+           ( __atomic_load_n( &pending[hVar & ( WRITE_PENDING_BUCKETS - 1 )],
+                              __ATOMIC_ACQUIRE ) != 0 );
+}
+
+/*============================================================================*/
+/*  WritesIdle                                                                */
+/*!
+    Check if all queued writes have been performed
+
+    The WritesIdle function checks if the writer thread has performed
+    all of the queued writes, so the change notifications of the
+    written variables have been sent.
+
+@retval true no writes are queued
+@retval false some queued writes have not been performed yet
+
+==============================================================================*/
+bool WritesIdle( void )
+{
+    return ( running == false ) ||
+           ( __atomic_load_n( &tail, __ATOMIC_ACQUIRE ) == head );
+}
+
+/*============================================================================*/
+/*  SetDirectWrites                                                           */
+/*!
+    Select immediate or queued writes
+
+    The SetDirectWrites function selects whether WriteVar performs writes
+    immediately or queues them.  The caller flushes the queue before
+    selecting immediate writes, to keep the writes in order.
+
+@param[in]
+    enable
+        true to perform writes immediately, false to queue them
+
+==============================================================================*/
+void SetDirectWrites( bool enable )
+{
+    direct = enable;
+}
+
+/*============================================================================*/
+/*  WriterThread                                                              */
+/*!
+    Writer thread
+
+    The WriterThread function performs the queued writes in queue order
+    until the writer is stopped, and wakes the engine thread when the
+    writes it is waiting for are done.
+
+@param[in]
+    arg
+        thread argument (unused)
+
+@retval NULL
+
+==============================================================================*/
+static void *WriterThread( void *arg )
+{
+    WriteSlot *pSlot;
+    size_t pos;
+    size_t target;
+
+    (void)arg;
+
+    for ( ;; )
+    {
+        if ( sem_wait( &queued ) != 0 )
+        {
+            continue;
+        }
+
+        pos = __atomic_load_n( &tail, __ATOMIC_RELAXED );
+        if ( pos == __atomic_load_n( &head, __ATOMIC_ACQUIRE ) )
+        {
+            if ( __atomic_load_n( &running, __ATOMIC_SEQ_CST ) == false )
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        pSlot = &queue[pos & ( WRITE_QUEUE_SIZE - 1 )];
+        if ( VAR_Set( hWriter, pSlot->hVar, &pSlot->obj ) != EOK )
+        {
+            __atomic_add_fetch( &failed, 1, __ATOMIC_RELAXED );
+            LogMessage( LOGLEVEL_eWARNING,
+                        "queued write of variable %u failed",
+                        (unsigned)pSlot->hVar );
+        }
+
+        __atomic_sub_fetch(
+            &pending[pSlot->hVar & ( WRITE_PENDING_BUCKETS - 1 )],
+            1,
+            __ATOMIC_RELEASE );
+
+        /* hand the slot back to the engine thread */
+        __atomic_store_n( &tail, pos + 1, __ATOMIC_SEQ_CST );
+
+        target = __atomic_load_n( &waitFor, __ATOMIC_SEQ_CST );
+        if ( ( target != 0 ) &&
+             ( pos + 1 >= target ) &&
+             ( __atomic_compare_exchange_n( &waitFor,
+                                            &target,
+                                            0,
+                                            false,
+                                            __ATOMIC_SEQ_CST,
+                                            __ATOMIC_SEQ_CST ) ) )
+        {
+            sem_post( &drained );
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  WaitWrites                                                                */
+/*!
+    Wait for queued writes to complete
+
+    The WaitWrites function blocks the engine thread until the number
+    of performed writes reaches the target.  The target is published
+    before the performed count is checked again, so the writer thread
+    cannot complete the last write without waking the engine thread.
+
+@param[in]
+    target
+        number of writes which must have been performed
+
+==============================================================================*/
+static void WaitWrites( size_t target )
+{
+    while ( __atomic_load_n( &tail, __ATOMIC_SEQ_CST ) < target )
+    {
+        __atomic_store_n( &waitFor, target, __ATOMIC_SEQ_CST );
+
+        if ( __atomic_load_n( &tail, __ATOMIC_SEQ_CST ) >= target )
+        {
+            __atomic_store_n( &waitFor, 0, __ATOMIC_SEQ_CST );
+            break;
+        }
+
+        /* a wakeup left by an earlier wait just repeats the check */
+        while ( ( sem_wait( &drained ) != 0 ) && ( errno == EINTR ) );
+    }
+}
+
+/*============================================================================*/
+/*  CopyValue                                                                 */
+/*!
+    Copy a value into a write queue slot
+
+    The CopyValue function copies a value into a slot, including the
+    content of a string or blob value, growing the slot's storage
+    if necessary.
+
+@param[in]
+    pSlot
+        pointer to the slot
+
+@param[in]
+    pObj
+        pointer to the value to copy
+
+@retval true the value was copied
+@retval false the value storage could not be allocated
+
+==============================================================================*/
+static bool CopyValue( WriteSlot *pSlot, VarObject *pObj )
+{
+    size_t len = 0;
+    char *buffer;
+    void *data = NULL;
+
+    pSlot->obj = *pObj;
+
+    if ( ( pObj->type == VARTYPE_STR ) && ( pObj->val.str != NULL ) )
+    {
+        len = strlen( pObj->val.str ) + 1;
+        data = pObj->val.str;
+    }
+    else if ( ( pObj->type == VARTYPE_BLOB ) && ( pObj->val.blob != NULL ) )
+    {
+        len = pObj->len;
+        data = pObj->val.blob;
+    }
+
+    if ( data == NULL )
+    {
+        return true;
+    }
+
+    if ( len > pSlot->size )
+    {
+        buffer = realloc( pSlot->buffer, len );
+        if ( buffer == NULL )
+        {
+            return false;
+        }
+
+        pSlot->buffer = buffer;
+        pSlot->size = len;
+    }
+
+    memcpy( pSlot->buffer, data, len );
+
+    if ( pObj->type == VARTYPE_STR )
+    {
+        pSlot->obj.val.str = pSlot->buffer;
+        pSlot->obj.len = len;
+    }
+    else
+    {
+        pSlot->obj.val.blob = pSlot->buffer;
+    }
+
+    return true;
+}
+
+/*! @}
+ * end of writer group */
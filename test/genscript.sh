@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Generate a large actions script for parser benchmarks
+#
+# usage: genscript.sh [actions] > script.act
+#
+# Writes an actions script with the requested number of actions
+# (20000 by default) to standard output.  The actions cycle through the
+# shapes found in generated scripts: change actions with local
+# variables and conditions, every actions with static variables, calc
+# actions, and actions containing repeated embedded shell scripts.
+#
+# The script only uses the variables created in the README, so it can
+# also be loaded by an engine which is run, not just parsed.
+
+count=${1:-20000}
+
+echo 'actions {'
+echo '    name: "Benchmark"'
+echo '    description: "Generated parser benchmark script"'
+
+i=1
+while [ "$i" -le "$count" ]
+do
+    case $(( i % 4 )) in
+    0)
+        echo ""
+        echo "    on change /sys/test/a {"
+        echo "        int limit;"
+        echo ""
+        echo "        limit = $i;"
+        echo "        if ( /sys/test/a > limit ) {"
+        echo "            /sys/test/b = /sys/test/a - limit;"
+        echo "        } else {"
+        echo "            /sys/test/b = limit;"
+        echo "        }"
+        echo "    }"
+        ;;
+    1)
+        echo ""
+        echo "    every $(( ( i % 60 ) + 1 )) seconds {"
+        echo "        static int ticks;"
+        echo ""
+        echo "        ticks++;"
+        echo "        /sys/test/i = ticks + $i;"
+        echo "    }"
+        ;;
+    2)
+        echo ""
+        echo "    on calc /sys/test/c {"
+        echo "        int offset;"
+        echo ""
+        echo "        offset = /sys/test/a + $i;"
+        echo "        /sys/test/c = \"value \" + (string)offset;"
+        echo "    }"
+        ;;
+    3)
+        echo ""
+        echo "    on change /sys/test/b {"
+        echo "        \`\`\`"
+        echo "        #!/bin/sh"
+        echo "        logger -t actions b changed"
+        echo "        \`\`\`"
+        echo "    }"
+        ;;
+    esac
+
+    i=$(( i + 1 ))
+done
+
+echo '}'